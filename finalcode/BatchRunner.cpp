@@ -0,0 +1,257 @@
+#include "BatchRunner.h"
+#include <iostream>
+#include <sstream>
+#include <streambuf>
+#include <chrono>
+#include <cstdio>
+#include "User.h"
+#include "CityUser.h"
+#include "Event.h"
+#include "Ticket.h"
+#include "Reservation.h"
+#include "ReservationStore.h"
+#include "Facility.h"
+#include "FacilityManager.h"
+#include "UserDirectory.h"
+#include "BulkImporter.h"
+#include "Journal.h"
+#include "RecordId.h"
+#include "BenchSupport.h"
+
+namespace {
+    // Results are handed to the output stream in blocks of about this size
+    const std::size_t OUTPUT_BLOCK = 64 * 1024;
+
+    BatchStatus report(std::string& result, BatchStatus status, const std::string& command,
+                       const std::string& details = std::string()) {
+        static const char* const names[] = { "ok", "fail", "error" };
+        result = names[static_cast<int>(status)];
+        result += ' ';
+        result += command;
+        if (!details.empty()) {
+            result += ' ';
+            result += details;
+        }
+        return status;
+    }
+
+    std::string money(double amount) {
+        char text[32];
+        std::snprintf(text, sizeof(text), "%.2f", amount);
+        return text;
+    }
+
+    // Reads "YYYY-MM-DD HH:MM" as two words
+    bool readTime(std::istringstream& in, std::chrono::system_clock::time_point& time) {
+        std::string date, clock;
+        if (!(in >> date >> clock)) {
+            return false;
+        }
+        std::string text = date + " " + clock;
+        return BulkImporter::parseTimestamp(text.data(), text.size(), time);
+    }
+
+    // "RES0042" or "42", as in the menu
+    bool readReservationId(std::istringstream& in, RecordId& id) {
+        std::string text;
+        return (in >> text) && parseRecordId(text, "RES", id);
+    }
+}
+
+BatchRunner::BatchRunner(std::vector<std::unique_ptr<User>>& users,
+                         std::vector<std::unique_ptr<Event>>& events,
+                         Facility& facility,
+                         FacilityManager& manager,
+                         const UserDirectory& directory,
+                         Journal* journal)
+    : users(users), events(events), facility(facility), manager(manager), directory(directory),
+      journal(journal), currentUser(nullptr), exiting(false) {}
+
+BatchStatus BatchRunner::execute(const std::string& line, std::string& result) {
+    std::istringstream in(line);
+    std::string command;
+    in >> command;
+
+    if (command == "exit") {
+        exiting = true;
+        return report(result, BatchStatus::Ok, command);
+    }
+    if (command == "login") {
+        std::string username, password;
+        if (!(in >> username >> password)) {
+            return report(result, BatchStatus::Error, command, "reason=syntax");
+        }
+        User* user = directory.find(username);
+        if (user == nullptr || !user->login(username, password)) {
+            return report(result, BatchStatus::Failed, command, "reason=credentials");
+        }
+        currentUser = user;
+        return report(result, BatchStatus::Ok, command, "user=" + username);
+    }
+    if (command == "save") {
+        if (journal == nullptr) {
+            return report(result, BatchStatus::Failed, command, "reason=no-journal");
+        }
+        bool saved = journal->compact(users, events, facility, manager);
+        return report(result, saved ? BatchStatus::Ok : BatchStatus::Failed, command, saved ? "" : "reason=io");
+    }
+    if (command != "logout" && command != "reserve" && command != "pay" && command != "approve" &&
+        command != "cancel" && command != "purchase") {
+        return report(result, BatchStatus::Error, command.empty() ? "?" : command, "reason=unknown-command");
+    }
+    if (currentUser == nullptr) {
+        return report(result, BatchStatus::Failed, command, "reason=login");
+    }
+
+    if (command == "logout") {
+        currentUser = nullptr;
+        return report(result, BatchStatus::Ok, command);
+    }
+
+    if (command == "reserve") {
+        std::chrono::system_clock::time_point startTime, endTime;
+        int layoutStyleInt, isPublic;
+        if (!readTime(in, startTime) || !readTime(in, endTime) || !(in >> layoutStyleInt >> isPublic) ||
+            layoutStyleInt < 0 || layoutStyleInt > 3) {
+            return report(result, BatchStatus::Error, command, "reason=syntax");
+        }
+        double paymentAmount;
+        bool makePaymentNow = static_cast<bool>(in >> paymentAmount);
+
+        std::unique_ptr<Reservation> reservation(new Reservation(
+            currentUser, startTime, endTime, static_cast<LayoutStyle>(layoutStyleInt), isPublic != 0));
+        if (makePaymentNow) {
+            reservation->makePayment(paymentAmount);
+        }
+        RecordId requestId = reservation->getId();
+        std::string details = "id=" + reservation->getIdString() + " cost=" + money(reservation->getTotalCost());
+
+        // The user and the manager share the one reservation
+        if (!currentUser->makeReservation(std::move(reservation))) {
+            return report(result, BatchStatus::Failed, command, "reason=rejected");
+        }
+        ReservationHandle request = currentUser->getReservations().find(requestId);
+        manager.addPendingReservation(request);
+        details += ReservationStore::shared().get(request)->getIsPaid() ? " paid=1" : " paid=0";
+        return report(result, BatchStatus::Ok, command, details);
+    }
+
+    if (command == "pay") {
+        RecordId reservationId;
+        double paymentAmount;
+        if (!readReservationId(in, reservationId) || !(in >> paymentAmount)) {
+            return report(result, BatchStatus::Error, command, "reason=syntax");
+        }
+        Reservation* reservationToPay = currentUser->getReservations().get(reservationId);
+        if (reservationToPay == nullptr || reservationToPay->getIsPaid()) {
+            return report(result, BatchStatus::Failed, command, "reason=not-found");
+        }
+        if (!currentUser->deductFromBudget(paymentAmount)) {
+            return report(result, BatchStatus::Failed, command, "reason=funds");
+        }
+        if (!reservationToPay->makePayment(paymentAmount)) {
+            currentUser->addToBudget(paymentAmount); // Refund the deducted amount
+            return report(result, BatchStatus::Failed, command, "reason=amount");
+        }
+        return report(result, BatchStatus::Ok, command, "id=" + reservationToPay->getIdString());
+    }
+
+    if (command == "approve") {
+        RecordId reservationId;
+        if (!readReservationId(in, reservationId)) {
+            return report(result, BatchStatus::Error, command, "reason=syntax");
+        }
+        if (dynamic_cast<CityUser*>(currentUser) == nullptr) {
+            return report(result, BatchStatus::Failed, command, "reason=permission");
+        }
+        if (!manager.approveReservation(reservationId)) {
+            return report(result, BatchStatus::Failed, command, "reason=refused");
+        }
+        return report(result, BatchStatus::Ok, command, "id=" + formatRecordId("RES", reservationId));
+    }
+
+    if (command == "cancel") {
+        RecordId reservationId;
+        if (!readReservationId(in, reservationId)) {
+            return report(result, BatchStatus::Error, command, "reason=syntax");
+        }
+        if (!currentUser->cancelReservation(reservationId)) {
+            return report(result, BatchStatus::Failed, command, "reason=not-found");
+        }
+        return report(result, BatchStatus::Ok, command, "id=" + formatRecordId("RES", reservationId));
+    }
+
+    // purchase
+    long long eventIndex;
+    if (!(in >> eventIndex) || eventIndex < 0 || static_cast<unsigned long long>(eventIndex) >= events.size()) {
+        return report(result, BatchStatus::Error, command, "reason=event");
+    }
+    Event* selectedEvent = events[eventIndex].get();
+    Ticket* ticket = selectedEvent->purchaseTicket(currentUser);
+    if (ticket == nullptr) {
+        return report(result, BatchStatus::Failed, command, "reason=full");
+    }
+    if (!currentUser->purchaseTicket(ticket)) {
+        selectedEvent->cancelTicket(ticket); // Refunds and frees the seat
+        return report(result, BatchStatus::Failed, command, "reason=refused");
+    }
+    return report(result, BatchStatus::Ok, command, "ticket=" + ticket->getIdString());
+}
+
+BatchStats BatchRunner::run(std::istream& in, std::ostream& out) {
+    BatchStats stats = { 0, 0, 0, 0, 0.0 };
+
+    // The model classes report on std::cout; results bypass it
+    std::streambuf* target = out.rdbuf();
+    NullBuffer discard;
+    std::streambuf* original = std::cout.rdbuf(&discard);
+
+    std::string line, result, buffer;
+    buffer.reserve(OUTPUT_BLOCK + 256);
+    std::size_t lineNumber = 0;
+    exiting = false;
+    auto begin = std::chrono::steady_clock::now();
+    while (!exiting && std::getline(in, line)) {
+        ++lineNumber;
+        if (!line.empty() && line[line.size() - 1] == '\r') {
+            line.erase(line.size() - 1);
+        }
+        std::size_t first = line.find_first_not_of(" \t");
+        if (first == std::string::npos || line[first] == '#') {
+            continue;
+        }
+
+        ++stats.commands;
+        switch (execute(line, result)) {
+            case BatchStatus::Ok:
+                ++stats.ok;
+                break;
+            case BatchStatus::Failed:
+                ++stats.failed;
+                break;
+            case BatchStatus::Error:
+                ++stats.errors;
+                break;
+        }
+        buffer += std::to_string(lineNumber);
+        buffer += ' ';
+        buffer += result;
+        buffer += '\n';
+        if (buffer.size() >= OUTPUT_BLOCK) {
+            target->sputn(buffer.data(), buffer.size());
+            buffer.clear();
+        }
+    }
+    if (journal != nullptr) {
+        journal->sync();
+    }
+    stats.milliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count();
+    std::cout.rdbuf(original);
+
+    buffer += "# commands=" + std::to_string(stats.commands) + " ok=" + std::to_string(stats.ok) +
+              " fail=" + std::to_string(stats.failed) + " error=" + std::to_string(stats.errors) +
+              " ms=" + money(stats.milliseconds) + "\n";
+    target->sputn(buffer.data(), buffer.size());
+    target->pubsync();
+    return stats;
+}
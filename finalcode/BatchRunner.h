@@ -0,0 +1,83 @@
+#ifndef BATCH_RUNNER_H
+#define BATCH_RUNNER_H
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <istream>
+#include <ostream>
+#include <cstddef>
+
+class User;
+class Event;
+class Facility;
+class FacilityManager;
+class UserDirectory;
+class Journal;
+
+enum class BatchStatus {
+    Ok,
+    Failed, // Understood but refused, e.g. a taken slot
+    Error   // Unknown command or bad arguments
+};
+
+// Totals for one run() of a script
+struct BatchStats {
+    std::size_t commands; // Lines that held a command
+    std::size_t ok;
+    std::size_t failed;
+    std::size_t errors;
+    double milliseconds;
+};
+
+// Drives the system from a script instead of the interactive menu, one
+// command per line, as the logged-in user where one is needed:
+//
+//   login <username> <password>
+//   logout
+//   reserve <YYYY-MM-DD HH:MM> <YYYY-MM-DD HH:MM> <layout 0-3> <public 0|1> [payment]
+//   pay <reservationId> <amount>
+//   approve <reservationId>                      (city users)
+//   cancel <reservationId>
+//   purchase <eventIndex>
+//   save                                         (folds the journal into a snapshot)
+//   exit
+//
+// Blank lines and lines starting with '#' are skipped. The model classes'
+// own messages are discarded; instead each command prints one line
+//
+//   <line> ok|fail|error <command> [key=value ...]
+//
+// to an output buffer that is written out in large blocks, and run() ends with
+// a '#' summary line. Times are local, as in the menu.
+class BatchRunner {
+private:
+    std::vector<std::unique_ptr<User>>& users;
+    std::vector<std::unique_ptr<Event>>& events;
+    Facility& facility;
+    FacilityManager& manager;
+    const UserDirectory& directory;
+    Journal* journal; // May be nullptr; then save fails
+    User* currentUser;
+    bool exiting;
+
+public:
+    BatchRunner(std::vector<std::unique_ptr<User>>& users,
+                std::vector<std::unique_ptr<Event>>& events,
+                Facility& facility,
+                FacilityManager& manager,
+                const UserDirectory& directory,
+                Journal* journal);
+
+    // Runs one command line and sets 'result' to its output line, without
+    // the line number or newline
+    BatchStatus execute(const std::string& line, std::string& result);
+
+    // Runs every command from 'in' and writes the results to 'out'. Buffered
+    // journal records are synced once at the end rather than per command.
+    BatchStats run(std::istream& in, std::ostream& out);
+
+    User* getCurrentUser() const { return currentUser; }
+};
+
+#endif // BATCH_RUNNER_H
@@ -0,0 +1,24 @@
+#ifndef BENCH_SUPPORT_H
+#define BENCH_SUPPORT_H
+
+#include <streambuf>
+#include <chrono>
+
+// Helpers shared by the benchmarks and the batch runner.
+
+// Swallows output without buffering it, so concurrent writers share no state.
+// Install it with std::cout.rdbuf to silence the chatty purchase and save paths.
+class NullBuffer : public std::streambuf {
+protected:
+    int overflow(int c) override { return c; }
+};
+
+// Runs function once and returns its wall time in milliseconds
+template<typename Function>
+double timeIt(Function function) {
+    auto begin = std::chrono::steady_clock::now();
+    function();
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count();
+}
+
+#endif // BENCH_SUPPORT_H
@@ -0,0 +1,93 @@
+#ifndef BINARY_IO_H
+#define BINARY_IO_H
+
+#include <string>
+#include <cstring>
+#include <cstdint>
+#include <cstddef>
+#include "StringRef.h"
+
+// Little helpers for the binary formats (snapshot and journal). Values are
+// written in native width and byte order; strings are u32 length + bytes.
+class BinaryWriter {
+public:
+    std::string buffer;
+
+    template<typename T>
+    void put(T value) {
+        buffer.append(reinterpret_cast<const char*>(&value), sizeof(T));
+    }
+
+    void putString(const std::string& value) {
+        put<std::uint32_t>(static_cast<std::uint32_t>(value.size()));
+        buffer.append(value);
+    }
+
+    // Sections are written with a placeholder length that is patched on close
+    std::size_t beginSection(std::uint32_t tag) {
+        put<std::uint32_t>(tag);
+        put<std::uint64_t>(0);
+        return buffer.size();
+    }
+
+    void endSection(std::size_t payloadStart) {
+        std::uint64_t length = buffer.size() - payloadStart;
+        std::memcpy(&buffer[payloadStart - sizeof(std::uint64_t)], &length, sizeof(length));
+    }
+};
+
+// Bounds-checked cursor over a byte range. A short read marks the reader as
+// failed and yields zero values, so callers check ok() once per record.
+class BinaryReader {
+private:
+    const char* cursor;
+    const char* end;
+    bool failed;
+
+public:
+    BinaryReader(const char* data, std::size_t size) : cursor(data), end(data + size), failed(false) {}
+
+    bool ok() const { return !failed; }
+    bool atEnd() const { return cursor >= end; }
+    std::size_t remaining() const { return static_cast<std::size_t>(end - cursor); }
+    const char* position() const { return cursor; }
+
+    template<typename T>
+    T get() {
+        T value = T();
+        if (remaining() < sizeof(T)) {
+            failed = true;
+            cursor = end;
+            return value;
+        }
+        std::memcpy(&value, cursor, sizeof(T));
+        cursor += sizeof(T);
+        return value;
+    }
+
+    // Views the string in the source buffer; nothing is copied
+    StringRef getString() {
+        std::uint32_t length = get<std::uint32_t>();
+        if (remaining() < length) {
+            failed = true;
+            cursor = end;
+            return StringRef();
+        }
+        StringRef value(cursor, length);
+        cursor += length;
+        return value;
+    }
+
+    BinaryReader sub(std::uint64_t length) {
+        if (static_cast<std::uint64_t>(remaining()) < length) {
+            failed = true;
+            cursor = end;
+            return BinaryReader(end, 0);
+        }
+        BinaryReader section(cursor, static_cast<std::size_t>(length));
+        cursor += length;
+        return section;
+    }
+};
+
+#endif // BINARY_IO_H
@@ -0,0 +1,524 @@
+#include "BulkImporter.h"
+#include <iostream>
+#include <thread>
+#include <algorithm>
+#include <climits>
+#include <cstring>
+#include <ctime>
+#include <sys/stat.h>
+#include "MappedFile.h"
+#include "StringRef.h"
+#include "User.h"
+#include "UserDirectory.h"
+#include "Resident.h"
+#include "NonResident.h"
+#include "CityUser.h"
+#include "Organization.h"
+#include "Reservation.h"
+#include "Event.h"
+#include "Ticket.h"
+
+namespace {
+
+// Below this many bytes per thread, starting threads costs more than it saves
+const std::size_t MIN_CHUNK_BYTES = 64 * 1024;
+
+struct Chunk {
+    const char* begin;
+    const char* end;
+};
+
+// Cuts the buffer into at most `parts` pieces, each ending just after a newline
+std::vector<Chunk> splitLines(const char* data, std::size_t size, unsigned parts) {
+    std::vector<Chunk> chunks;
+    const char* end = data + size;
+    const char* begin = data;
+    for (unsigned i = 1; i < parts; ++i) {
+        const char* cut = data + size / parts * i;
+        if (cut <= begin) {
+            continue; // A long line already ran past this cut
+        }
+        const char* newline = static_cast<const char*>(std::memchr(cut, '\n', end - cut));
+        if (!newline) {
+            break;
+        }
+        chunks.push_back({ begin, newline + 1 });
+        begin = newline + 1;
+    }
+    if (begin < end) {
+        chunks.push_back({ begin, end });
+    }
+    return chunks;
+}
+
+bool isDigit(char c) {
+    return c >= '0' && c <= '9';
+}
+
+// Fixed-width unsigned field, e.g. the "04" in a timestamp
+bool fixedDigits(const char* data, int count, int& result) {
+    result = 0;
+    for (int i = 0; i < count; ++i) {
+        if (!isDigit(data[i])) {
+            return false;
+        }
+        result = result * 10 + (data[i] - '0');
+    }
+    return true;
+}
+
+// Optional sign and up to 18 digits, so the value cannot overflow
+bool parseInteger(StringRef field, long long& result) {
+    std::size_t i = 0;
+    bool negative = field.size > 0 && field.data[0] == '-';
+    if (negative || (field.size > 0 && field.data[0] == '+')) {
+        ++i;
+    }
+    if (i == field.size || field.size - i > 18) {
+        return false;
+    }
+    long long value = 0;
+    for (; i < field.size; ++i) {
+        if (!isDigit(field.data[i])) {
+            return false;
+        }
+        value = value * 10 + (field.data[i] - '0');
+    }
+    result = negative ? -value : value;
+    return true;
+}
+
+// Plain decimal notation ("12", "12.50"), read as an integer mantissa and a power of ten
+bool parseDecimal(StringRef field, double& result) {
+    static const double scale[] = { 1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9,
+                                    1e10, 1e11, 1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18 };
+    std::size_t i = 0;
+    bool negative = field.size > 0 && field.data[0] == '-';
+    if (negative || (field.size > 0 && field.data[0] == '+')) {
+        ++i;
+    }
+    long long mantissa = 0;
+    int digits = 0;
+    int fraction = -1; // Digits after the point, or -1 before it
+    for (; i < field.size; ++i) {
+        char c = field.data[i];
+        if (c == '.' && fraction < 0) {
+            fraction = 0;
+        } else if (isDigit(c) && digits < 18) {
+            mantissa = mantissa * 10 + (c - '0');
+            ++digits;
+            if (fraction >= 0) {
+                ++fraction;
+            }
+        } else {
+            return false;
+        }
+    }
+    if (digits == 0) {
+        return false;
+    }
+    double value = static_cast<double>(mantissa) / scale[fraction > 0 ? fraction : 0];
+    result = negative ? -value : value;
+    return true;
+}
+
+// Days since 1970-01-01 of a proleptic Gregorian date
+long long daysFromCivil(int year, int month, int day) {
+    year -= month <= 2;
+    const long long era = (year >= 0 ? year : year - 399) / 400;
+    const long long yearOfEra = year - era * 400;
+    const long long dayOfYear = (153 * (month > 2 ? month - 3 : month + 9) + 2) / 5 + day - 1;
+    const long long dayOfEra = yearOfEra * 365 + yearOfEra / 4 - yearOfEra / 100 + dayOfYear;
+    return era * 146097 + dayOfEra - 719468;
+}
+
+int daysInMonth(int year, int month) {
+    static const int days[] = { 31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31 };
+    bool leap = (year % 4 == 0 && year % 100 != 0) || year % 400 == 0;
+    return month == 2 && leap ? 29 : days[month - 1];
+}
+
+// Seconds that local time is ahead of UTC on a given day, as std::mktime sees it
+// with daylight saving off (which is how interactive input is read). Rows come
+// in runs of the same day, so each thread keeps its last answer.
+long long localOffset(long long days, int year, int month, int day) {
+    thread_local long long cachedDay = LLONG_MIN;
+    thread_local long long cachedOffset = 0;
+    if (days != cachedDay) {
+        std::tm tm = {};
+        tm.tm_year = year - 1900;
+        tm.tm_mon = month - 1;
+        tm.tm_mday = day;
+        tm.tm_hour = 12;
+        tm.tm_isdst = 0;
+        cachedOffset = days * 86400 + 12 * 3600 - static_cast<long long>(std::mktime(&tm));
+        cachedDay = days;
+    }
+    return cachedOffset;
+}
+
+// Reads whitespace separated fields from one line
+class FieldReader {
+private:
+    const char* cursor;
+    const char* end;
+
+    static bool isSpace(char c) { return c == ' ' || c == '\t' || c == '\r'; }
+
+    void skipSpaces() {
+        while (cursor < end && isSpace(*cursor)) {
+            ++cursor;
+        }
+    }
+
+public:
+    FieldReader(const char* begin, const char* end) : cursor(begin), end(end) {}
+
+    bool atEnd() {
+        skipSpaces();
+        return cursor == end;
+    }
+
+    bool word(StringRef& result) {
+        skipSpaces();
+        const char* start = cursor;
+        while (cursor < end && !isSpace(*cursor)) {
+            ++cursor;
+        }
+        result = StringRef(start, cursor - start);
+        return result.size > 0;
+    }
+
+    bool quoted(StringRef& result) {
+        skipSpaces();
+        if (cursor == end || *cursor != '"') {
+            return false;
+        }
+        const char* start = cursor + 1;
+        const char* close = static_cast<const char*>(std::memchr(start, '"', end - start));
+        if (!close) {
+            return false;
+        }
+        result = StringRef(start, close - start);
+        cursor = close + 1;
+        return true;
+    }
+
+    bool integer(long long& result) {
+        StringRef field;
+        return word(field) && parseInteger(field, result);
+    }
+
+    bool decimal(double& result) {
+        StringRef field;
+        return word(field) && parseDecimal(field, result);
+    }
+
+    // 0 or 1, as the files have always been written
+    bool flag(bool& result) {
+        StringRef field;
+        if (!word(field) || field.size != 1 || (field.data[0] != '0' && field.data[0] != '1')) {
+            return false;
+        }
+        result = field.data[0] == '1';
+        return true;
+    }
+
+    // "YYYY-MM-DD HH:MM", which spans two words
+    bool timestamp(std::chrono::system_clock::time_point& result) {
+        const std::size_t width = 16;
+        skipSpaces();
+        if (static_cast<std::size_t>(end - cursor) < width ||
+            (cursor + width < end && !isSpace(cursor[width])) ||
+            !BulkImporter::parseTimestamp(cursor, width, result)) {
+            return false;
+        }
+        cursor += width;
+        return true;
+    }
+};
+
+// What one thread made of its chunk. Line numbers are relative to the chunk
+// until the chunks are stitched back together.
+template<typename Row>
+struct ChunkResult {
+    std::vector<std::unique_ptr<Row>> rows;
+    std::vector<std::size_t> rowLines;
+    std::vector<ImportError> errors;
+    std::size_t lines = 0;
+};
+
+// Runs parseRow over every non-blank line, one thread per chunk. A row parser
+// fills in the row or says in `problem` why it could not.
+template<typename Row, typename ParseRow>
+std::vector<ChunkResult<Row>> parseChunks(const std::vector<Chunk>& chunks, ParseRow parseRow) {
+    std::vector<ChunkResult<Row>> results(chunks.size());
+    auto work = [&](std::size_t index) {
+        ChunkResult<Row>& result = results[index];
+        const char* cursor = chunks[index].begin;
+        const char* end = chunks[index].end;
+        result.rows.reserve((end - cursor) / 32);
+        result.rowLines.reserve((end - cursor) / 32);
+        std::string problem;
+        while (cursor < end) {
+            const char* newline = static_cast<const char*>(std::memchr(cursor, '\n', end - cursor));
+            const char* lineEnd = newline ? newline : end;
+            ++result.lines;
+            FieldReader fields(cursor, lineEnd);
+            if (!fields.atEnd()) {
+                std::unique_ptr<Row> row;
+                if (parseRow(fields, row, problem)) {
+                    result.rows.push_back(std::move(row));
+                    result.rowLines.push_back(result.lines);
+                } else {
+                    result.errors.push_back({ result.lines, problem });
+                }
+            }
+            cursor = lineEnd + 1;
+        }
+    };
+
+    std::vector<std::thread> workers;
+    for (std::size_t i = 1; i < chunks.size(); ++i) {
+        workers.push_back(std::thread(work, i));
+    }
+    if (!chunks.empty()) {
+        work(0);
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    return results;
+}
+
+// Appends the rows in file order and turns chunk line numbers into file line numbers
+template<typename Row>
+std::size_t stitch(std::vector<ChunkResult<Row>>& results, std::vector<std::unique_ptr<Row>>& rows,
+                   std::vector<ImportError>& errors) {
+    std::size_t total = 0;
+    for (const auto& result : results) {
+        total += result.rows.size();
+    }
+    rows.reserve(rows.size() + total);
+
+    std::size_t firstLine = 0;
+    for (auto& result : results) {
+        for (auto& row : result.rows) {
+            rows.push_back(std::move(row));
+        }
+        for (auto& error : result.errors) {
+            error.line += firstLine;
+            errors.push_back(std::move(error));
+        }
+        firstLine += result.lines;
+    }
+    return total;
+}
+
+// Journal records and snapshots find events by name, so only the first event
+// with a name is kept, counting the events already loaded. Later ones become
+// errors on their own line.
+void dropDuplicateNames(std::vector<ChunkResult<Event>>& results, const std::vector<std::unique_ptr<Event>>& events) {
+    std::vector<bool> taken;
+    auto claim = [&](SymbolId id) {
+        if (id >= taken.size()) {
+            taken.resize(id + 1, false);
+        }
+        if (taken[id]) {
+            return false;
+        }
+        taken[id] = true;
+        return true;
+    };
+    for (const auto& event : events) {
+        claim(event->getNameId());
+    }
+
+    for (auto& result : results) {
+        std::size_t kept = 0;
+        bool dropped = false;
+        for (std::size_t i = 0; i < result.rows.size(); ++i) {
+            if (!claim(result.rows[i]->getNameId())) {
+                result.errors.push_back({ result.rowLines[i], "duplicate event name: " + result.rows[i]->getName() });
+                dropped = true;
+                continue;
+            }
+            result.rows[kept] = std::move(result.rows[i]);
+            result.rowLines[kept] = result.rowLines[i];
+            ++kept;
+        }
+        result.rows.resize(kept);
+        result.rowLines.resize(kept);
+        if (dropped) {
+            std::stable_sort(result.errors.begin(), result.errors.end(),
+                             [](const ImportError& a, const ImportError& b) { return a.line < b.line; });
+        }
+    }
+}
+
+// MappedFile refuses empty files, which are simply empty tables here
+bool mapInput(MappedFile& file, const std::string& filename) {
+    if (file.open(filename)) {
+        return true;
+    }
+    struct stat info;
+    if (stat(filename.c_str(), &info) != 0 || info.st_size != 0) {
+        std::cerr << "Failed to open file: " << filename << std::endl;
+    }
+    return false;
+}
+
+bool parseUser(FieldReader& fields, std::unique_ptr<User>& user, std::string& problem) {
+    StringRef username, password;
+    long long type;
+    double budget;
+    if (!fields.word(username) || !fields.word(password) || !fields.integer(type) || !fields.decimal(budget)) {
+        problem = "expected: username password type budget";
+        return false;
+    }
+    if (!fields.atEnd()) {
+        problem = "unexpected text after budget";
+        return false;
+    }
+
+    switch (type) {
+        case 0:
+            user.reset(new Resident(username.str(), password.str()));
+            break;
+        case 1:
+            user.reset(new NonResident(username.str(), password.str()));
+            break;
+        case 2:
+            user.reset(new CityUser(username.str(), password.str()));
+            break;
+        case 3:
+            user.reset(new Organization(username.str(), password.str()));
+            break;
+        default:
+            problem = "unknown user type " + std::to_string(type);
+            return false;
+    }
+    // The file holds the balance itself, not an amount on top of the starting one
+    user->addToBudget(budget - user->getBudget());
+    return true;
+}
+
+} // namespace
+
+BulkImporter::BulkImporter(unsigned threadCount) : threadCount(threadCount) {
+    if (this->threadCount == 0) {
+        this->threadCount = std::thread::hardware_concurrency();
+    }
+    if (this->threadCount == 0) {
+        this->threadCount = 1;
+    }
+}
+
+bool BulkImporter::parseTimestamp(const char* data, std::size_t size, std::chrono::system_clock::time_point& result) {
+    int year, month, day, hour, minute;
+    if (size != 16 || data[4] != '-' || data[7] != '-' || data[10] != ' ' || data[13] != ':' ||
+        !fixedDigits(data, 4, year) || !fixedDigits(data + 5, 2, month) || !fixedDigits(data + 8, 2, day) ||
+        !fixedDigits(data + 11, 2, hour) || !fixedDigits(data + 14, 2, minute)) {
+        return false;
+    }
+    if (month < 1 || month > 12 || day < 1 || day > daysInMonth(year, month) || hour > 23 || minute > 59) {
+        return false;
+    }
+    long long days = daysFromCivil(year, month, day);
+    long long seconds = days * 86400 + hour * 3600 + minute * 60 - localOffset(days, year, month, day);
+    result = std::chrono::system_clock::time_point(std::chrono::seconds(seconds));
+    return true;
+}
+
+void BulkImporter::report(const std::string& filename, std::vector<ImportError>& found) {
+    for (auto& error : found) {
+        std::cerr << filename << ":" << error.line << ": " << error.message << std::endl;
+        errors.push_back(std::move(error));
+    }
+}
+
+std::size_t BulkImporter::loadUsers(const std::string& filename, std::vector<std::unique_ptr<User>>& users) {
+    errors.clear();
+    MappedFile file;
+    if (!mapInput(file, filename)) {
+        return 0;
+    }
+
+    unsigned parts = static_cast<unsigned>(std::min<std::size_t>(threadCount, file.size() / MIN_CHUNK_BYTES + 1));
+    auto results = parseChunks<User>(splitLines(file.data(), file.size(), parts), parseUser);
+
+    std::vector<ImportError> found;
+    std::size_t loaded = stitch(results, users, found);
+    report(filename, found);
+    return loaded;
+}
+
+std::size_t BulkImporter::loadEvents(const std::string& filename, std::vector<std::unique_ptr<Event>>& events,
+                                     const std::vector<std::unique_ptr<User>>& users) {
+    errors.clear();
+    MappedFile file;
+    if (!mapInput(file, filename)) {
+        return 0;
+    }
+
+    UserDirectory organizers(users);
+
+    // Rows without times keep the placeholder the file format always implied
+    std::chrono::system_clock::time_point defaultStart, defaultEnd;
+    parseTimestamp("2023-01-01 00:00", 16, defaultStart);
+    parseTimestamp("2023-01-01 01:00", 16, defaultEnd);
+
+    auto parseEvent = [&](FieldReader& fields, std::unique_ptr<Event>& event, std::string& problem) {
+        StringRef name, description, organizerName;
+        double ticketPrice;
+        long long maxCapacity;
+        bool isPublic, allowsResidents, allowsNonResidents;
+        if (!fields.word(name) || !fields.quoted(description) || !fields.word(organizerName) ||
+            !fields.decimal(ticketPrice) || !fields.integer(maxCapacity) ||
+            !fields.flag(isPublic) || !fields.flag(allowsResidents) || !fields.flag(allowsNonResidents)) {
+            problem = "expected: name \"description\" organizer price capacity public residents nonResidents";
+            return false;
+        }
+        if (maxCapacity < 0 || maxCapacity > INT_MAX) {
+            problem = "capacity out of range";
+            return false;
+        }
+
+        User* organizer = organizers.find(organizerName);
+        if (organizer == nullptr) {
+            problem = "organizer not found: " + organizerName.str();
+            return false;
+        }
+
+        auto startTime = defaultStart;
+        auto endTime = defaultEnd;
+        if (!fields.atEnd()) {
+            if (!fields.timestamp(startTime) || !fields.timestamp(endTime)) {
+                problem = "expected start and end time as YYYY-MM-DD HH:MM";
+                return false;
+            }
+            if (!fields.atEnd()) {
+                problem = "unexpected text after end time";
+                return false;
+            }
+            if (endTime <= startTime) {
+                problem = "event ends before it starts";
+                return false;
+            }
+        }
+
+        event.reset(new Event(name.str(), description.str(), organizer, ticketPrice,
+                              static_cast<int>(maxCapacity), isPublic, allowsResidents, allowsNonResidents,
+                              startTime, endTime));
+        return true;
+    };
+
+    unsigned parts = static_cast<unsigned>(std::min<std::size_t>(threadCount, file.size() / MIN_CHUNK_BYTES + 1));
+    auto results = parseChunks<Event>(splitLines(file.data(), file.size(), parts), parseEvent);
+    dropDuplicateNames(results, events);
+
+    std::vector<ImportError> found;
+    std::size_t loaded = stitch(results, events, found);
+    report(filename, found);
+    return loaded;
+}
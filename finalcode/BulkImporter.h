@@ -0,0 +1,54 @@
+#ifndef BULK_IMPORTER_H
+#define BULK_IMPORTER_H
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <chrono>
+#include <cstddef>
+
+class User;
+class Event;
+
+// A row that could not be imported
+struct ImportError {
+    std::size_t line;
+    std::string message;
+};
+
+// Loads users.txt and events.txt in bulk.
+//
+// The file is mapped, cut into line-aligned chunks and each chunk is parsed on
+// its own thread straight from the mapped bytes: no per-line streams, numbers
+// and timestamps are decoded by hand, and organizers are resolved through a
+// UserDirectory. Rows keep their file order. Malformed rows, and events whose
+// name is already taken, are skipped and reported on std::cerr as
+// "file:line: reason".
+//
+//   users.txt   username password type budget
+//   events.txt  name "description" organizer price capacity public residents nonResidents
+//               [YYYY-MM-DD HH:MM YYYY-MM-DD HH:MM]   (local start and end time)
+class BulkImporter {
+private:
+    unsigned threadCount;
+    std::vector<ImportError> errors;
+
+    void report(const std::string& filename, std::vector<ImportError>& found);
+
+public:
+    // 0 uses one thread per hardware thread; small files always use one
+    explicit BulkImporter(unsigned threadCount = 0);
+
+    // Append to the vectors and return the number of rows loaded
+    std::size_t loadUsers(const std::string& filename, std::vector<std::unique_ptr<User>>& users);
+    std::size_t loadEvents(const std::string& filename, std::vector<std::unique_ptr<Event>>& events,
+                           const std::vector<std::unique_ptr<User>>& users);
+
+    // Errors from the most recent load, in line order
+    const std::vector<ImportError>& getErrors() const { return errors; }
+
+    // Parses "YYYY-MM-DD HH:MM" as local time
+    static bool parseTimestamp(const char* data, std::size_t size, std::chrono::system_clock::time_point& result);
+};
+
+#endif // BULK_IMPORTER_H
@@ -1,6 +1,7 @@
 #include "CityUser.h"
 #include "Reservation.h"
 #include "Ticket.h"
+#include "EventDirectory.h"
 #include "Event.h"
 #include "FacilityManager.h"
 #include <iostream>
@@ -14,48 +15,37 @@ CityUser::CityUser(const std::string& username, const std::string& password)
 
 bool CityUser::makeReservation(std::unique_ptr<Reservation> reservation) {
     // Check if the city user has reached the weekly limit (48 hours)
-    auto now = std::chrono::system_clock::now();
-    auto oneWeekAgo = now - std::chrono::hours(24 * 7);
-    
-    std::chrono::duration<double, std::ratio<3600>> totalHours(0);
-    for (const auto& res : reservations) {
-        if (res->getStartTime() >= oneWeekAgo) {
-            totalHours += std::chrono::duration_cast<std::chrono::duration<double, std::ratio<3600>>>(
-                res->getEndTime() - res->getStartTime());
-        }
-    }
-    
+    double totalHours = usage.weeklyHours();
     totalHours += std::chrono::duration_cast<std::chrono::duration<double, std::ratio<3600>>>(
-        reservation->getEndTime() - reservation->getStartTime());
+        reservation->getEndTime() - reservation->getStartTime()).count();
     
-    if (totalHours.count() > 48) {
+    if (totalHours > 48) {
         std::cout << "Reservation exceeds weekly limit of 48 hours for city users." << std::endl;
         return false;
     }
     
     // City users don't need to pay, so we don't check the budget
     std::cout << "Making reservation for CityUser: " << getUsername() << std::endl;
-    reservations.push_back(std::move(reservation));
+    storeReservation(std::move(reservation));
     return true;
 }
 
-bool CityUser::cancelReservation(const std::string& reservationId) {
-    auto it = std::find_if(reservations.begin(), reservations.end(),
-        [&reservationId](const std::unique_ptr<Reservation>& r) { return r->getId() == reservationId; });
+bool CityUser::cancelReservation(RecordId reservationId) {
+    Reservation* reservation = reservations.get(reservationId);
 
-    if (it != reservations.end()) {
+    if (reservation != nullptr) {
         std::cout << "Canceling reservation for CityUser: " << getUsername() << std::endl;
-        reservations.erase(it);
+        eraseReservation(*reservation);
         return true;
     }
     std::cout << "Reservation not found." << std::endl;
     return false;
 }
 
-bool CityUser::purchaseTicket(std::unique_ptr<Ticket> ticket) {
-    // City users don't need to pay for tickets
+bool CityUser::purchaseTicket(Ticket* ticket) {
+    // City users are never charged again here; the event settles the sale
     std::cout << "Purchasing ticket for CityUser: " << getUsername() << std::endl;
-    tickets.push_back(std::move(ticket));
+    attachTicket(ticket);
     return true;
 }
 
@@ -69,6 +59,7 @@ void CityUser::viewSchedule() const {
         }
     }
     
+    std::lock_guard<std::mutex> lock(ticketsMutex);
     if (tickets.empty()) {
         std::cout << "No tickets purchased." << std::endl;
     } else {
@@ -79,7 +70,7 @@ void CityUser::viewSchedule() const {
     }
 }
 
-void CityUser::saveToFile(const std::string& filename) const {
+bool CityUser::saveIndexFile(const std::string& filename) const {
     std::ofstream file(filename);
     if (file.is_open()) {
         file << getUsername() << std::endl;
@@ -89,22 +80,42 @@ void CityUser::saveToFile(const std::string& filename) const {
         // Save reservations
         file << reservations.size() << std::endl;
         for (const auto& reservation : reservations) {
-            file << reservation->getId() << std::endl;
-            reservation->saveToFile(filename + "_" + reservation->getId());
+            file << reservation->getIdString() << std::endl;
         }
 
         // Save tickets
+        std::lock_guard<std::mutex> lock(ticketsMutex);
         file << tickets.size() << std::endl;
         for (const auto& ticket : tickets) {
-            file << ticket->getId() << std::endl;
-            ticket->saveToFile(filename + "_" + ticket->getId());
+            file << ticket->getIdString() << std::endl;
         }
 
         file.close();
         std::cout << "CityUser data saved to file: " << filename << std::endl;
+        return true;
     } else {
         std::cout << "Unable to open file: " << filename << std::endl;
+        return false;
+    }
+}
+
+bool CityUser::saveToFile(const std::string& filename) const {
+    std::size_t failed = 0;
+    bool indexSaved = saveIndexFile(filename);
+    saveRecordFiles(filename, 0, failed);
+    return indexSaved && failed == 0;
+}
+
+std::size_t CityUser::saveChanged(const std::string& filename, std::uint64_t since, std::size_t& failed) const {
+    std::size_t written = saveRecordFiles(filename, since, failed);
+    if (getModified() > since) {
+        if (saveIndexFile(filename)) {
+            ++written;
+        } else {
+            ++failed;
+        }
     }
+    return written;
 }
 
 void CityUser::loadFromFile(const std::string& filename, const std::vector<std::unique_ptr<Event>>& events) {
@@ -127,21 +138,20 @@ void CityUser::loadFromFile(const std::string& filename, const std::vector<std::
             file >> reservationId;
             auto reservation = Reservation::loadFromFile(filename + "_" + reservationId, this);
             if (reservation) {
-                reservations.push_back(std::move(reservation));
+                storeReservation(std::move(reservation));
             }
         }
 
         // Load tickets
         int numTickets;
         file >> numTickets;
+        EventDirectory directory(events);
         for (int i = 0; i < numTickets; ++i) {
             std::string ticketId;
             file >> ticketId;
-            std::vector<std::unique_ptr<User>> users;
-            users.push_back(std::unique_ptr<User>(this));
-            auto ticket = Ticket::loadFromFile(filename + "_" + ticketId, events, users);
-            if (ticket) {
-                tickets.push_back(std::move(ticket));
+            Ticket* ticket = Ticket::loadFromFile(filename + "_" + ticketId, directory, this);
+            if (ticket && !holdsTicket(ticket)) {
+                attachTicket(ticket);
             }
         }
 
@@ -152,7 +162,7 @@ void CityUser::loadFromFile(const std::string& filename, const std::vector<std::
     }
 }
 
-bool CityUser::approveReservation(const std::string& reservationId) {
+bool CityUser::approveReservation(RecordId reservationId) {
     if (facilityManager) {
         return facilityManager->approveReservation(reservationId);
     }
@@ -160,7 +170,7 @@ bool CityUser::approveReservation(const std::string& reservationId) {
     return false;
 }
 
-bool CityUser::rejectReservation(const std::string& reservationId) {
+bool CityUser::rejectReservation(RecordId reservationId) {
     if (facilityManager) {
         return facilityManager->rejectReservation(reservationId);
     }
@@ -12,24 +12,27 @@ class CityUser : public User {
 private:
     FacilityManager* facilityManager;
 
+    bool saveIndexFile(const std::string& filename) const;
+
 public:
     CityUser(const std::string& username, const std::string& password);
 
     void setFacilityManager(FacilityManager* manager) { facilityManager = manager; }
 
     bool makeReservation(std::unique_ptr<Reservation> reservation) override;
-    bool cancelReservation(const std::string& reservationId) override;
-    bool purchaseTicket(std::unique_ptr<Ticket> ticket) override;
+    bool cancelReservation(RecordId reservationId) override;
+    bool purchaseTicket(Ticket* ticket) override;
 
     void viewSchedule() const override;
 
     // File operations
-    void saveToFile(const std::string& filename) const override;
+    bool saveToFile(const std::string& filename) const override;
+    std::size_t saveChanged(const std::string& filename, std::uint64_t since, std::size_t& failed) const override;
     void loadFromFile(const std::string& filename, const std::vector<std::unique_ptr<Event>>& events) override;
 
     // City-specific operations
-    bool approveReservation(const std::string& reservationId);
-    bool rejectReservation(const std::string& reservationId);
+    bool approveReservation(RecordId reservationId);
+    bool rejectReservation(RecordId reservationId);
     void viewPendingReservations() const;
     void viewFacilityBudget() const;
 };
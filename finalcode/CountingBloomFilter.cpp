@@ -0,0 +1,81 @@
+#include "CountingBloomFilter.h"
+
+namespace {
+    // splitmix64 finalizer: ticket ids are sequential, the probes must not be
+    std::uint64_t mix(std::uint64_t key) {
+        key += 0x9E3779B97F4A7C15ULL;
+        key = (key ^ (key >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        key = (key ^ (key >> 27)) * 0x94D049BB133111EBULL;
+        return key ^ (key >> 31);
+    }
+
+    const std::uint64_t COUNTER_MAX = 15;
+    const std::size_t MAX_COUNTERS = std::size_t(1) << 26; // 32 MB, enough for about five million keys
+}
+
+CountingBloomFilter::CountingBloomFilter(std::size_t expectedKeys) {
+    std::size_t counters = 1024;
+    while (counters < expectedKeys * COUNTERS_PER_KEY && counters < MAX_COUNTERS) {
+        counters <<= 1;
+    }
+    wordCount = counters / 16;
+    counterMask = counters - 1;
+    words.reset(new std::atomic<std::uint64_t>[wordCount]);
+    clear();
+}
+
+void CountingBloomFilter::probes(std::uint64_t key, std::uint64_t (&counters)[PROBES]) const {
+    // Double hashing: probe i is h1 + i * h2, with h2 odd so probes differ
+    std::uint64_t hash = mix(key);
+    std::uint64_t h1 = hash & 0xFFFFFFFFULL;
+    std::uint64_t h2 = (hash >> 32) | 1;
+    for (int i = 0; i < PROBES; ++i) {
+        counters[i] = (h1 + i * h2) & counterMask;
+    }
+}
+
+void CountingBloomFilter::add(std::uint64_t key) {
+    std::uint64_t counters[PROBES];
+    probes(key, counters);
+    for (std::uint64_t counter : counters) {
+        std::atomic<std::uint64_t>& word = words[counter / 16];
+        unsigned shift = static_cast<unsigned>(counter % 16) * 4;
+        std::uint64_t value = word.load(std::memory_order_relaxed);
+        if (((value >> shift) & COUNTER_MAX) != COUNTER_MAX) {
+            word.store(value + (std::uint64_t(1) << shift), std::memory_order_release);
+        }
+    }
+}
+
+void CountingBloomFilter::remove(std::uint64_t key) {
+    std::uint64_t counters[PROBES];
+    probes(key, counters);
+    for (std::uint64_t counter : counters) {
+        std::atomic<std::uint64_t>& word = words[counter / 16];
+        unsigned shift = static_cast<unsigned>(counter % 16) * 4;
+        std::uint64_t value = word.load(std::memory_order_relaxed);
+        std::uint64_t count = (value >> shift) & COUNTER_MAX;
+        // A saturated counter no longer knows how many keys it holds
+        if (count != 0 && count != COUNTER_MAX) {
+            word.store(value - (std::uint64_t(1) << shift), std::memory_order_release);
+        }
+    }
+}
+
+void CountingBloomFilter::clear() {
+    for (std::size_t i = 0; i < wordCount; ++i) {
+        words[i].store(0, std::memory_order_relaxed);
+    }
+}
+
+bool CountingBloomFilter::mightContain(std::uint64_t key) const {
+    std::uint64_t counters[PROBES];
+    probes(key, counters);
+    for (std::uint64_t counter : counters) {
+        std::uint64_t value = words[counter / 16].load(std::memory_order_acquire);
+        if (((value >> (counter % 16 * 4)) & COUNTER_MAX) == 0) {
+            return false;
+        }
+    }
+    return true;
+}
@@ -0,0 +1,44 @@
+#ifndef COUNTING_BLOOM_FILTER_H
+#define COUNTING_BLOOM_FILTER_H
+
+#include <atomic>
+#include <memory>
+#include <cstdint>
+#include <cstddef>
+
+// Set membership for 64-bit keys that answers "definitely not present" or
+// "maybe present". Each key bumps PROBES four-bit counters, so keys can be
+// removed again; a counter that reaches 15 stays there, which only costs
+// false positives. About 12 counters (6 bytes) per expected key give a false
+// positive rate under 0.5%; more keys than expected raise it gradually.
+//
+// add() and remove() must not run concurrently with each other; the caller
+// serializes them. mightContain() takes no lock and may run at any time.
+class CountingBloomFilter {
+private:
+    static const int PROBES = 5;
+    static const std::size_t COUNTERS_PER_KEY = 12;
+
+    std::unique_ptr<std::atomic<std::uint64_t>[]> words; // Sixteen counters per word
+    std::size_t wordCount;
+    std::uint64_t counterMask;
+
+    void probes(std::uint64_t key, std::uint64_t (&counters)[PROBES]) const;
+
+public:
+    explicit CountingBloomFilter(std::size_t expectedKeys);
+
+    CountingBloomFilter(const CountingBloomFilter&) = delete;
+    CountingBloomFilter& operator=(const CountingBloomFilter&) = delete;
+
+    void add(std::uint64_t key);
+    // Only for keys that were added
+    void remove(std::uint64_t key);
+    void clear();
+
+    bool mightContain(std::uint64_t key) const;
+
+    std::size_t bytes() const { return wordCount * sizeof(std::uint64_t); }
+};
+
+#endif // COUNTING_BLOOM_FILTER_H
@@ -0,0 +1,41 @@
+#ifndef CPU_FEATURES_H
+#define CPU_FEATURES_H
+
+// Runtime choice of vector instructions. The program is built for the
+// baseline target, so kernels that use wider instructions are compiled with
+// per-function target attributes and picked at run time from what the CPU
+// reports.
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define CC_HAVE_X86_SIMD 1
+#else
+#define CC_HAVE_X86_SIMD 0
+#endif
+
+enum class SimdLevel {
+    Scalar,
+    SSE42, // 2 x 64-bit lanes (pcmpgtq needs SSE4.2)
+    AVX2   // 4 x 64-bit lanes
+};
+
+// The widest level this CPU supports; detected once
+inline SimdLevel detectSimdLevel() {
+#if CC_HAVE_X86_SIMD
+    static const SimdLevel level = __builtin_cpu_supports("avx2") ? SimdLevel::AVX2
+                                 : __builtin_cpu_supports("sse4.2") ? SimdLevel::SSE42
+                                 : SimdLevel::Scalar;
+    return level;
+#else
+    return SimdLevel::Scalar;
+#endif
+}
+
+inline const char* simdLevelName(SimdLevel level) {
+    switch (level) {
+        case SimdLevel::AVX2: return "AVX2";
+        case SimdLevel::SSE42: return "SSE4.2";
+        default: return "scalar";
+    }
+}
+
+#endif // CPU_FEATURES_H
@@ -1,6 +1,9 @@
 #include "Event.h"
 #include "User.h"
 #include "Ticket.h"
+#include "Journal.h"
+#include "Generation.h"
+#include "UserDirectory.h"
 #include <iostream>
 #include <fstream>
 #include <sstream>
@@ -14,82 +17,346 @@ Event::Event(const std::string& name, const std::string& description, User* orga
              bool allowsResidents, bool allowsNonResidents,
              const std::chrono::system_clock::time_point& startTime,
              const std::chrono::system_clock::time_point& endTime)
-    : name(name), description(description), organizer(organizer),
+    : nameId(SymbolTable::shared().intern(name)), description(description), organizer(organizer),
       ticketPrice(ticketPrice), maxCapacity(maxCapacity), currentCapacity(0),
       isPublic(isPublic), allowsResidents(allowsResidents),
-      allowsNonResidents(allowsNonResidents), startTime(startTime), endTime(endTime) {}
+      allowsNonResidents(allowsNonResidents),
+      ticketPool(static_cast<size_t>(std::max(1, std::min(maxCapacity, 1024)))),
+      tickets(static_cast<size_t>(std::max(0, maxCapacity))),
+      startTime(startTime), endTime(endTime), modified(Generation::next()) {
+    if (maxCapacity > 0) {
+        tickets.reserve(maxCapacity);
+    }
+}
+
+Event::~Event() {
+    for (Ticket* ticket : tickets) {
+        ticketPool.destroy(ticket);
+    }
+}
+
+bool Event::claimSeat() {
+    return claimSeats(1) == 1;
+}
+
+int Event::claimSeats(int wanted) {
+    int seats = currentCapacity.load();
+    int granted;
+    do {
+        granted = std::min(wanted, maxCapacity.load() - seats);
+        if (granted <= 0) {
+            return 0;
+        }
+    } while (!currentCapacity.compare_exchange_weak(seats, seats + granted));
+    return granted;
+}
+
+void Event::releaseSeat() {
+    currentCapacity.fetch_sub(1);
+}
 
-std::unique_ptr<Ticket> Event::purchaseTicket(User* user) {
-    if (isSoldOut()) {
+void Event::touch() {
+    modified.store(Generation::next());
+}
+
+bool Event::canAttend(const User* user) const {
+    return !((user->getType() == UserType::Resident && !allowsResidents) ||
+             (user->getType() == UserType::NonResident && !allowsNonResidents));
+}
+
+Ticket* Event::purchaseTicket(User* user) {
+    // The seat is claimed first so concurrent buyers can never oversell; any
+    // failure below hands it back.
+    if (!claimSeat()) {
         std::cout << "Event is sold out. Adding user to waitlist." << std::endl;
         addToWaitlist(user);
         return nullptr;
     }
 
-    if ((user->getType() == UserType::Resident && !allowsResidents) ||
-        (user->getType() == UserType::NonResident && !allowsNonResidents)) {
+    if (!canAttend(user)) {
+        releaseSeat();
         std::cout << "User type not allowed for this event." << std::endl;
         return nullptr;
     }
 
     if (user->deductFromBudget(ticketPrice)) {
-        auto ticket = std::unique_ptr<Ticket>(new Ticket(this, user, ticketPrice));
-        tickets.push_back(std::unique_ptr<Ticket>(new Ticket(*ticket)));
-        currentCapacity++;
-        return std::unique_ptr<Ticket>(new Ticket(*tickets.back()));
+        std::lock_guard<std::mutex> lock(registryMutex);
+        Ticket* ticket = ticketPool.create(this, user, ticketPrice);
+        tickets.add(ticket);
+        touch();
+        if (Journal* journal = Journal::active()) {
+            journal->ticketIssued(*ticket);
+        }
+        return ticket;
     } else {
+        releaseSeat();
         std::cout << "Insufficient funds to purchase ticket." << std::endl;
         return nullptr;
     }
 }
 
+// Caller must hold registryMutex. Returns the buyer, or nullptr if the ticket is not ours.
+User* Event::unregisterTicket(const Ticket* ticket) {
+    if (ticket == nullptr || tickets.find(ticket->getId()) != ticket) {
+        return nullptr;
+    }
+    Ticket* cancelled = tickets.remove(ticket->getId());
+    if (Journal* journal = Journal::active()) {
+        journal->ticketCancelled(*cancelled);
+    }
+    User* user = cancelled->getUser();
+    user->releaseTicket(cancelled);
+    ticketPool.destroy(cancelled);
+    touch();
+    return user;
+}
+
 bool Event::cancelTicket(const Ticket* ticket) {
-    auto it = std::find_if(tickets.begin(), tickets.end(),
-        [ticket](const std::unique_ptr<Ticket>& t) { return t.get() == ticket; });
-
-    if (it != tickets.end()) {
-        User* user = (*it)->getUser();
-        user->addToBudget(ticketPrice); // Refund the ticket price
-        tickets.erase(it);
-        currentCapacity--;
-        processWaitlist();
-        return true;
+    User* user;
+    {
+        std::lock_guard<std::mutex> lock(registryMutex);
+        user = unregisterTicket(ticket);
+    }
+    if (user == nullptr) {
+        return false;
+    }
+
+    user->addToBudget(ticketPrice); // Refund the ticket price
+    releaseSeat();
+    processWaitlist();
+    return true;
+}
+
+bool Event::cancelTickets(const std::vector<const Ticket*>& toCancel) {
+    std::vector<User*> refunded;
+    {
+        std::lock_guard<std::mutex> lock(registryMutex);
+        for (const Ticket* ticket : toCancel) {
+            User* user = unregisterTicket(ticket);
+            if (user != nullptr) {
+                refunded.push_back(user);
+            }
+        }
+    }
+
+    for (User* user : refunded) {
+        user->addToBudget(ticketPrice);
+    }
+    currentCapacity.fetch_sub(static_cast<int>(refunded.size()));
+
+    // Refill every freed seat in a single waitlist pass
+    processWaitlist();
+    return refunded.size() == toCancel.size();
+}
+
+Ticket* Event::findTicket(const User* user) const {
+    std::lock_guard<std::mutex> lock(registryMutex);
+    return tickets.findByBuyer(user);
+}
+
+Ticket* Event::findTicketById(RecordId id) const {
+    std::lock_guard<std::mutex> lock(registryMutex);
+    return tickets.find(id);
+}
+
+Ticket* Event::restoreTicket(User* user, double price) {
+    std::lock_guard<std::mutex> lock(registryMutex);
+    Ticket* ticket = ticketPool.create(this, user, price);
+    tickets.add(ticket);
+    touch();
+    return ticket;
+}
+
+Ticket* Event::claimTicket(User* user, RecordId id, double price) {
+    std::lock_guard<std::mutex> lock(registryMutex);
+    Ticket::ids.observe(id);
+    Ticket* ticket = tickets.find(id);
+    if (ticket != nullptr) {
+        if (ticket->getUser() == user) {
+            return ticket;
+        }
+        if (ticket->getUser()->holdsTicket(ticket)) {
+            return nullptr;
+        }
+        // Restored from the event file under a fresh id that happens to be a
+        // saved one; it steps aside until its own ticket file claims it
+        tickets.remove(id);
+        ticket->id = Ticket::ids.next();
+        tickets.add(ticket);
+    }
+
+    ticket = nullptr;
+    for (Ticket* candidate : tickets.findAllByBuyer(user)) {
+        if (!user->holdsTicket(candidate)) {
+            ticket = candidate;
+            break;
+        }
+    }
+    if (ticket != nullptr) {
+        tickets.remove(ticket->getId());
+        ticket->id = id;
+    } else {
+        ticket = ticketPool.create(this, user, price, id, true);
     }
-    return false;
+    tickets.add(ticket);
+    touch();
+    return ticket;
 }
 
 void Event::addToWaitlist(User* user) {
-    waitlist.push(user);
+    std::lock_guard<std::mutex> lock(registryMutex);
+    waitlist.push_back(user);
+    touch();
+    if (Journal* journal = Journal::active()) {
+        journal->waitlistJoined(*this, *user);
+    }
 }
 
-void Event::processWaitlist() {
-    while (!waitlist.empty() && !isSoldOut()) {
-        User* user = waitlist.front();
-        waitlist.pop();
-        
-        auto ticket = purchaseTicket(user);
-        if (ticket) {
-            std::cout << "A ticket is now available for " << user->getUsername() 
-                      << " for the event: " << name << std::endl;
+WaitlistPromotion Event::promoteWaitlist(int maxPromotions) {
+    WaitlistPromotion result;
+    int seats = 0;
+    std::vector<Ticket*> issued;
+    {
+        std::lock_guard<std::mutex> lock(registryMutex);
+
+        // Claim no more seats than there are people waiting, so concurrent
+        // buyers are not turned away by seats this pass cannot use.
+        int waiting = static_cast<int>(std::min<size_t>(waitlist.size(), static_cast<size_t>(std::max(0, maxPromotions))));
+        seats = claimSeats(waiting);
+        if (seats == 0) {
+            return result;
+        }
+
+        // Pick up to 'seats' candidates in waitlist order. Anyone passed over
+        // keeps their place in line.
+        std::vector<size_t> candidates;
+        for (size_t i = 0; i < waitlist.size() && static_cast<int>(candidates.size()) < seats; ++i) {
+            User* user = waitlist[i];
+            if (canAttend(user) && user->getBudget() >= ticketPrice) {
+                candidates.push_back(i);
+            } else {
+                result.skipped.push_back(user);
+            }
+        }
+
+        // Settle every charge for the batch, then issue the tickets together.
+        std::vector<bool> promoted(waitlist.size(), false);
+        for (size_t index : candidates) {
+            User* user = waitlist[index];
+            if (user->deductFromBudget(ticketPrice)) {
+                promoted[index] = true;
+                result.promoted.push_back(user);
+                result.amountCharged += ticketPrice;
+            } else {
+                result.skipped.push_back(user);
+            }
+        }
+
+        Journal* journal = Journal::active();
+        for (User* user : result.promoted) {
+            Ticket* ticket = ticketPool.create(this, user, ticketPrice);
+            tickets.add(ticket);
+            issued.push_back(ticket);
+            if (journal) {
+                journal->ticketIssued(*ticket);
+            }
+        }
+
+        std::deque<User*> remaining;
+        for (size_t i = 0; i < waitlist.size(); ++i) {
+            if (!promoted[i]) {
+                remaining.push_back(waitlist[i]);
+            }
+        }
+        waitlist.swap(remaining);
+        if (!result.promoted.empty()) {
+            touch();
         }
     }
+
+    int unused = seats - static_cast<int>(result.promoted.size());
+    if (unused > 0) {
+        currentCapacity.fetch_sub(unused);
+    }
+
+    for (Ticket* ticket : issued) {
+        ticket->getUser()->attachTicket(ticket);
+    }
+    return result;
+}
+
+WaitlistPromotion Event::processWaitlist() {
+    return promoteWaitlist(maxCapacity.load());
+}
+
+WaitlistPromotion Event::raiseCapacity(int newMaxCapacity) {
+    int current = maxCapacity.load();
+    while (newMaxCapacity > current && !maxCapacity.compare_exchange_weak(current, newMaxCapacity)) {
+    }
+    if (newMaxCapacity > current) {
+        touch();
+        if (Journal* journal = Journal::active()) {
+            journal->capacityRaised(*this, newMaxCapacity);
+        }
+    }
+    return processWaitlist();
 }
 
 void Event::cancelEvent() {
-    for (const auto& ticket : tickets) {
+    std::lock_guard<std::mutex> lock(registryMutex);
+    int refundedCount = 0;
+    for (Ticket* ticket : tickets) {
         User* user = ticket->getUser();
         user->addToBudget(ticketPrice); // Refund all tickets
+        user->releaseTicket(ticket);
         std::cout << "Event cancelled. Refund issued to " << user->getUsername() 
                   << " for the amount of $" << ticketPrice << std::endl;
+        ticketPool.destroy(ticket);
+        ++refundedCount;
     }
     tickets.clear();
-    currentCapacity = 0;
+    // Free only the seats of the destroyed tickets; sales still in flight keep theirs
+    currentCapacity.fetch_sub(refundedCount);
+    waitlist.clear();
+    touch();
+    if (Journal* journal = Journal::active()) {
+        journal->eventCancelled(*this);
+    }
+}
+
+CheckInResult Event::checkIn(RecordId ticketId) {
+    if (!tickets.mightContain(ticketId)) {
+        return CheckInResult::Filtered;
+    }
 
-    std::queue<User*> emptyQueue;
-    std::swap(waitlist, emptyQueue);
+    std::lock_guard<std::mutex> lock(registryMutex);
+    Ticket* ticket = tickets.find(ticketId);
+    if (ticket == nullptr) {
+        return CheckInResult::Unknown;
+    }
+    if (!ticket->getIsValid()) {
+        return CheckInResult::Cancelled;
+    }
+    if (!ticket->markCheckedIn()) {
+        return CheckInResult::AlreadyCheckedIn;
+    }
+    touch();
+    if (Journal* journal = Journal::active()) {
+        journal->ticketCheckedIn(*ticket);
+    }
+    return CheckInResult::Admitted;
+}
+
+CheckInResult Event::checkIn(const std::string& presented) {
+    RecordId ticketId;
+    if (!parseRecordId(presented, "TKT", ticketId)) {
+        return CheckInResult::Unknown;
+    }
+    return checkIn(ticketId);
 }
 
 std::string Event::toString() const {
+    std::lock_guard<std::mutex> lock(registryMutex);
     std::stringstream ss;
     auto timeToString = [](const std::chrono::system_clock::time_point& tp) {
         auto t = std::chrono::system_clock::to_time_t(tp);
@@ -98,11 +365,11 @@ std::string Event::toString() const {
         return ss.str();
     };
 
-    ss << "Event: " << name << "\n"
+    ss << "Event: " << getName() << "\n"
        << "Description: " << description << "\n"
        << "Organizer: " << organizer->getUsername() << "\n"
        << "Ticket Price: $" << std::fixed << std::setprecision(2) << ticketPrice << "\n"
-       << "Capacity: " << currentCapacity << "/" << maxCapacity << "\n"
+       << "Capacity: " << currentCapacity.load() << "/" << maxCapacity.load() << "\n"
        << "Public Event: " << (isPublic ? "Yes" : "No") << "\n"
        << "Allows Residents: " << (allowsResidents ? "Yes" : "No") << "\n"
        << "Allows Non-Residents: " << (allowsNonResidents ? "Yes" : "No") << "\n"
@@ -112,15 +379,16 @@ std::string Event::toString() const {
     return ss.str();
 }
 
-void Event::saveToFile(const std::string& filename) const {
+bool Event::saveToFile(const std::string& filename) const {
+    std::lock_guard<std::mutex> lock(registryMutex);
     std::ofstream file(filename);
     if (file.is_open()) {
-        file << name << std::endl;
+        file << getName() << std::endl;
         file << description << std::endl;
         file << organizer->getUsername() << std::endl;
         file << ticketPrice << std::endl;
-        file << maxCapacity << std::endl;
-        file << currentCapacity << std::endl;
+        file << maxCapacity.load() << std::endl;
+        file << currentCapacity.load() << std::endl;
         file << isPublic << std::endl;
         file << allowsResidents << std::endl;
         file << allowsNonResidents << std::endl;
@@ -135,20 +403,31 @@ void Event::saveToFile(const std::string& filename) const {
 
         // Save waitlist
         file << waitlist.size() << std::endl;
-        std::queue<User*> waitlistCopy = waitlist;
-        while (!waitlistCopy.empty()) {
-            file << waitlistCopy.front()->getUsername() << std::endl;
-            waitlistCopy.pop();
+        for (const User* user : waitlist) {
+            file << user->getUsername() << std::endl;
         }
 
         file.close();
         std::cout << "Event data saved to file: " << filename << std::endl;
+        return true;
     } else {
         std::cout << "Unable to open file: " << filename << std::endl;
+        return false;
     }
 }
 
-std::unique_ptr<Event> Event::loadFromFile(const std::string& filename, const std::vector<std::unique_ptr<User>>& users) {
+bool Event::saveChanged(const std::string& filename, std::uint64_t since, std::size_t& failed) const {
+    if (modified.load() <= since) {
+        return false;
+    }
+    if (!saveToFile(filename)) {
+        ++failed;
+        return false;
+    }
+    return true;
+}
+
+std::unique_ptr<Event> Event::loadFromFile(const std::string& filename, const UserDirectory& users) {
     std::ifstream file(filename);
     if (file.is_open()) {
         std::string name, description, organizerUsername;
@@ -163,10 +442,8 @@ std::unique_ptr<Event> Event::loadFromFile(const std::string& filename, const st
         file >> ticketPrice >> maxCapacity >> currentCapacity >> isPublic >> allowsResidents >> allowsNonResidents;
         file >> startTimeCount >> endTimeCount;
 
-        auto organizer = std::find_if(users.begin(), users.end(),
-            [&organizerUsername](const std::unique_ptr<User>& u) { return u->getUsername() == organizerUsername; });
-
-        if (organizer == users.end()) {
+        User* organizer = users.find(organizerUsername);
+        if (organizer == nullptr) {
             std::cout << "Organizer not found. Unable to load event." << std::endl;
             return nullptr;
         }
@@ -174,7 +451,7 @@ std::unique_ptr<Event> Event::loadFromFile(const std::string& filename, const st
         auto startTime = std::chrono::system_clock::time_point(std::chrono::system_clock::duration(startTimeCount));
         auto endTime = std::chrono::system_clock::time_point(std::chrono::system_clock::duration(endTimeCount));
 
-        auto event = std::unique_ptr<Event>(new Event(name, description, organizer->get(), ticketPrice, maxCapacity,
+        auto event = std::unique_ptr<Event>(new Event(name, description, organizer, ticketPrice, maxCapacity,
                                              isPublic, allowsResidents, allowsNonResidents, startTime, endTime));
         event->currentCapacity = currentCapacity;
 
@@ -184,10 +461,8 @@ std::unique_ptr<Event> Event::loadFromFile(const std::string& filename, const st
         for (int i = 0; i < ticketCount; ++i) {
             std::string username;
             file >> username;
-            auto user = std::find_if(users.begin(), users.end(),
-                [&username](const std::unique_ptr<User>& u) { return u->getUsername() == username; });
-            if (user != users.end()) {
-                event->tickets.push_back(std::unique_ptr<Ticket>(new Ticket(event.get(), user->get(), ticketPrice)));
+            if (User* user = users.find(username)) {
+                event->restoreTicket(user, ticketPrice);
             }
         }
 
@@ -197,10 +472,8 @@ std::unique_ptr<Event> Event::loadFromFile(const std::string& filename, const st
         for (int i = 0; i < waitlistSize; ++i) {
             std::string username;
             file >> username;
-            auto user = std::find_if(users.begin(), users.end(),
-                [&username](const std::unique_ptr<User>& u) { return u->getUsername() == username; });
-            if (user != users.end()) {
-                event->waitlist.push(user->get());
+            if (User* user = users.find(username)) {
+                event->waitlist.push_back(user);
             }
         }
 
@@ -219,7 +492,8 @@ void Event::displayAttendees() const {
         return;
     }
 
-    std::cout << "Attendees for event '" << name << "':" << std::endl;
+    std::lock_guard<std::mutex> lock(registryMutex);
+    std::cout << "Attendees for event '" << getName() << "':" << std::endl;
     for (const auto& ticket : tickets) {
         std::cout << ticket->getUser()->getUsername() << std::endl;
     }
@@ -3,28 +3,60 @@
 
 #include <string>
 #include <vector>
-#include <queue>
+#include <deque>
 #include <memory>
 #include <chrono>
+#include <atomic>
+#include <mutex>
+#include <cstdint>
+#include "ObjectPool.h"
+#include "Ticket.h"
+#include "TicketTable.h"
+#include "SymbolTable.h"
 
 class User;
-class Ticket;
+class UserDirectory;
+
+// Outcome of one batched waitlist pass
+struct WaitlistPromotion {
+    std::vector<User*> promoted;  // Users who received a ticket, in waitlist order
+    std::vector<User*> skipped;   // Users passed over (ineligible or short on funds); still waitlisted
+    double amountCharged = 0.0;   // Total deducted from promoted users' budgets
+};
+
+// Outcome of presenting a ticket id at the door
+enum class CheckInResult {
+    Admitted,
+    AlreadyCheckedIn, // Scanned before; not admitted again
+    Cancelled,        // Listed but no longer valid
+    Unknown,          // Passed the filter but not sold by this event
+    Filtered          // Turned away by the ticket filter, without a lookup
+};
+
+// Allocated from a shared pool; tickets come from the event's own ticketPool
+class Event : public PooledObject<Event> {
+    friend class Snapshot;
+    friend class Journal;
 
-class Event {
 private:
-    std::string name;
+    SymbolId nameId; // Interned in SymbolTable::shared()
     std::string description;
     User* organizer;
     double ticketPrice;
-    int maxCapacity;
-    int currentCapacity;
+    std::atomic<int> maxCapacity;
+    std::atomic<int> currentCapacity; // Seats claimed, reserved lock-free before a sale completes
     bool isPublic;
     bool allowsResidents;
     bool allowsNonResidents;
-    std::vector<std::unique_ptr<Ticket>> tickets;
-    std::queue<User*> waitlist;
+    // The event owns the one record of every ticket it sells; buyers hold
+    // plain handles into this pool, so a sale never copies the ticket.
+    ObjectPool<Ticket> ticketPool;
+    TicketTable tickets; // Indexed by ticket id and by buyer
+    std::deque<User*> waitlist;
+    mutable std::mutex registryMutex; // Guards ticketPool, tickets and waitlist
     std::chrono::system_clock::time_point startTime;
     std::chrono::system_clock::time_point endTime;
+    std::atomic<std::uint64_t> modified; // Generation of the last change, for incremental saves
 
 public:
     Event(const std::string& name, const std::string& description, User* organizer,
@@ -32,34 +64,66 @@ public:
           bool allowsResidents, bool allowsNonResidents,
           const std::chrono::system_clock::time_point& startTime = std::chrono::system_clock::now(),
           const std::chrono::system_clock::time_point& endTime = std::chrono::system_clock::now() + std::chrono::hours(24));
+    ~Event();
 
-    std::unique_ptr<Ticket> purchaseTicket(User* user);
+    Ticket* purchaseTicket(User* user);
     bool cancelTicket(const Ticket* ticket);
+    Ticket* findTicket(const User* user) const;
+    Ticket* findTicketById(RecordId id) const;
+    Ticket* restoreTicket(User* user, double price);
+    // For loading a ticket file: the buyer's ticket saved under id. Event files
+    // list buyers without ids, so a ticket restored from one that its buyer
+    // does not hold yet is taken over and given the id; failing that the
+    // ticket is restored. nullptr if another buyer's ticket already has the id.
+    Ticket* claimTicket(User* user, RecordId id, double price);
+    bool cancelTickets(const std::vector<const Ticket*>& toCancel);
     void addToWaitlist(User* user);
-    void processWaitlist();
+    WaitlistPromotion promoteWaitlist(int maxPromotions);
+    WaitlistPromotion processWaitlist();
+    WaitlistPromotion raiseCapacity(int newMaxCapacity);
     void cancelEvent();
+    // Validates a presented ticket id and marks the ticket used, so a second
+    // scan of the same ticket is refused. Safe to call from many door scanners
+    // at once; ids the filter rules out never take the registry lock.
+    CheckInResult checkIn(RecordId ticketId);
+    CheckInResult checkIn(const std::string& presented); // "TKT0042" or "42"
     std::string toString() const;
 
     // Getters
-    const std::string& getName() const { return name; }
+    const std::string& getName() const { return SymbolTable::shared().name(nameId); }
+    SymbolId getNameId() const { return nameId; }
     const std::string& getDescription() const { return description; }
     User* getOrganizer() const { return organizer; }
     double getTicketPrice() const { return ticketPrice; }
-    int getMaxCapacity() const { return maxCapacity; }
-    int getCurrentCapacity() const { return currentCapacity; }
+    int getMaxCapacity() const { return maxCapacity.load(); }
+    int getCurrentCapacity() const { return currentCapacity.load(); }
     bool getIsPublic() const { return isPublic; }
     bool getAllowsResidents() const { return allowsResidents; }
     bool getAllowsNonResidents() const { return allowsNonResidents; }
     const std::chrono::system_clock::time_point& getStartTime() const { return startTime; }
     const std::chrono::system_clock::time_point& getEndTime() const { return endTime; }
+    // Not synchronized with concurrent sales; read once selling has settled
+    const std::vector<Ticket*>& getTickets() const { return tickets.all(); }
+    std::uint64_t getModified() const { return modified.load(); }
 
     // File operations
-    void saveToFile(const std::string& filename) const;
-    static std::unique_ptr<Event> loadFromFile(const std::string& filename, const std::vector<std::unique_ptr<User>>& users);
+    bool saveToFile(const std::string& filename) const;
+    // Rewrites the event's file only if it changed after generation 'since'.
+    // Returns whether it was written; a failed write is added to 'failed'.
+    bool saveChanged(const std::string& filename, std::uint64_t since, std::size_t& failed) const;
+    static std::unique_ptr<Event> loadFromFile(const std::string& filename, const UserDirectory& users);
 
     // Helper methods
-    bool isSoldOut() const { return currentCapacity >= maxCapacity; }
+    bool isSoldOut() const { return currentCapacity.load() >= maxCapacity.load(); }
     void displayAttendees() const;
+
+private:
+    bool claimSeat();
+    int claimSeats(int wanted);
+    void releaseSeat();
+    bool canAttend(const User* user) const;
+    User* unregisterTicket(const Ticket* ticket);
+    void touch();
 };
 
 #endif // EVENT_H
\ No newline at end of file
@@ -0,0 +1,28 @@
+#include "EventDirectory.h"
+#include "Event.h"
+
+EventDirectory::EventDirectory() : count(0) {}
+
+EventDirectory::EventDirectory(const std::vector<std::unique_ptr<Event>>& events) : count(0) {
+    bySymbol.reserve(SymbolTable::shared().size());
+    for (const auto& event : events) {
+        add(event.get());
+    }
+}
+
+bool EventDirectory::add(Event* event) {
+    SymbolId id = event->getNameId();
+    if (id >= bySymbol.size()) {
+        bySymbol.resize(id + 1, nullptr);
+    }
+    if (bySymbol[id] != nullptr) {
+        return false;
+    }
+    bySymbol[id] = event;
+    ++count;
+    return true;
+}
+
+Event* EventDirectory::find(StringRef name) const {
+    return find(SymbolTable::shared().find(name));
+}
@@ -1,12 +1,33 @@
 #include "Facility.h"
 #include "Reservation.h"
 #include "User.h"
+#include "Journal.h"
 #include <iostream>
 #include <fstream>
 #include <algorithm>
 #include <iomanip>
 #include <chrono>
 
+namespace {
+    unsigned layoutBits(std::initializer_list<LayoutStyle> layouts) {
+        unsigned bits = 0;
+        for (LayoutStyle layout : layouts) {
+            bits |= 1u << static_cast<unsigned>(layout);
+        }
+        return bits;
+    }
+
+    // The first multiple of step at or after value
+    std::int64_t alignUp(std::int64_t value, std::int64_t step) {
+        std::int64_t remainder = ((value % step) + step) % step;
+        return remainder == 0 ? value : value + step - remainder;
+    }
+}
+
+Facility::Facility(int openingHour, int closingHour, int maxCapacity, std::initializer_list<LayoutStyle> layouts)
+    : calendar(openingHour), openingHour(openingHour), closingHour(closingHour), maxCapacity(maxCapacity),
+      layouts(layoutBits(layouts)) {}
+
 bool Facility::isAvailable(const std::chrono::system_clock::time_point& startTime, 
                            const std::chrono::system_clock::time_point& endTime) const {
     // Check if the facility is open during the requested time
@@ -18,70 +39,297 @@ bool Facility::isAvailable(const std::chrono::system_clock::time_point& startTim
     }
 
     // Check for conflicts with existing reservations
-    for (const auto& reservation : schedule) {
-        if ((startTime < reservation->getEndTime()) && (endTime > reservation->getStartTime())) {
+    return !hasConflict(startTime, endTime);
+}
+
+bool Facility::hasConflict(const std::chrono::system_clock::time_point& startTime,
+                           const std::chrono::system_clock::time_point& endTime) const {
+    std::int64_t start = ScheduleColumns::ticks(startTime);
+    std::int64_t end = ScheduleColumns::ticks(endTime);
+    switch (calendar.test(start, end)) {
+        case SlotCalendar::Free:
             return false;
+        case SlotCalendar::Busy:
+            return true;
+        default:
+            return columns.overlaps(start, end);
+    }
+}
+
+std::vector<TimeWindow> Facility::findFreeSlots(const std::chrono::system_clock::time_point& after,
+                                                std::chrono::system_clock::duration duration,
+                                                std::size_t count) const {
+    typedef std::chrono::system_clock Clock;
+    std::vector<TimeWindow> found;
+    const std::int64_t day = SlotCalendar::ticksPerDay();
+    const std::int64_t hour = day / 24;
+    const std::int64_t slot = hour * SlotCalendar::SLOT_MINUTES / 60;
+    const std::int64_t length = duration.count();
+    if (count == 0 || length <= 0 || length > (closingHour - openingHour) * hour) {
+        return found;
+    }
+
+    // Walks the gaps between bookings: a window that overlaps a booking moves
+    // past that booking's end, so a dense day costs one lookup per booking
+    // rather than one per quarter hour
+    std::int64_t cursor = alignUp(ScheduleColumns::ticks(after), slot);
+    const std::int64_t horizon = cursor + 366 * day;
+    while (found.size() < count && cursor < horizon) {
+        std::int64_t midnight = SlotCalendar::dayOf(cursor) * day;
+        cursor = std::max(cursor, midnight + openingHour * hour);
+        std::int64_t end = cursor + length;
+        if (end > midnight + closingHour * hour) {
+            cursor = midnight + day;
+            continue;
+        }
+
+        std::size_t first, last;
+        columns.window(cursor, end, first, last);
+        std::size_t row = columns.nextEndingAfter(first, last, cursor);
+        if (row < last) {
+            cursor = alignUp(columns.endAt(row), slot);
+            continue;
+        }
+
+        TimeWindow window = { Clock::time_point(Clock::duration(cursor)), Clock::time_point(Clock::duration(end)) };
+        if (!isAvailable(window.start, window.end)) {
+            // Refused by the hour rule, e.g. a short window inside one hour
+            cursor += slot;
+            continue;
+        }
+        found.push_back(window);
+        cursor = alignUp(end, slot);
+    }
+    return found;
+}
+
+std::vector<TimeWindow> Facility::findFreeSlots(const std::chrono::system_clock::time_point& after,
+                                                std::chrono::system_clock::duration duration,
+                                                std::size_t count, LayoutStyle layout) const {
+    if (!supportsLayout(layout)) {
+        return std::vector<TimeWindow>();
+    }
+    return findFreeSlots(after, duration, count);
+}
+
+void Facility::markFreeDays(const std::chrono::system_clock::time_point& firstDay, std::size_t dayCount,
+                            int startMinute, int endMinute, std::vector<std::uint64_t>& freeDays) const {
+    std::size_t words = (dayCount + 63) / 64;
+    if (freeDays.size() < words) {
+        freeDays.resize(words, 0);
+    }
+    // The opening-hours rule of isAvailable, which is the same every day
+    int startHour = startMinute / 60;
+    int endHour = (endMinute / 60) % 24;
+    if (startMinute < 0 || startHour < openingHour || endHour > closingHour || startHour >= endHour) {
+        return;
+    }
+
+    std::int64_t first = SlotCalendar::dayOf(ScheduleColumns::ticks(firstDay));
+    std::vector<std::uint64_t> free(words, 0), busy(words, 0);
+    bool decided = calendar.classifyDays(first, dayCount, startMinute, endMinute, free.data(), busy.data());
+    const std::int64_t ticksPerMinute = SlotCalendar::ticksPerDay() / (24 * 60);
+    for (std::size_t w = 0; w < words; ++w) {
+        // Days the bitmaps left open are checked against the columns
+        std::uint64_t undecided = decided ? ~(free[w] | busy[w]) : ~std::uint64_t(0);
+        if (dayCount - w * 64 < 64) {
+            undecided &= (std::uint64_t(1) << (dayCount - w * 64)) - 1;
         }
+        while (undecided != 0) {
+            int bit = __builtin_ctzll(undecided);
+            undecided &= undecided - 1;
+            std::int64_t midnight = (first + static_cast<std::int64_t>(w * 64 + bit)) * SlotCalendar::ticksPerDay();
+            if (!columns.overlaps(midnight + startMinute * ticksPerMinute, midnight + endMinute * ticksPerMinute)) {
+                free[w] |= std::uint64_t(1) << bit;
+            }
+        }
+        freeDays[w] |= free[w];
     }
+}
+
+void Facility::indexReservation(Reservation* reservation) {
+    columns.insert(*reservation);
+    calendar.add(ScheduleColumns::ticks(reservation->getStartTime()), ScheduleColumns::ticks(reservation->getEndTime()));
+    usageByUser[reservation->getUser()].add(reservation->getStartTime(), reservation->getEndTime());
+    reservation->touch(); // Its file under the facility is new
+    modified = Generation::next();
+}
+
+void Facility::unindexReservation(const Reservation* reservation) {
+    columns.erase(*reservation);
 
+    // Slots can be shared, so the days it covered are rebuilt from the bookings left
+    std::int64_t start = ScheduleColumns::ticks(reservation->getStartTime());
+    std::int64_t end = ScheduleColumns::ticks(reservation->getEndTime());
+    if (end > start) {
+        std::int64_t firstDay = SlotCalendar::dayOf(start);
+        std::int64_t lastDay = SlotCalendar::dayOf(end - 1);
+        calendar.clearDays(firstDay, lastDay);
+        std::int64_t from = firstDay * SlotCalendar::ticksPerDay();
+        std::int64_t to = (lastDay + 1) * SlotCalendar::ticksPerDay();
+        std::size_t first, last;
+        columns.window(from, to, first, last);
+        for (std::size_t row = columns.nextEndingAfter(first, last, from); row < last;
+             row = columns.nextEndingAfter(row + 1, last, from)) {
+            calendar.add(columns.startAt(row), columns.endAt(row));
+        }
+    }
+
+    auto usage = usageByUser.find(reservation->getUser());
+    if (usage != usageByUser.end()) {
+        usage->second.remove(reservation->getStartTime(), reservation->getEndTime());
+    }
+    modified = Generation::next();
+}
+
+bool Facility::insertReservation(ReservationHandle handle) {
+    if (!schedule.add(handle)) {
+        return false;
+    }
+    ReservationStore::shared().setState(handle, ReservationState::Approved);
+    indexReservation(ReservationStore::shared().get(handle));
     return true;
 }
 
-bool Facility::addReservation(std::unique_ptr<Reservation> reservation) {
-    if (isAvailable(reservation->getStartTime(), reservation->getEndTime())) {
-        schedule.push_back(std::move(reservation));
-        return true;
+bool Facility::addReservation(ReservationHandle handle) {
+    const Reservation* reservation = ReservationStore::shared().get(handle);
+    if (reservation != nullptr && isAvailable(reservation->getStartTime(), reservation->getEndTime())) {
+        return insertReservation(handle);
     }
     return false;
 }
 
-void Facility::removeReservation(const std::string& reservationId) {
-    auto it = std::find_if(schedule.begin(), schedule.end(),
-        [&reservationId](const std::unique_ptr<Reservation>& r) { return r->getId() == reservationId; });
-    
-    if (it != schedule.end()) {
-        schedule.erase(it);
+bool Facility::addReservation(std::unique_ptr<Reservation> reservation) {
+    ReservationStore& store = ReservationStore::shared();
+    ReservationHandle handle = store.adopt(std::move(reservation));
+    bool added = addReservation(handle);
+    store.discardIfUnheld(handle);
+    return added;
+}
+
+void Facility::removeReservation(RecordId reservationId) {
+    Reservation* reservation = schedule.get(reservationId);
+    if (reservation != nullptr) {
+        if (Journal* journal = Journal::active()) {
+            journal->reservationUnscheduled(reservationId);
+        }
+        unindexReservation(reservation);
+        schedule.remove(reservationId);
     }
 }
 
-const std::vector<std::unique_ptr<Reservation>>& Facility::getReservations() const {
+const ReservationList& Facility::getReservations() const {
     return schedule;
 }
 
-void Facility::displaySchedule() const {
-    std::cout << "Facility Schedule:" << std::endl;
-    std::cout << "Operating Hours: " << openingHour << ":00 - " << closingHour << ":00" << std::endl;
-    std::cout << "Maximum Capacity: " << maxCapacity << " guests" << std::endl;
-    std::cout << std::endl;
-
-    if (schedule.empty()) {
-        std::cout << "No reservations scheduled." << std::endl;
-        return;
-    }
+double Facility::getWeeklyHours(const User* user) const {
+    auto usage = usageByUser.find(user);
+    return usage != usageByUser.end() ? usage->second.weeklyHours() : 0.0;
+}
 
-    // Sort reservations by start time
-    std::vector<Reservation*> sortedSchedule;
-    for (const auto& res : schedule) {
-        sortedSchedule.push_back(res.get());
+namespace {
+    void printScheduleHeader(int openingHour, int closingHour, int maxCapacity) {
+        std::cout << "Facility Schedule:" << std::endl;
+        std::cout << "Operating Hours: " << openingHour << ":00 - " << closingHour << ":00" << std::endl;
+        std::cout << "Maximum Capacity: " << maxCapacity << " guests" << std::endl;
+        std::cout << std::endl;
     }
-    std::sort(sortedSchedule.begin(), sortedSchedule.end(),
-        [](const Reservation* a, const Reservation* b) { return a->getStartTime() < b->getStartTime(); });
 
-    // Display reservations
-    for (const auto& reservation : sortedSchedule) {
+    void printScheduleLine(const Reservation* reservation) {
         auto startTime = std::chrono::system_clock::to_time_t(reservation->getStartTime());
         auto endTime = std::chrono::system_clock::to_time_t(reservation->getEndTime());
 
         std::cout << std::put_time(std::localtime(&startTime), "%Y-%m-%d %H:%M") << " - "
                   << std::put_time(std::localtime(&endTime), "%H:%M") << " : "
-                  << reservation->getUser()->getUsername()
+                  << (reservation->getUser() ? reservation->getUser()->getUsername() : "(no user)")
                   << " (Layout: " << layoutStyleToString(reservation->getLayoutStyle()) << ")"
                   << (reservation->getIsPublic() ? " [Public]" : " [Private]")
                   << std::endl;
     }
 }
 
+ScheduleView::ScheduleView(const ScheduleColumns& columns, const ReservationList& schedule,
+                           std::int64_t start, std::int64_t end)
+    : columns(&columns), schedule(&schedule), first(0), last(0), start(start) {
+    columns.window(start, end, first, last);
+}
+
+ScheduleView Facility::reservationsBetween(const std::chrono::system_clock::time_point& from,
+                                           const std::chrono::system_clock::time_point& to) const {
+    return ScheduleView(columns, schedule, ScheduleColumns::ticks(from), ScheduleColumns::ticks(to));
+}
+
+void Facility::displaySchedule() const {
+    printScheduleHeader(openingHour, closingHour, maxCapacity);
+
+    if (schedule.empty()) {
+        std::cout << "No reservations scheduled." << std::endl;
+        return;
+    }
+
+    // The columns are kept in start order, so nothing needs sorting
+    for (std::size_t row = 0; row < columns.size(); ++row) {
+        printScheduleLine(schedule.get(columns.idAt(row)));
+    }
+}
+
+bool Facility::displaySchedule(const std::chrono::system_clock::time_point& from,
+                               const std::chrono::system_clock::time_point& to,
+                               std::size_t page, std::size_t pageSize) const {
+    printScheduleHeader(openingHour, closingHour, maxCapacity);
+    if (pageSize == 0) {
+        pageSize = 1;
+    }
+
+    ScheduleView view = reservationsBetween(from, to);
+    ScheduleView::const_iterator it = view.begin();
+    for (std::size_t skipped = 0; skipped < page * pageSize && it != view.end(); ++skipped) {
+        ++it;
+    }
+    if (it == view.end()) {
+        std::cout << "No reservations scheduled in this period." << std::endl;
+        return false;
+    }
+
+    for (std::size_t shown = 0; shown < pageSize && it != view.end(); ++shown, ++it) {
+        printScheduleLine(*it);
+    }
+    bool more = it != view.end();
+    if (more) {
+        std::cout << "(more on page " << page + 2 << ")" << std::endl;
+    }
+    return more;
+}
+
 void Facility::saveToFile(const std::string& filename) const {
+    saveIndexFile(filename);
+    for (const auto& reservation : schedule) {
+        reservation->saveToFile(filename + "_" + reservation->getIdString());
+    }
+}
+
+std::size_t Facility::saveChanged(const std::string& filename, std::uint64_t since, std::size_t& failed) const {
+    std::size_t written = 0;
+    for (const auto& reservation : schedule) {
+        if (reservation->getModified() > since) {
+            if (reservation->saveToFile(filename + "_" + reservation->getIdString())) {
+                ++written;
+            } else {
+                ++failed;
+            }
+        }
+    }
+    if (modified > since) {
+        if (saveIndexFile(filename)) {
+            ++written;
+        } else {
+            ++failed;
+        }
+    }
+    return written;
+}
+
+bool Facility::saveIndexFile(const std::string& filename) const {
     std::ofstream file(filename);
     if (file.is_open()) {
         file << openingHour << std::endl;
@@ -90,27 +338,24 @@ void Facility::saveToFile(const std::string& filename) const {
         
         file << schedule.size() << std::endl;
         for (const auto& reservation : schedule) {
-            file << reservation->getId() << std::endl;
-            reservation->saveToFile(filename + "_" + reservation->getId());
+            file << reservation->getIdString() << std::endl;
         }
 
         file.close();
         std::cout << "Facility data saved to file: " << filename << std::endl;
+        return true;
     } else {
         std::cout << "Unable to open file: " << filename << std::endl;
+        return false;
     }
 }
 
 std::unique_ptr<Facility> Facility::loadFromFile(const std::string& filename) {
     std::ifstream file(filename);
     if (file.is_open()) {
-        auto facility = std::unique_ptr<Facility>(new Facility());
-        
         int openingHour, closingHour, maxCapacity;
         file >> openingHour >> closingHour >> maxCapacity;
-
-        // Note: We don't set these values as they are const in the class.
-        // In a real-world scenario, you might want to make these configurable.
+        auto facility = std::unique_ptr<Facility>(new Facility(openingHour, closingHour, maxCapacity));
 
         int scheduleSize;
         file >> scheduleSize;
@@ -119,7 +364,10 @@ std::unique_ptr<Facility> Facility::loadFromFile(const std::string& filename) {
             file >> reservationId;
             auto reservation = Reservation::loadFromFile(filename + "_" + reservationId, nullptr);
             if (reservation) {
-                facility->schedule.push_back(std::move(reservation));
+                ReservationStore& store = ReservationStore::shared();
+                ReservationHandle handle = store.adopt(std::move(reservation));
+                facility->insertReservation(handle);
+                store.discardIfUnheld(handle);
             }
         }
 
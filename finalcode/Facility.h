@@ -2,35 +2,155 @@
 #define FACILITY_H
 
 #include <vector>
+#include <unordered_map>
 #include <memory>
 #include <chrono>
+#include <string>
+#include <cstdint>
+#include <cstddef>
+#include <iterator>
+#include <initializer_list>
+#include "UsageTracker.h"
+#include "RecordId.h"
+#include "Generation.h"
+#include "ReservationStore.h"
+#include "ScheduleColumns.h"
+#include "SlotCalendar.h"
+#include "LayoutStyle.h"
 
-class Reservation;
+class User;
+
+// The scheduled reservations overlapping one window, in start order. Reads the
+// schedule columns in place, so it costs a binary search plus the rows near
+// the window; any change to the schedule invalidates it.
+class ScheduleView {
+private:
+    const ScheduleColumns* columns;
+    const ReservationList* schedule;
+    std::size_t first;
+    std::size_t last;
+    std::int64_t start;
+
+public:
+    class const_iterator {
+    private:
+        const ScheduleView* view;
+        std::size_t row;
+
+    public:
+        typedef std::forward_iterator_tag iterator_category;
+        typedef Reservation* value_type;
+        typedef std::ptrdiff_t difference_type;
+        typedef Reservation* const* pointer;
+        typedef Reservation* reference;
+
+        const_iterator(const ScheduleView* view, std::size_t row) : view(view), row(row) {}
+
+        Reservation* operator*() const { return view->schedule->get(view->columns->idAt(row)); }
+        const_iterator& operator++() {
+            row = view->columns->nextEndingAfter(row + 1, view->last, view->start);
+            return *this;
+        }
+        bool operator==(const const_iterator& other) const { return row == other.row; }
+        bool operator!=(const const_iterator& other) const { return row != other.row; }
+    };
+
+    ScheduleView(const ScheduleColumns& columns, const ReservationList& schedule,
+                 std::int64_t start, std::int64_t end);
+
+    const_iterator begin() const { return const_iterator(this, columns->nextEndingAfter(first, last, start)); }
+    const_iterator end() const { return const_iterator(this, last); }
+    bool empty() const { return begin() == end(); }
+};
+
+// A free stretch of the facility's time
+struct TimeWindow {
+    std::chrono::system_clock::time_point start;
+    std::chrono::system_clock::time_point end;
+};
 
 class Facility {
+    friend class Snapshot;
+    friend class Journal;
+
 private:
-    std::vector<std::unique_ptr<Reservation>> schedule;
-    const int openingHour = 8;  // 8 AM
-    const int closingHour = 23; // 11 PM
-    const int maxCapacity = 40;
+    ReservationList schedule;
+    // Start and end times of the schedule in columns ordered by start, so
+    // conflict checks scan O(log n + k) contiguous rows instead of the whole schedule.
+    ScheduleColumns columns;
+    // Per-day 15-minute occupancy bitmaps of the same bookings; decides most
+    // availability checks with a mask and a test before the columns are read.
+    SlotCalendar calendar;
+    // Booked hours per user, kept in step with the schedule for the weekly limits.
+    std::unordered_map<const User*, UsageTracker> usageByUser;
+    std::uint64_t modified = Generation::next(); // Last change to the schedule's membership
+    const int openingHour; // Hour of the day (UTC) bookings may start from
+    const int closingHour; // Hour of the day bookings must end by
+    const int maxCapacity; // Guests
+    const unsigned layouts; // Bit per LayoutStyle the room can be set up in
+
+    bool hasConflict(const std::chrono::system_clock::time_point& startTime,
+                     const std::chrono::system_clock::time_point& endTime) const;
+    void indexReservation(Reservation* reservation);
+    void unindexReservation(const Reservation* reservation);
+    // Puts a reservation on the schedule without checking availability
+    bool insertReservation(ReservationHandle handle);
+    bool saveIndexFile(const std::string& filename) const;
 
 public:
-    Facility() = default;
+    // The defaults are the community center's main hall: 8 AM to 11 PM, 40
+    // guests, every layout
+    explicit Facility(int openingHour = 8, int closingHour = 23, int maxCapacity = 40,
+                      std::initializer_list<LayoutStyle> layouts = { LayoutStyle::Meeting, LayoutStyle::Lecture,
+                                                                     LayoutStyle::Wedding, LayoutStyle::Dance });
 
-    bool isAvailable(const std::chrono::system_clock::time_point& startTime, 
+    bool isAvailable(const std::chrono::system_clock::time_point& startTime,
                      const std::chrono::system_clock::time_point& endTime) const;
+    // Schedules the reservation if its time is free; it stays held by whoever else holds it
+    bool addReservation(ReservationHandle handle);
     bool addReservation(std::unique_ptr<Reservation> reservation);
-    void removeReservation(const std::string& reservationId);
-    const std::vector<std::unique_ptr<Reservation>>& getReservations() const;
+    void removeReservation(RecordId reservationId);
+    const ReservationList& getReservations() const;
+    // The first 'count' bookable windows of 'duration' starting at or after
+    // 'after', earliest first and not overlapping each other. Windows start on
+    // the quarter hour, lie within opening hours and pass isAvailable. Looks
+    // at most a year ahead; empty if the duration never fits in a day.
+    std::vector<TimeWindow> findFreeSlots(const std::chrono::system_clock::time_point& after,
+                                          std::chrono::system_clock::duration duration, std::size_t count) const;
+    // As above, and empty if the facility cannot be set up in the layout
+    std::vector<TimeWindow> findFreeSlots(const std::chrono::system_clock::time_point& after,
+                                          std::chrono::system_clock::duration duration, std::size_t count,
+                                          LayoutStyle layout) const;
+    // For the window [startMinute, endMinute) (minutes after midnight, UTC) of
+    // each of dayCount days from firstDay's day, sets bit i of freeDays if the
+    // facility is open and free then on day i. freeDays grows to hold
+    // (dayCount + 63) / 64 words and is OR-ed into, so rooms can share it.
+    void markFreeDays(const std::chrono::system_clock::time_point& firstDay, std::size_t dayCount,
+                      int startMinute, int endMinute, std::vector<std::uint64_t>& freeDays) const;
+    // Reservations overlapping [from, to), in start order
+    ScheduleView reservationsBetween(const std::chrono::system_clock::time_point& from,
+                                     const std::chrono::system_clock::time_point& to) const;
     void displaySchedule() const;
+    // Shows page 'page' (from 0) of the reservations overlapping [from, to),
+    // pageSize to a page. Returns true if later pages remain.
+    bool displaySchedule(const std::chrono::system_clock::time_point& from,
+                         const std::chrono::system_clock::time_point& to,
+                         std::size_t page, std::size_t pageSize) const;
+    double getWeeklyHours(const User* user) const;
+    std::uint64_t getModified() const { return modified; }
 
     // Getters for facility properties
     int getOpeningHour() const { return openingHour; }
     int getClosingHour() const { return closingHour; }
     int getMaxCapacity() const { return maxCapacity; }
+    bool supportsLayout(LayoutStyle layout) const { return (layouts & (1u << static_cast<unsigned>(layout))) != 0; }
 
     // File I/O operations
     void saveToFile(const std::string& filename) const;
+    // Rewrites the schedule index if reservations came or went after
+    // generation 'since', and the files of reservations changed since then.
+    // Returns the number of files written.
+    std::size_t saveChanged(const std::string& filename, std::uint64_t since, std::size_t& failed) const;
     static std::unique_ptr<Facility> loadFromFile(const std::string& filename);
 };
 
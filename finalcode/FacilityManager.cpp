@@ -1,25 +1,38 @@
 #include "FacilityManager.h"
 #include "Facility.h"
 #include "User.h"
+#include "Journal.h"
+#include "Generation.h"
+#include "UserDirectory.h"
 #include <iostream>
 #include <fstream>
 #include <algorithm>
 #include <chrono>
 
-FacilityManager::FacilityManager(Facility& facility) : facility(facility), budget(0.0) {}
-
-bool FacilityManager::approveReservation(const std::string& reservationId) {
-    auto it = std::find_if(pendingReservations.begin(), pendingReservations.end(),
-        [&reservationId](const std::unique_ptr<Reservation>& r) { return r->getId() == reservationId; });
-    
-    if (it != pendingReservations.end()) {
-        if ((*it)->getIsPaid()) {
-            if (facility.isAvailable((*it)->getStartTime(), (*it)->getEndTime())) {
-                if (checkReservationLimits((*it)->getUser(), it->get())) {
-                    facility.addReservation(std::move(*it));
-                    updateBudget((*it)->getTotalCost());
-                    std::cout << "Reservation " << reservationId << " approved and added to the facility schedule." << std::endl;
-                    pendingReservations.erase(it);
+FacilityManager::FacilityManager(Facility& facility)
+    : facility(facility), budget(0.0), modified(Generation::next()) {}
+
+void FacilityManager::touch() {
+    modified = Generation::next();
+}
+
+bool FacilityManager::approveReservation(RecordId reservationId) {
+    ReservationHandle handle = pendingReservations.find(reservationId);
+    Reservation* reservation = ReservationStore::shared().get(handle);
+
+    if (reservation != nullptr) {
+        if (reservation->getIsPaid()) {
+            if (facility.isAvailable(reservation->getStartTime(), reservation->getEndTime())) {
+                if (checkReservationLimits(reservation->getUser(), reservation)) {
+                    double cost = reservation->getTotalCost();
+                    facility.addReservation(handle);
+                    updateBudget(cost);
+                    if (Journal* journal = Journal::active()) {
+                        journal->reservationApproved(reservationId);
+                    }
+                    std::cout << "Reservation " << formatRecordId("RES", reservationId) << " approved and added to the facility schedule." << std::endl;
+                    pendingReservations.remove(reservationId);
+                    touch();
                     return true;
                 } else {
                     std::cout << "Reservation exceeds user's weekly limit." << std::endl;
@@ -36,16 +49,21 @@ bool FacilityManager::approveReservation(const std::string& reservationId) {
     return false;
 }
 
-bool FacilityManager::rejectReservation(const std::string& reservationId) {
-    auto it = std::find_if(pendingReservations.begin(), pendingReservations.end(),
-        [&reservationId](const std::unique_ptr<Reservation>& r) { return r->getId() == reservationId; });
-    
-    if (it != pendingReservations.end()) {
-        if ((*it)->getIsPaid()) {
-            processRefund((*it)->getTotalCost());
+bool FacilityManager::rejectReservation(RecordId reservationId) {
+    ReservationHandle handle = pendingReservations.find(reservationId);
+    Reservation* reservation = ReservationStore::shared().get(handle);
+
+    if (reservation != nullptr) {
+        if (reservation->getIsPaid()) {
+            processRefund(reservation->getTotalCost());
+        }
+        ReservationStore::shared().setState(handle, ReservationState::Rejected);
+        if (Journal* journal = Journal::active()) {
+            journal->reservationRejected(reservationId);
         }
-        std::cout << "Reservation " << reservationId << " rejected." << std::endl;
-        pendingReservations.erase(it);
+        std::cout << "Reservation " << formatRecordId("RES", reservationId) << " rejected." << std::endl;
+        pendingReservations.remove(reservationId);
+        touch();
         return true;
     }
     std::cout << "Reservation not found." << std::endl;
@@ -54,37 +72,34 @@ bool FacilityManager::rejectReservation(const std::string& reservationId) {
 
 void FacilityManager::processRefund(double amount) {
     budget -= amount;
+    touch();
+    if (Journal* journal = Journal::active()) {
+        journal->managerBudgetChanged(-amount);
+    }
     std::cout << "Refund processed: $" << amount << std::endl;
 }
 
 void FacilityManager::updateBudget(double amount) {
     budget += amount;
+    touch();
+    if (Journal* journal = Journal::active()) {
+        journal->managerBudgetChanged(amount);
+    }
     std::cout << "Budget updated. New balance: $" << budget << std::endl;
 }
 
 bool FacilityManager::checkReservationLimits(const User* user, const Reservation* newReservation) const {
-    auto now = std::chrono::system_clock::now();
-    auto oneWeekAgo = now - std::chrono::hours(24 * 7);
-    
-    std::chrono::duration<double, std::ratio<3600>> totalHours(0);
-
-    for (const auto& reservation : facility.getReservations()) {
-        if (reservation->getUser() == user && reservation->getStartTime() >= oneWeekAgo) {
-            totalHours += std::chrono::duration_cast<std::chrono::duration<double, std::ratio<3600>>>(
-                reservation->getEndTime() - reservation->getStartTime());
-        }
-    }
-
+    double totalHours = facility.getWeeklyHours(user);
     totalHours += std::chrono::duration_cast<std::chrono::duration<double, std::ratio<3600>>>(
-        newReservation->getEndTime() - newReservation->getStartTime());
+        newReservation->getEndTime() - newReservation->getStartTime()).count();
 
     switch (user->getType()) {
         case UserType::City:
-            return totalHours.count() <= 48;
+            return totalHours <= 48;
         case UserType::Organization:
-            return totalHours.count() <= 36;
+            return totalHours <= 36;
         default:
-            return totalHours.count() <= 24;
+            return totalHours <= 24;
     }
 }
 
@@ -103,34 +118,81 @@ void FacilityManager::displayBudget() const {
     std::cout << "Current Budget: $" << budget << std::endl;
 }
 
-void FacilityManager::addPendingReservation(std::unique_ptr<Reservation> reservation) {
-    pendingReservations.push_back(std::move(reservation));
+void FacilityManager::addPendingReservation(ReservationHandle handle) {
+    ReservationStore& store = ReservationStore::shared();
+    if (!pendingReservations.add(handle)) {
+        std::cout << "Reservation is already pending or no longer exists." << std::endl;
+        return;
+    }
+    Reservation* reservation = store.get(handle);
+    if (Journal* journal = Journal::active()) {
+        journal->reservationSubmitted(*reservation);
+    }
+    store.setState(handle, ReservationState::Pending);
+    reservation->touch(); // Its file under the pending list is new
+    touch();
     std::cout << "Reservation added to pending list. Waiting for approval." << std::endl;
 }
 
+void FacilityManager::addPendingReservation(std::unique_ptr<Reservation> reservation) {
+    ReservationStore& store = ReservationStore::shared();
+    ReservationHandle handle = store.adopt(std::move(reservation));
+    addPendingReservation(handle);
+    store.discardIfUnheld(handle);
+}
+
 bool FacilityManager::isAvailable(const std::chrono::system_clock::time_point& startTime, 
                                   const std::chrono::system_clock::time_point& endTime) const {
     return facility.isAvailable(startTime, endTime);
 }
 
 void FacilityManager::saveToFile(const std::string& filename) const {
+    saveIndexFile(filename);
+    for (const auto& reservation : pendingReservations) {
+        reservation->saveToFile(filename + "_" + reservation->getIdString());
+    }
+}
+
+std::size_t FacilityManager::saveChanged(const std::string& filename, std::uint64_t since, std::size_t& failed) const {
+    std::size_t written = 0;
+    for (const auto& reservation : pendingReservations) {
+        if (reservation->getModified() > since) {
+            if (reservation->saveToFile(filename + "_" + reservation->getIdString())) {
+                ++written;
+            } else {
+                ++failed;
+            }
+        }
+    }
+    if (modified > since) {
+        if (saveIndexFile(filename)) {
+            ++written;
+        } else {
+            ++failed;
+        }
+    }
+    return written;
+}
+
+bool FacilityManager::saveIndexFile(const std::string& filename) const {
     std::ofstream file(filename);
     if (file.is_open()) {
         file << budget << std::endl;
         file << pendingReservations.size() << std::endl;
         for (const auto& reservation : pendingReservations) {
-            file << reservation->getId() << std::endl;
+            file << reservation->getIdString() << std::endl;
             file << reservation->getUser()->getUsername() << std::endl;  // Save the username
-            reservation->saveToFile(filename + "_" + reservation->getId());
         }
         file.close();
         std::cout << "FacilityManager data saved to file: " << filename << std::endl;
+        return true;
     } else {
         std::cout << "Unable to open file: " << filename << std::endl;
+        return false;
     }
 }
 
-void FacilityManager::loadFromFile(const std::string& filename, const std::vector<std::unique_ptr<User>>& users) {
+void FacilityManager::loadFromFile(const std::string& filename, const UserDirectory& users) {
     std::ifstream file(filename);
     if (file.is_open()) {
         file >> budget;
@@ -145,20 +207,25 @@ void FacilityManager::loadFromFile(const std::string& filename, const std::vecto
             file >> username;
             
             // Find the user
-            auto userIt = std::find_if(users.begin(), users.end(),
-                [&username](const std::unique_ptr<User>& u) { return u->getUsername() == username; });
+            User* user = users.find(username);
             
-            if (userIt != users.end()) {
+            if (user != nullptr) {
                 // Load the reservation with the correct user
-                auto reservation = Reservation::loadFromFile(filename + "_" + reservationId, userIt->get());
+                auto reservation = Reservation::loadFromFile(filename + "_" + reservationId, user);
                 if (reservation) {
-                    pendingReservations.push_back(std::move(reservation));
+                    ReservationStore& store = ReservationStore::shared();
+                    ReservationHandle handle = store.adopt(std::move(reservation));
+                    if (pendingReservations.add(handle)) {
+                        store.setState(handle, ReservationState::Pending);
+                    }
+                    store.discardIfUnheld(handle);
                 }
             } else {
                 std::cout << "User not found for reservation: " << reservationId << std::endl;
             }
         }
         file.close();
+        touch();
         std::cout << "FacilityManager data loaded from file: " << filename << std::endl;
     } else {
         std::cout << "Unable to open file: " << filename << std::endl;
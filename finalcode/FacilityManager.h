@@ -4,33 +4,51 @@
 #include <vector>
 #include <memory>
 #include <string>
+#include <cstdint>
+#include <cstddef>
 #include "Reservation.h"
+#include "ReservationStore.h"
 
 class Facility;
+class UserDirectory;
 
 class FacilityManager {
+    friend class Snapshot;
+    friend class Journal;
+
 private:
     Facility& facility;
-    std::vector<std::unique_ptr<Reservation>> pendingReservations;
+    ReservationList pendingReservations;
     double budget;
+    std::uint64_t modified; // Last change to the budget or the pending list
+
+    void touch();
+    bool saveIndexFile(const std::string& filename) const;
 
 public:
     FacilityManager(Facility& facility);
 
-    bool approveReservation(const std::string& reservationId);
-    bool rejectReservation(const std::string& reservationId);
+    bool approveReservation(RecordId reservationId);
+    bool rejectReservation(RecordId reservationId);
     void processRefund(double amount);
     void updateBudget(double amount);
     bool checkReservationLimits(const User* user, const Reservation* newReservation) const;
     void displayPendingReservations() const;
     void displayBudget() const;
+    // Queues a reservation for approval; the user who booked it keeps holding it
+    void addPendingReservation(ReservationHandle handle);
     void addPendingReservation(std::unique_ptr<Reservation> reservation);
     bool isAvailable(const std::chrono::system_clock::time_point& startTime, 
                      const std::chrono::system_clock::time_point& endTime) const;
 
     // File I/O operations
     void saveToFile(const std::string& filename) const;
-    void loadFromFile(const std::string& filename, const std::vector<std::unique_ptr<User>>& users);
+    void loadFromFile(const std::string& filename, const UserDirectory& users);
+    // Rewrites the pending index if the budget or pending list changed after
+    // generation 'since', and the files of pending reservations changed since
+    // then. Returns the number of files written.
+    std::size_t saveChanged(const std::string& filename, std::uint64_t since, std::size_t& failed) const;
+    std::uint64_t getModified() const { return modified; }
 };
 
 #endif // FACILITY_MANAGER_H
\ No newline at end of file
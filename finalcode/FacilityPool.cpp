@@ -0,0 +1,127 @@
+#include "FacilityPool.h"
+#include <thread>
+#include <algorithm>
+
+namespace {
+    // Runs work(block, begin, end) over 'blocks' contiguous slices of [0, count),
+    // the first on the calling thread
+    template<typename Work>
+    void forEachBlock(std::size_t count, std::size_t blocks, Work work) {
+        std::size_t blockSize = (count + blocks - 1) / blocks;
+        std::vector<std::thread> workers;
+        for (std::size_t block = 1; block < blocks; ++block) {
+            std::size_t begin = std::min(count, block * blockSize);
+            std::size_t end = std::min(count, begin + blockSize);
+            workers.push_back(std::thread(work, block, begin, end));
+        }
+        work(0, 0, std::min(count, blockSize));
+        for (auto& worker : workers) {
+            worker.join();
+        }
+    }
+}
+
+const std::size_t FacilityPool::NO_ROOM;
+
+FacilityPool::FacilityPool(unsigned threadCount, std::size_t parallelThreshold)
+    : threadCount(threadCount), parallelThreshold(parallelThreshold) {
+    if (this->threadCount == 0) {
+        this->threadCount = std::thread::hardware_concurrency();
+    }
+    if (this->threadCount == 0) {
+        this->threadCount = 1;
+    }
+}
+
+std::size_t FacilityPool::addRoom(const std::string& name, int openingHour, int closingHour, int maxCapacity,
+                                  std::initializer_list<LayoutStyle> layouts) {
+    Room room;
+    room.name = name;
+    room.facility.reset(new Facility(openingHour, closingHour, maxCapacity, layouts));
+    rooms.push_back(std::move(room));
+    return rooms.size() - 1;
+}
+
+bool FacilityPool::fits(const Room& room, const std::chrono::system_clock::time_point& startTime,
+                        const std::chrono::system_clock::time_point& endTime, int guests, LayoutStyle layout) const {
+    return room.facility->supportsLayout(layout) && room.facility->getMaxCapacity() >= guests &&
+           room.facility->isAvailable(startTime, endTime);
+}
+
+std::vector<std::size_t> FacilityPool::freeRooms(const std::chrono::system_clock::time_point& startTime,
+                                                 const std::chrono::system_clock::time_point& endTime) const {
+    std::size_t blocks = rooms.size() >= parallelThreshold ? std::min<std::size_t>(threadCount, rooms.size()) : 1;
+    std::vector<std::vector<std::size_t>> found(blocks);
+    forEachBlock(rooms.size(), blocks, [&](std::size_t block, std::size_t begin, std::size_t end) {
+        for (std::size_t i = begin; i < end; ++i) {
+            if (rooms[i].facility->isAvailable(startTime, endTime)) {
+                found[block].push_back(i);
+            }
+        }
+    });
+
+    // Blocks are in room order, so joining them keeps the indexes ascending
+    std::vector<std::size_t> free;
+    for (const auto& block : found) {
+        free.insert(free.end(), block.begin(), block.end());
+    }
+    return free;
+}
+
+std::size_t FacilityPool::bestRoom(const std::chrono::system_clock::time_point& startTime,
+                                   const std::chrono::system_clock::time_point& endTime,
+                                   int guests, LayoutStyle layout) const {
+    std::size_t blocks = rooms.size() >= parallelThreshold ? std::min<std::size_t>(threadCount, rooms.size()) : 1;
+    std::vector<std::size_t> best(blocks, NO_ROOM);
+    forEachBlock(rooms.size(), blocks, [&](std::size_t block, std::size_t begin, std::size_t end) {
+        std::size_t chosen = NO_ROOM;
+        for (std::size_t i = begin; i < end; ++i) {
+            // Capacity and layout are cheap; the schedule is only checked for a better fit
+            if ((chosen == NO_ROOM || rooms[i].facility->getMaxCapacity() < rooms[chosen].facility->getMaxCapacity()) &&
+                fits(rooms[i], startTime, endTime, guests, layout)) {
+                chosen = i;
+            }
+        }
+        best[block] = chosen;
+    });
+
+    std::size_t chosen = NO_ROOM;
+    for (std::size_t candidate : best) {
+        if (candidate != NO_ROOM &&
+            (chosen == NO_ROOM || rooms[candidate].facility->getMaxCapacity() < rooms[chosen].facility->getMaxCapacity())) {
+            chosen = candidate;
+        }
+    }
+    return chosen;
+}
+
+std::vector<std::uint64_t> FacilityPool::daysWithFreeRoom(const std::chrono::system_clock::time_point& firstDay,
+                                                          std::size_t dayCount, int startMinute, int endMinute) const {
+    std::size_t words = (dayCount + 63) / 64;
+    std::size_t blocks = rooms.size() >= parallelThreshold ? std::min<std::size_t>(threadCount, rooms.size()) : 1;
+    std::vector<std::vector<std::uint64_t>> found(blocks, std::vector<std::uint64_t>(words, 0));
+    forEachBlock(rooms.size(), blocks, [&](std::size_t block, std::size_t begin, std::size_t end) {
+        std::vector<std::uint64_t>& days = found[block];
+        for (std::size_t i = begin; i < end; ++i) {
+            rooms[i].facility->markFreeDays(firstDay, dayCount, startMinute, endMinute, days);
+            // Stop once every day has a free room
+            bool allFree = true;
+            for (std::size_t w = 0; w < words && allFree; ++w) {
+                std::uint64_t wanted = dayCount - w * 64 >= 64 ? ~std::uint64_t(0)
+                                                              : (std::uint64_t(1) << (dayCount - w * 64)) - 1;
+                allFree = (days[w] & wanted) == wanted;
+            }
+            if (allFree) {
+                break;
+            }
+        }
+    });
+
+    std::vector<std::uint64_t> days(words, 0);
+    for (const auto& block : found) {
+        for (std::size_t w = 0; w < words; ++w) {
+            days[w] |= block[w];
+        }
+    }
+    return days;
+}
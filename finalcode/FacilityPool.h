@@ -0,0 +1,76 @@
+#ifndef FACILITY_POOL_H
+#define FACILITY_POOL_H
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <chrono>
+#include <initializer_list>
+#include <cstddef>
+#include <cstdint>
+#include "Facility.h"
+#include "LayoutStyle.h"
+
+// The community center's rooms. Each room is a Facility with its own
+// schedule, opening hours, capacity and layouts, plus a name. Rooms are
+// addressed by index, in the order they were added.
+//
+// "Which rooms are free?" checks every room; with at least parallelThreshold
+// rooms the rooms are cut into contiguous blocks checked on their own
+// threads. Queries only read the rooms: they may run alongside each other but
+// not alongside bookings.
+class FacilityPool {
+public:
+    static const std::size_t NO_ROOM = static_cast<std::size_t>(-1);
+
+private:
+    struct Room {
+        std::string name;
+        std::unique_ptr<Facility> facility;
+    };
+
+    std::vector<Room> rooms;
+    unsigned threadCount;
+    std::size_t parallelThreshold;
+
+    bool fits(const Room& room, const std::chrono::system_clock::time_point& startTime,
+              const std::chrono::system_clock::time_point& endTime, int guests, LayoutStyle layout) const;
+
+public:
+    // threadCount 0 uses one thread per hardware thread
+    explicit FacilityPool(unsigned threadCount = 0, std::size_t parallelThreshold = 1024);
+
+    FacilityPool(const FacilityPool&) = delete;
+    FacilityPool& operator=(const FacilityPool&) = delete;
+
+    // Returns the new room's index
+    std::size_t addRoom(const std::string& name, int openingHour, int closingHour, int maxCapacity,
+                        std::initializer_list<LayoutStyle> layouts = { LayoutStyle::Meeting, LayoutStyle::Lecture,
+                                                                       LayoutStyle::Wedding, LayoutStyle::Dance });
+
+    std::size_t size() const { return rooms.size(); }
+    Facility& room(std::size_t index) { return *rooms[index].facility; }
+    const Facility& room(std::size_t index) const { return *rooms[index].facility; }
+    const std::string& roomName(std::size_t index) const { return rooms[index].name; }
+    bool supportsLayout(std::size_t index, LayoutStyle layout) const { return rooms[index].facility->supportsLayout(layout); }
+
+    // Indexes of every room open and unbooked for [startTime, endTime), ascending
+    std::vector<std::size_t> freeRooms(const std::chrono::system_clock::time_point& startTime,
+                                       const std::chrono::system_clock::time_point& endTime) const;
+    // The free room that seats 'guests' in the layout with the fewest seats to
+    // spare (the lowest index on a tie), or NO_ROOM
+    std::size_t bestRoom(const std::chrono::system_clock::time_point& startTime,
+                         const std::chrono::system_clock::time_point& endTime,
+                         int guests, LayoutStyle layout) const;
+
+    // Bit i (of (dayCount + 63) / 64 words) is set if on day i from firstDay's
+    // day some room is open and free for [startMinute, endMinute), in minutes
+    // after midnight UTC. Each room classifies all the days from its bitmaps at
+    // once; the rooms' answers are OR-ed together.
+    std::vector<std::uint64_t> daysWithFreeRoom(const std::chrono::system_clock::time_point& firstDay,
+                                                std::size_t dayCount, int startMinute, int endMinute) const;
+
+    unsigned getThreadCount() const { return threadCount; }
+};
+
+#endif // FACILITY_POOL_H
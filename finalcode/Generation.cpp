@@ -0,0 +1,3 @@
+#include "Generation.h"
+
+std::atomic<std::uint64_t> Generation::counter(0);
@@ -0,0 +1,19 @@
+#ifndef GENERATION_H
+#define GENERATION_H
+
+#include <atomic>
+#include <cstdint>
+
+// Process-wide change counter. Mutators stamp the object they changed with
+// Generation::next() after the change is made; an incremental save remembers
+// current() from when it started and later writes only objects stamped after it.
+class Generation {
+private:
+    static std::atomic<std::uint64_t> counter;
+
+public:
+    static std::uint64_t next() { return counter.fetch_add(1) + 1; }
+    static std::uint64_t current() { return counter.load(); }
+};
+
+#endif // GENERATION_H
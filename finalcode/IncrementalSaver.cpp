@@ -0,0 +1,86 @@
+#include "IncrementalSaver.h"
+#include "User.h"
+#include "Event.h"
+#include "Facility.h"
+#include "FacilityManager.h"
+#include "Generation.h"
+#include <iostream>
+#include <fstream>
+
+IncrementalSaver::IncrementalSaver(const std::string& directory)
+    : directory(directory), savedThrough(0), savedUsers(0), savedEvents(0), failedWrites(0) {}
+
+std::string IncrementalSaver::fileNameFor(const std::string& name) {
+    static const char hex[] = "0123456789ABCDEF";
+    std::string escaped;
+    escaped.reserve(name.size());
+    for (char c : name) {
+        unsigned char byte = static_cast<unsigned char>(c);
+        if ((byte >= 'a' && byte <= 'z') || (byte >= 'A' && byte <= 'Z') ||
+            (byte >= '0' && byte <= '9') || byte == '_' || byte == '-') {
+            escaped += c;
+        } else {
+            escaped += '%';
+            escaped += hex[byte >> 4];
+            escaped += hex[byte & 0x0F];
+        }
+    }
+    return escaped;
+}
+
+std::size_t IncrementalSaver::saveChanged(const std::vector<std::unique_ptr<User>>& users,
+                                          const std::vector<std::unique_ptr<Event>>& events,
+                                          const Facility& facility,
+                                          const FacilityManager& manager) {
+    std::uint64_t startedAt = Generation::current();
+    std::size_t written = 0;
+    failedWrites = 0;
+
+    // Users and events are only ever appended, so the lists change with their size
+    if (users.size() != savedUsers || savedThrough == 0) {
+        std::ofstream list(directory + "/users");
+        if (!list.is_open()) {
+            std::cout << "Unable to open file: " << directory << "/users" << std::endl;
+            failedWrites = 1;
+            return 0;
+        }
+        for (const auto& user : users) {
+            list << user->getUsername() << " " << static_cast<int>(user->getType()) << std::endl;
+        }
+        savedUsers = users.size();
+        ++written;
+    }
+    if (events.size() != savedEvents || savedThrough == 0) {
+        std::ofstream list(directory + "/events");
+        if (!list.is_open()) {
+            std::cout << "Unable to open file: " << directory << "/events" << std::endl;
+            failedWrites = 1;
+            return written;
+        }
+        for (const auto& event : events) {
+            list << event->getName() << std::endl;
+        }
+        savedEvents = events.size();
+        ++written;
+    }
+
+    for (const auto& user : users) {
+        written += user->saveChanged(directory + "/user_" + fileNameFor(user->getUsername()),
+                                     savedThrough, failedWrites);
+    }
+    for (const auto& event : events) {
+        if (event->saveChanged(directory + "/event_" + fileNameFor(event->getName()), savedThrough, failedWrites)) {
+            ++written;
+        }
+    }
+    written += facility.saveChanged(directory + "/facility", savedThrough, failedWrites);
+    written += manager.saveChanged(directory + "/manager", savedThrough, failedWrites);
+
+    if (failedWrites > 0) {
+        std::cout << failedWrites << " file(s) could not be saved to " << directory
+                  << "; they will be retried on the next save." << std::endl;
+        return written;
+    }
+    savedThrough = startedAt;
+    return written;
+}
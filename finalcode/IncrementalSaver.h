@@ -0,0 +1,55 @@
+#ifndef INCREMENTAL_SAVER_H
+#define INCREMENTAL_SAVER_H
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <cstdint>
+#include <cstddef>
+
+class User;
+class Event;
+class Facility;
+class FacilityManager;
+
+// Keeps a directory of the per-object text files current by writing only what
+// changed since the previous pass; the first pass writes everything.
+//
+//   users, events        name lists, rewritten when someone is added
+//   user_<name>          User::saveChanged (index plus a file per record)
+//   event_<name>         Event::saveChanged
+//   facility, manager    index plus a file per reservation
+//
+// Names are escaped by fileNameFor, so a name holding '/', spaces or ".."
+// still maps to one file inside the directory.
+//
+// A pass remembers the generation it started at. Changes made while it runs
+// are stamped later and land in the next pass, so run it between commands
+// rather than under concurrent sales. A pass with failed writes is reported
+// and does not advance, so the next pass retries everything it covered.
+class IncrementalSaver {
+private:
+    std::string directory;
+    std::uint64_t savedThrough; // Generation the last pass started at; 0 before the first
+    std::size_t savedUsers;
+    std::size_t savedEvents;
+    std::size_t failedWrites; // Files the last pass could not write
+
+public:
+    explicit IncrementalSaver(const std::string& directory);
+
+    // Returns the number of files written
+    std::size_t saveChanged(const std::vector<std::unique_ptr<User>>& users,
+                            const std::vector<std::unique_ptr<Event>>& events,
+                            const Facility& facility,
+                            const FacilityManager& manager);
+
+    std::uint64_t getSavedThrough() const { return savedThrough; }
+    std::size_t getFailedWrites() const { return failedWrites; }
+
+    // Keeps letters, digits, '_' and '-'; every other byte becomes %XX, so
+    // distinct names never share a file and none can leave the directory
+    static std::string fileNameFor(const std::string& name);
+};
+
+#endif // INCREMENTAL_SAVER_H
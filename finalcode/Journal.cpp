@@ -0,0 +1,788 @@
+#include "Journal.h"
+#include "BinaryIO.h"
+#include "Snapshot.h"
+#include "User.h"
+#include "Event.h"
+#include "Ticket.h"
+#include "Reservation.h"
+#include "Facility.h"
+#include "FacilityManager.h"
+#include "UserDirectory.h"
+#include <iostream>
+#include <fstream>
+#include <algorithm>
+#include <cstring>
+#include <cstdio>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace {
+    const char MAGIC[8] = { 'C', 'C', 'J', 'R', 'N', 'L', '\0', '\0' };
+    const std::size_t HEADER_SIZE = sizeof(MAGIC) + sizeof(std::uint32_t) + sizeof(std::uint64_t);
+    const std::size_t FRAME_SIZE = 2 * sizeof(std::uint32_t);
+
+    std::int64_t ticks(const std::chrono::system_clock::time_point& time) {
+        return static_cast<std::int64_t>(time.time_since_epoch().count());
+    }
+
+    std::chrono::system_clock::time_point fromTicks(std::int64_t value) {
+        return std::chrono::system_clock::time_point(std::chrono::system_clock::duration(value));
+    }
+
+    std::uint32_t recordChecksum(const char* data, std::size_t size) {
+        std::uint64_t hash = Snapshot::checksum(data, size);
+        return static_cast<std::uint32_t>(hash ^ (hash >> 32));
+    }
+
+    // The snapshot footer is its checksum; 0 when the file is missing
+    std::uint64_t snapshotChecksum(const std::string& filename) {
+        std::ifstream file(filename, std::ios::binary | std::ios::ate);
+        std::uint64_t value = 0;
+        if (!file.is_open() || file.tellg() < static_cast<std::streamoff>(sizeof(value))) {
+            return 0;
+        }
+        file.seekg(-static_cast<std::streamoff>(sizeof(value)), std::ios::end);
+        file.read(reinterpret_cast<char*>(&value), sizeof(value));
+        return file ? value : 0;
+    }
+
+    bool writeAll(int fd, const char* data, std::size_t size) {
+        while (size > 0) {
+            ssize_t written = ::write(fd, data, size);
+            if (written < 0) {
+                return false;
+            }
+            data += written;
+            size -= static_cast<std::size_t>(written);
+        }
+        return true;
+    }
+
+    bool syncPath(const std::string& path, int flags) {
+        int fd = ::open(path.c_str(), flags);
+        if (fd < 0) {
+            return false;
+        }
+        bool ok = ::fsync(fd) == 0;
+        ::close(fd);
+        return ok;
+    }
+
+    std::string directoryOf(const std::string& path) {
+        std::size_t slash = path.find_last_of('/');
+        return slash == std::string::npos ? "." : path.substr(0, slash + 1);
+    }
+}
+
+// A record whose name fields hold SymbolIds until append() swaps in the
+// numbers this journal file gave them
+struct Journal::Record {
+    static const int MAX_SYMBOLS = 3;
+
+    BinaryWriter out;
+    SymbolId symbols[MAX_SYMBOLS];
+    std::size_t offsets[MAX_SYMBOLS];
+    int symbolCount;
+
+    explicit Record(RecordType type) : symbolCount(0) {
+        out.put<std::uint8_t>(type);
+    }
+
+    void putSymbol(SymbolId symbol) {
+        symbols[symbolCount] = symbol;
+        offsets[symbolCount++] = out.buffer.size();
+        out.put<std::uint32_t>(SymbolTable::NONE);
+    }
+
+    void putUsername(const Reservation& reservation) {
+        putSymbol(reservation.getUser() ? reservation.getUser()->getUsernameId() : SymbolTable::NONE);
+    }
+
+    void putReservation(const Reservation& reservation) {
+        out.put<std::uint64_t>(reservation.getId());
+        putUsername(reservation);
+        out.put<std::int64_t>(ticks(reservation.getStartTime()));
+        out.put<std::int64_t>(ticks(reservation.getEndTime()));
+        out.put<std::uint8_t>(static_cast<std::uint8_t>(reservation.getLayoutStyle()));
+        out.put<std::uint8_t>((reservation.getIsPublic() ? 1 : 0) | (reservation.getIsPaid() ? 2 : 0));
+        out.put<double>(reservation.getTotalCost());
+    }
+};
+
+std::atomic<Journal*> Journal::current(nullptr);
+
+// Lookups built once per recovery; a name in a record is its number in the
+// file, which maps to a SymbolId and from there to the user or event by index
+struct Journal::ReplayState {
+    std::vector<std::unique_ptr<Event>>& events;
+    Facility& facility;
+    FacilityManager& manager;
+    UserDirectory users;
+    std::vector<Event*> eventsBySymbol;
+    std::vector<SymbolId> symbols; // Indexed by the number the file gave the name
+
+    ReplayState(std::vector<std::unique_ptr<User>>& userList,
+                std::vector<std::unique_ptr<Event>>& events,
+                Facility& facility,
+                FacilityManager& manager)
+        : events(events), facility(facility), manager(manager), users(userList) {
+        for (const auto& event : events) {
+            addEvent(event.get());
+        }
+    }
+
+    // Event names are unique, which records rely on to find their event; the
+    // first event with a name keeps it
+    void addEvent(Event* event) {
+        SymbolId id = event->getNameId();
+        if (id >= eventsBySymbol.size()) {
+            eventsBySymbol.resize(id + 1, nullptr);
+        }
+        if (eventsBySymbol[id] == nullptr) {
+            eventsBySymbol[id] = event;
+        }
+    }
+
+    SymbolId readSymbol(BinaryReader& in) const {
+        std::uint32_t number = in.get<std::uint32_t>();
+        return number < symbols.size() ? symbols[number] : SymbolTable::NONE;
+    }
+
+    User* readUser(BinaryReader& in) const {
+        return users.find(readSymbol(in));
+    }
+
+    Event* readEvent(BinaryReader& in) const {
+        SymbolId id = readSymbol(in);
+        return id < eventsBySymbol.size() ? eventsBySymbol[id] : nullptr;
+    }
+
+    // Builds the reservation in the store, or shares the copy its user already holds
+    ReservationHandle readReservation(BinaryReader& in) const {
+        RecordId id = in.get<std::uint64_t>();
+        User* user = readUser(in);
+        std::int64_t start = in.get<std::int64_t>();
+        std::int64_t end = in.get<std::int64_t>();
+        std::uint8_t layout = in.get<std::uint8_t>();
+        std::uint8_t flags = in.get<std::uint8_t>();
+        double totalCost = in.get<double>();
+        if (!in.ok() || user == nullptr) {
+            return ReservationHandle();
+        }
+        ReservationHandle held = ReservationStore::heldCopy(user, id);
+        if (!held.isNull()) {
+            return held;
+        }
+        return ReservationStore::shared().emplace(user, fromTicks(start), fromTicks(end),
+                                                  static_cast<LayoutStyle>(layout), (flags & 1) != 0,
+                                                  id, (flags & 2) != 0, totalCost);
+    }
+};
+
+Journal::Journal(const std::string& filename, const std::string& snapshotFile, std::size_t groupSize)
+    : filename(filename), snapshotFile(snapshotFile), groupSize(std::max<std::size_t>(1, groupSize)),
+      fd(-1), fileBytes(0), pendingRecords(0), definedSymbols(0) {}
+
+Journal::~Journal() {
+    if (active() == this) {
+        setActive(nullptr);
+    }
+    sync();
+    closeFile();
+}
+
+bool Journal::startFile(const std::string& path, std::uint64_t baseChecksum) const {
+    int out = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (out < 0) {
+        std::cout << "Unable to open file: " << path << std::endl;
+        return false;
+    }
+    BinaryWriter header;
+    header.buffer.append(MAGIC, sizeof(MAGIC));
+    header.put<std::uint32_t>(VERSION);
+    header.put<std::uint64_t>(baseChecksum);
+    bool ok = writeAll(out, header.buffer.data(), header.buffer.size()) && ::fdatasync(out) == 0;
+    ::close(out);
+    return ok;
+}
+
+bool Journal::openForAppend() {
+    fd = ::open(filename.c_str(), O_WRONLY | O_APPEND | O_CREAT, 0644);
+    if (fd < 0) {
+        std::cout << "Unable to open file: " << filename << std::endl;
+        return false;
+    }
+    off_t end = ::lseek(fd, 0, SEEK_END);
+    fileBytes = end > 0 ? static_cast<std::uint64_t>(end) : 0;
+    return true;
+}
+
+void Journal::closeFile() {
+    if (fd >= 0) {
+        ::close(fd);
+        fd = -1;
+    }
+}
+
+std::size_t Journal::recover(std::vector<std::unique_ptr<User>>& users,
+                             std::vector<std::unique_ptr<Event>>& events,
+                             Facility& facility,
+                             FacilityManager& manager,
+                             std::uint64_t baseChecksum) {
+    // Replay must not log the changes it re-applies
+    Journal* previous = current.exchange(nullptr);
+    closeFile();
+
+    std::vector<char> data;
+    std::ifstream file(filename, std::ios::binary | std::ios::ate);
+    if (file.is_open()) {
+        std::streamsize size = file.tellg();
+        file.seekg(0, std::ios::beg);
+        data.resize(static_cast<std::size_t>(size > 0 ? size : 0));
+        if (!data.empty() && !file.read(data.data(), size)) {
+            data.clear();
+        }
+        file.close();
+    }
+
+    // The base is the snapshot that actually loaded, not whatever is on disk
+    bool extendsSnapshot = false;
+    if (data.size() >= HEADER_SIZE && std::memcmp(data.data(), MAGIC, sizeof(MAGIC)) == 0) {
+        BinaryReader header(data.data() + sizeof(MAGIC), HEADER_SIZE - sizeof(MAGIC));
+        std::uint32_t version = header.get<std::uint32_t>();
+        std::uint64_t storedBase = header.get<std::uint64_t>();
+        extendsSnapshot = version == VERSION && storedBase == baseChecksum;
+    }
+
+    std::size_t applied = 0;
+    std::size_t validEnd = HEADER_SIZE;
+    std::vector<SymbolId> defined; // Names the kept part of the file already numbers
+    if (extendsSnapshot) {
+        ReplayState state(users, events, facility, manager);
+        BinaryReader in(data.data() + HEADER_SIZE, data.size() - HEADER_SIZE);
+        while (in.remaining() >= FRAME_SIZE) {
+            std::uint32_t length = in.get<std::uint32_t>();
+            std::uint32_t check = in.get<std::uint32_t>();
+            if (in.remaining() < length) {
+                break;
+            }
+            const char* payload = in.position();
+            in.sub(length);
+            if (recordChecksum(payload, length) != check) {
+                break;
+            }
+            if (applyRecord(payload, length, state)) {
+                ++applied;
+            }
+            validEnd = static_cast<std::size_t>(in.position() - data.data());
+        }
+        defined.swap(state.symbols);
+
+        // A crash mid-write leaves a partial record; cut it so appends follow good data
+        if (validEnd < data.size()) {
+            std::cout << "Discarding " << data.size() - validEnd << " bytes of incomplete journal" << std::endl;
+            if (::truncate(filename.c_str(), static_cast<off_t>(validEnd)) != 0) {
+                std::cout << "Unable to truncate journal: " << filename << std::endl;
+            }
+        }
+    } else {
+        // Missing, foreign, or written against an older snapshot that already holds its changes
+        if (!data.empty()) {
+            std::cout << "Journal does not extend the current snapshot; starting a new one" << std::endl;
+        }
+        startFile(filename, baseChecksum);
+    }
+
+    resetSymbols(defined);
+    openForAppend();
+    current.store(previous);
+    if (applied > 0) {
+        std::cout << "Replayed " << applied << " journal records from file: " << filename << std::endl;
+    }
+    return applied;
+}
+
+bool Journal::applyRecord(const char* data, std::size_t size, ReplayState& state) {
+    BinaryReader in(data, size);
+    std::uint8_t type = in.get<std::uint8_t>();
+
+    switch (type) {
+        case RESERVATION_STORED: {
+            ReservationHandle handle = state.readReservation(in);
+            if (handle.isNull()) {
+                return false;
+            }
+            User* user = ReservationStore::shared().get(handle)->getUser();
+            return !user->storeReservation(handle).isNull();
+        }
+        case RESERVATION_ERASED: {
+            User* user = state.readUser(in);
+            RecordId id = in.get<std::uint64_t>();
+            if (!in.ok() || user == nullptr) {
+                return false;
+            }
+            Reservation* reservation = user->reservations.get(id);
+            if (reservation == nullptr) {
+                return false;
+            }
+            user->eraseReservation(*reservation);
+            return true;
+        }
+        case RESERVATION_PAID: {
+            User* user = state.readUser(in);
+            RecordId id = in.get<std::uint64_t>();
+            if (!in.ok()) {
+                return false;
+            }
+            // Usually one reservation in both lists; state loaded from text files has two
+            Reservation* held = user != nullptr ? user->reservations.get(id) : nullptr;
+            Reservation* pending = state.manager.pendingReservations.get(id);
+            if (held != nullptr) {
+                held->makePayment(held->getTotalCost());
+            }
+            if (pending != nullptr && pending != held) {
+                pending->makePayment(pending->getTotalCost());
+            }
+            return held != nullptr || pending != nullptr;
+        }
+        case RESERVATION_SUBMITTED: {
+            ReservationHandle handle = state.readReservation(in);
+            if (handle.isNull()) {
+                return false;
+            }
+            ReservationStore& store = ReservationStore::shared();
+            bool added = state.manager.pendingReservations.add(handle);
+            if (added) {
+                store.setState(handle, ReservationState::Pending);
+            }
+            store.discardIfUnheld(handle);
+            state.manager.touch();
+            return added;
+        }
+        case RESERVATION_APPROVED:
+        case RESERVATION_REJECTED: {
+            RecordId id = in.get<std::uint64_t>();
+            auto& pending = state.manager.pendingReservations;
+            ReservationHandle handle = pending.find(id);
+            if (!in.ok() || handle.isNull()) {
+                return false;
+            }
+            if (type == RESERVATION_APPROVED) {
+                state.facility.insertReservation(handle);
+            } else {
+                ReservationStore::shared().setState(handle, ReservationState::Rejected);
+            }
+            pending.remove(id);
+            state.manager.touch();
+            return true;
+        }
+        case RESERVATION_UNSCHEDULED: {
+            RecordId id = in.get<std::uint64_t>();
+            Reservation* reservation = state.facility.schedule.get(id);
+            if (!in.ok() || reservation == nullptr) {
+                return false;
+            }
+            state.facility.unindexReservation(reservation);
+            state.facility.schedule.remove(id);
+            return true;
+        }
+        case TICKET_ISSUED: {
+            Event* event = state.readEvent(in);
+            User* user = state.readUser(in);
+            RecordId id = in.get<std::uint64_t>();
+            double price = in.get<double>();
+            if (!in.ok() || event == nullptr || user == nullptr) {
+                return false;
+            }
+            Ticket* ticket = event->ticketPool.create(event, user, price, id, true);
+            if (!event->tickets.add(ticket)) {
+                event->ticketPool.destroy(ticket);
+                return false;
+            }
+            event->currentCapacity.fetch_add(1);
+            user->attachTicket(ticket);
+            // Promotions issue tickets to waitlisted users; they leave the line
+            auto waiting = std::find(event->waitlist.begin(), event->waitlist.end(), user);
+            if (waiting != event->waitlist.end()) {
+                event->waitlist.erase(waiting);
+            }
+            event->touch();
+            return true;
+        }
+        case TICKET_CANCELLED: {
+            Event* event = state.readEvent(in);
+            User* user = state.readUser(in);
+            RecordId id = in.get<std::uint64_t>();
+            if (!in.ok() || event == nullptr) {
+                return false;
+            }
+            Ticket* ticket = event->tickets.find(id);
+            if (ticket == nullptr || ticket->getUser() != user) {
+                return false;
+            }
+            event->unregisterTicket(ticket);
+            event->currentCapacity.fetch_sub(1);
+            return true;
+        }
+        case TICKET_CHECKED_IN: {
+            Event* event = state.readEvent(in);
+            RecordId id = in.get<std::uint64_t>();
+            if (!in.ok() || event == nullptr) {
+                return false;
+            }
+            Ticket* ticket = event->tickets.find(id);
+            if (ticket == nullptr) {
+                return false;
+            }
+            ticket->markCheckedIn();
+            event->touch();
+            return true;
+        }
+        case WAITLIST_JOINED: {
+            Event* event = state.readEvent(in);
+            User* user = state.readUser(in);
+            if (!in.ok() || event == nullptr || user == nullptr) {
+                return false;
+            }
+            event->waitlist.push_back(user);
+            event->touch();
+            return true;
+        }
+        case EVENT_CREATED: {
+            SymbolId name = state.readSymbol(in);
+            StringRef description = in.getString();
+            User* organizer = state.readUser(in);
+            double ticketPrice = in.get<double>();
+            std::int32_t maxCapacity = in.get<std::int32_t>();
+            std::uint8_t flags = in.get<std::uint8_t>();
+            std::int64_t start = in.get<std::int64_t>();
+            std::int64_t end = in.get<std::int64_t>();
+            if (!in.ok() || name == SymbolTable::NONE || organizer == nullptr) {
+                return false;
+            }
+            if (name < state.eventsBySymbol.size() && state.eventsBySymbol[name] != nullptr) {
+                return true; // Names are unique; a second event by the same name is not recreated
+            }
+            std::unique_ptr<Event> event(new Event(SymbolTable::shared().name(name), description.str(), organizer, ticketPrice,
+                                                   maxCapacity, (flags & 1) != 0, (flags & 2) != 0,
+                                                   (flags & 4) != 0, fromTicks(start), fromTicks(end)));
+            state.addEvent(event.get());
+            state.events.push_back(std::move(event));
+            return true;
+        }
+        case EVENT_CANCELLED: {
+            Event* event = state.readEvent(in);
+            if (!in.ok() || event == nullptr) {
+                return false;
+            }
+            // Refunds were logged as budget records of their own
+            for (Ticket* ticket : event->tickets) {
+                ticket->getUser()->releaseTicket(ticket);
+                event->ticketPool.destroy(ticket);
+            }
+            event->tickets.clear();
+            event->currentCapacity = 0;
+            event->waitlist.clear();
+            event->touch();
+            return true;
+        }
+        case CAPACITY_RAISED: {
+            Event* event = state.readEvent(in);
+            std::int32_t newMaxCapacity = in.get<std::int32_t>();
+            if (!in.ok() || event == nullptr) {
+                return false;
+            }
+            event->maxCapacity = std::max(event->maxCapacity.load(), static_cast<int>(newMaxCapacity));
+            event->touch();
+            return true;
+        }
+        case USER_BUDGET: {
+            User* user = state.readUser(in);
+            double delta = in.get<double>();
+            if (!in.ok() || user == nullptr) {
+                return false;
+            }
+            user->addToBudget(delta);
+            return true;
+        }
+        case MANAGER_BUDGET: {
+            double delta = in.get<double>();
+            if (!in.ok()) {
+                return false;
+            }
+            state.manager.budget += delta;
+            state.manager.touch();
+            return true;
+        }
+        case SYMBOL_DEFINED: {
+            std::uint32_t number = in.get<std::uint32_t>();
+            StringRef name = in.getString();
+            if (!in.ok()) {
+                return false;
+            }
+            if (number >= state.symbols.size()) {
+                state.symbols.resize(number + 1, SymbolTable::NONE);
+            }
+            state.symbols[number] = SymbolTable::shared().intern(name);
+            return true;
+        }
+        default:
+            return false;
+    }
+}
+
+void Journal::append(Record& record) {
+    if (fd < 0) {
+        return;
+    }
+
+    std::unique_lock<std::mutex> lock(bufferMutex);
+    for (int i = 0; i < record.symbolCount; ++i) {
+        std::uint32_t number = fileSymbol(record.symbols[i]);
+        std::memcpy(&record.out.buffer[record.offsets[i]], &number, sizeof(number));
+    }
+    frame(record.out.buffer);
+    if (pendingRecords < groupSize) {
+        return;
+    }
+
+    // If another thread is mid-fsync, leave the group to grow; that writer or
+    // the next full group picks these records up.
+    std::unique_lock<std::mutex> io(ioMutex, std::try_to_lock);
+    if (io.owns_lock()) {
+        writeGroup(lock);
+    }
+}
+
+void Journal::frame(const std::string& payload) {
+    std::uint32_t length = static_cast<std::uint32_t>(payload.size());
+    std::uint32_t check = recordChecksum(payload.data(), payload.size());
+    pending.append(reinterpret_cast<const char*>(&length), sizeof(length));
+    pending.append(reinterpret_cast<const char*>(&check), sizeof(check));
+    pending.append(payload);
+    ++pendingRecords;
+}
+
+std::uint32_t Journal::fileSymbol(SymbolId symbol) {
+    if (symbol == SymbolTable::NONE) {
+        return SymbolTable::NONE;
+    }
+    if (symbol >= fileSymbols.size()) {
+        fileSymbols.resize(symbol + 1, 0);
+    }
+    if (fileSymbols[symbol] == 0) {
+        // Defined in the same group as, and ahead of, the record that needs it
+        BinaryWriter define;
+        define.put<std::uint8_t>(SYMBOL_DEFINED);
+        define.put<std::uint32_t>(definedSymbols);
+        define.putString(SymbolTable::shared().name(symbol));
+        frame(define.buffer);
+        fileSymbols[symbol] = ++definedSymbols;
+    }
+    return fileSymbols[symbol] - 1;
+}
+
+void Journal::resetSymbols(const std::vector<SymbolId>& defined) {
+    std::lock_guard<std::mutex> lock(bufferMutex);
+    fileSymbols.clear();
+    definedSymbols = static_cast<std::uint32_t>(defined.size());
+    for (std::uint32_t number = 0; number < defined.size(); ++number) {
+        SymbolId symbol = defined[number];
+        if (symbol == SymbolTable::NONE) {
+            continue;
+        }
+        if (symbol >= fileSymbols.size()) {
+            fileSymbols.resize(symbol + 1, 0);
+        }
+        fileSymbols[symbol] = number + 1;
+    }
+}
+
+bool Journal::writeGroup(std::unique_lock<std::mutex>& bufferLock) {
+    std::string group;
+    group.swap(pending);
+    pendingRecords = 0;
+    bufferLock.unlock(); // Appends continue into a fresh buffer during the fsync
+
+    if (group.empty()) {
+        return true;
+    }
+    if (fd < 0 || !writeAll(fd, group.data(), group.size()) || ::fdatasync(fd) != 0) {
+        std::cout << "Failed to write journal: " << filename << std::endl;
+        return false;
+    }
+    fileBytes += group.size();
+    return true;
+}
+
+bool Journal::sync() {
+    std::unique_lock<std::mutex> lock(bufferMutex);
+    std::unique_lock<std::mutex> io(ioMutex);
+    return writeGroup(lock);
+}
+
+std::uint64_t Journal::size() {
+    std::lock_guard<std::mutex> lock(bufferMutex);
+    return fileBytes.load() + pending.size();
+}
+
+bool Journal::compact(const std::vector<std::unique_ptr<User>>& users,
+                      const std::vector<std::unique_ptr<Event>>& events,
+                      const Facility& facility,
+                      const FacilityManager& manager) {
+    if (!sync()) {
+        return false;
+    }
+
+    std::string snapshotTemp = snapshotFile + ".tmp";
+    std::string journalTemp = filename + ".tmp";
+    if (!Snapshot::save(snapshotTemp, users, events, facility, manager) ||
+        !syncPath(snapshotTemp, O_RDONLY) ||
+        !startFile(journalTemp, snapshotChecksum(snapshotTemp))) {
+        std::remove(snapshotTemp.c_str());
+        return false;
+    }
+
+    // The snapshot goes live first. Should we stop before the journal swap,
+    // the old journal no longer matches the snapshot and is skipped on the
+    // next start, which is right: its changes are already in the snapshot.
+    if (std::rename(snapshotTemp.c_str(), snapshotFile.c_str()) != 0 ||
+        std::rename(journalTemp.c_str(), filename.c_str()) != 0) {
+        std::cout << "Unable to replace journal: " << filename << std::endl;
+        return false;
+    }
+    syncPath(directoryOf(filename), O_RDONLY | O_DIRECTORY);
+
+    closeFile();
+    resetSymbols(std::vector<SymbolId>());
+    openForAppend();
+    std::cout << "Journal compacted into snapshot: " << snapshotFile << std::endl;
+    return true;
+}
+
+bool Journal::compactIfNeeded(std::uint64_t thresholdBytes,
+                              const std::vector<std::unique_ptr<User>>& users,
+                              const std::vector<std::unique_ptr<Event>>& events,
+                              const Facility& facility,
+                              const FacilityManager& manager) {
+    if (!isOpen() || size() < thresholdBytes) {
+        return false;
+    }
+    return compact(users, events, facility, manager);
+}
+
+void Journal::reservationStored(const Reservation& reservation) {
+    Record record(RESERVATION_STORED);
+    record.putReservation(reservation);
+    append(record);
+}
+
+void Journal::reservationErased(const Reservation& reservation) {
+    Record record(RESERVATION_ERASED);
+    record.putUsername(reservation);
+    record.out.put<std::uint64_t>(reservation.getId());
+    append(record);
+}
+
+void Journal::reservationPaid(const Reservation& reservation) {
+    Record record(RESERVATION_PAID);
+    record.putUsername(reservation);
+    record.out.put<std::uint64_t>(reservation.getId());
+    append(record);
+}
+
+void Journal::reservationSubmitted(const Reservation& reservation) {
+    Record record(RESERVATION_SUBMITTED);
+    record.putReservation(reservation);
+    append(record);
+}
+
+void Journal::reservationApproved(RecordId reservationId) {
+    Record record(RESERVATION_APPROVED);
+    record.out.put<std::uint64_t>(reservationId);
+    append(record);
+}
+
+void Journal::reservationRejected(RecordId reservationId) {
+    Record record(RESERVATION_REJECTED);
+    record.out.put<std::uint64_t>(reservationId);
+    append(record);
+}
+
+void Journal::reservationUnscheduled(RecordId reservationId) {
+    Record record(RESERVATION_UNSCHEDULED);
+    record.out.put<std::uint64_t>(reservationId);
+    append(record);
+}
+
+void Journal::ticketIssued(const Ticket& ticket) {
+    Record record(TICKET_ISSUED);
+    record.putSymbol(ticket.getEvent()->getNameId());
+    record.putSymbol(ticket.getUser()->getUsernameId());
+    record.out.put<std::uint64_t>(ticket.getId());
+    record.out.put<double>(ticket.getPrice());
+    append(record);
+}
+
+void Journal::ticketCancelled(const Ticket& ticket) {
+    Record record(TICKET_CANCELLED);
+    record.putSymbol(ticket.getEvent()->getNameId());
+    record.putSymbol(ticket.getUser()->getUsernameId());
+    record.out.put<std::uint64_t>(ticket.getId());
+    append(record);
+}
+
+void Journal::ticketCheckedIn(const Ticket& ticket) {
+    Record record(TICKET_CHECKED_IN);
+    record.putSymbol(ticket.getEvent()->getNameId());
+    record.out.put<std::uint64_t>(ticket.getId());
+    append(record);
+}
+
+void Journal::waitlistJoined(const Event& event, const User& user) {
+    Record record(WAITLIST_JOINED);
+    record.putSymbol(event.getNameId());
+    record.putSymbol(user.getUsernameId());
+    append(record);
+}
+
+void Journal::eventCreated(const Event& event) {
+    Record record(EVENT_CREATED);
+    record.putSymbol(event.getNameId());
+    record.out.putString(event.getDescription());
+    record.putSymbol(event.getOrganizer()->getUsernameId());
+    record.out.put<double>(event.getTicketPrice());
+    record.out.put<std::int32_t>(event.getMaxCapacity());
+    record.out.put<std::uint8_t>((event.getIsPublic() ? 1 : 0) |
+                                 (event.getAllowsResidents() ? 2 : 0) |
+                                 (event.getAllowsNonResidents() ? 4 : 0));
+    record.out.put<std::int64_t>(ticks(event.getStartTime()));
+    record.out.put<std::int64_t>(ticks(event.getEndTime()));
+    append(record);
+}
+
+void Journal::eventCancelled(const Event& event) {
+    Record record(EVENT_CANCELLED);
+    record.putSymbol(event.getNameId());
+    append(record);
+}
+
+void Journal::capacityRaised(const Event& event, int newMaxCapacity) {
+    Record record(CAPACITY_RAISED);
+    record.putSymbol(event.getNameId());
+    record.out.put<std::int32_t>(newMaxCapacity);
+    append(record);
+}
+
+void Journal::budgetChanged(const User& user, double delta) {
+    Record record(USER_BUDGET);
+    record.putSymbol(user.getUsernameId());
+    record.out.put<double>(delta);
+    append(record);
+}
+
+void Journal::managerBudgetChanged(double delta) {
+    Record record(MANAGER_BUDGET);
+    record.out.put<double>(delta);
+    append(record);
+}
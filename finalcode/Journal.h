@@ -0,0 +1,150 @@
+#ifndef JOURNAL_H
+#define JOURNAL_H
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+#include "RecordId.h"
+#include "SymbolTable.h"
+
+class User;
+class Event;
+class Ticket;
+class Reservation;
+class Facility;
+class FacilityManager;
+class BinaryWriter;
+
+// Append-only write-ahead journal of every state change since the last
+// snapshot.
+//
+// Layout:
+//   header  "CCJRNL\0\0", u32 version, u64 checksum of the snapshot it extends
+//   records u32 payload length, u32 payload checksum, payload (u8 type, fields)
+//
+// Usernames and event names are written once per file, in a SYMBOL_DEFINED
+// record ahead of the first record that mentions them; records then carry the
+// name's u32 number in this file.
+//
+// Records are buffered and written with one write + fdatasync per group
+// (groupSize records, or sync()), so a mutation costs a memcpy and an fsync
+// is shared by the whole batch. Budgets are logged as deltas so concurrent
+// updates replay to the same total in any order.
+//
+// The model classes log through Journal::active(); nothing is logged while
+// no journal is attached, which is how loading and replay stay silent.
+class Journal {
+public:
+    static const std::uint32_t VERSION = 3;
+
+    enum RecordType : std::uint8_t {
+        RESERVATION_STORED = 1,
+        RESERVATION_ERASED = 2,
+        RESERVATION_PAID = 3,
+        RESERVATION_SUBMITTED = 4,
+        RESERVATION_APPROVED = 5,
+        RESERVATION_REJECTED = 6,
+        RESERVATION_UNSCHEDULED = 7,
+        TICKET_ISSUED = 8,
+        TICKET_CANCELLED = 9,
+        WAITLIST_JOINED = 10,
+        EVENT_CREATED = 11,
+        EVENT_CANCELLED = 12,
+        CAPACITY_RAISED = 13,
+        USER_BUDGET = 14,
+        MANAGER_BUDGET = 15,
+        SYMBOL_DEFINED = 16,
+        TICKET_CHECKED_IN = 17
+    };
+
+private:
+    std::string filename;
+    std::string snapshotFile;
+    std::size_t groupSize;
+    int fd;
+    std::atomic<std::uint64_t> fileBytes; // Bytes already written to the file
+    std::string pending; // Framed records waiting for the next group commit
+    std::size_t pendingRecords;
+    std::vector<std::uint32_t> fileSymbols; // SymbolId -> number in this file + 1; 0 until defined here
+    std::uint32_t definedSymbols;
+    std::mutex bufferMutex; // Guards pending, pendingRecords and the file's symbols
+    std::mutex ioMutex; // Serializes writes so groups land in order
+
+    static std::atomic<Journal*> current;
+
+    struct ReplayState;
+    struct Record;
+
+    void append(Record& record);
+    void frame(const std::string& payload); // Caller holds bufferMutex
+    std::uint32_t fileSymbol(SymbolId symbol); // Caller holds bufferMutex
+    void resetSymbols(const std::vector<SymbolId>& defined);
+    bool writeGroup(std::unique_lock<std::mutex>& bufferLock); // Caller holds ioMutex
+    bool startFile(const std::string& path, std::uint64_t baseChecksum) const;
+    bool openForAppend();
+    void closeFile();
+    static bool applyRecord(const char* data, std::size_t size, ReplayState& state);
+
+public:
+    Journal(const std::string& filename, const std::string& snapshotFile, std::size_t groupSize = 64);
+    ~Journal();
+
+    Journal(const Journal&) = delete;
+    Journal& operator=(const Journal&) = delete;
+
+    // The journal the model classes currently log to, or nullptr
+    static Journal* active() { return current.load(); }
+    static void setActive(Journal* journal) { current.store(journal); }
+
+    // Replays the records onto the loaded state, drops a torn tail, and opens
+    // the file for appending. baseChecksum is the checksum of the snapshot the
+    // state was loaded from, or 0 when none was; a journal written against any
+    // other base is started afresh. Returns the number of records applied.
+    std::size_t recover(std::vector<std::unique_ptr<User>>& users,
+                        std::vector<std::unique_ptr<Event>>& events,
+                        Facility& facility,
+                        FacilityManager& manager,
+                        std::uint64_t baseChecksum);
+
+    // Writes out any buffered records and waits for them to reach the disk
+    bool sync();
+
+    // Folds the journal into a fresh snapshot and starts an empty journal.
+    // Nothing may mutate the state while this runs.
+    bool compact(const std::vector<std::unique_ptr<User>>& users,
+                 const std::vector<std::unique_ptr<Event>>& events,
+                 const Facility& facility,
+                 const FacilityManager& manager);
+    bool compactIfNeeded(std::uint64_t thresholdBytes,
+                         const std::vector<std::unique_ptr<User>>& users,
+                         const std::vector<std::unique_ptr<Event>>& events,
+                         const Facility& facility,
+                         const FacilityManager& manager);
+
+    bool isOpen() const { return fd >= 0; }
+    std::uint64_t size();
+
+    // Records
+    void reservationStored(const Reservation& reservation);
+    void reservationErased(const Reservation& reservation);
+    void reservationPaid(const Reservation& reservation);
+    void reservationSubmitted(const Reservation& reservation);
+    void reservationApproved(RecordId reservationId);
+    void reservationRejected(RecordId reservationId);
+    void reservationUnscheduled(RecordId reservationId);
+    void ticketIssued(const Ticket& ticket);
+    void ticketCancelled(const Ticket& ticket);
+    void ticketCheckedIn(const Ticket& ticket);
+    void waitlistJoined(const Event& event, const User& user);
+    void eventCreated(const Event& event);
+    void eventCancelled(const Event& event);
+    void capacityRaised(const Event& event, int newMaxCapacity);
+    void budgetChanged(const User& user, double delta);
+    void managerBudgetChanged(double delta);
+};
+
+#endif // JOURNAL_H
@@ -0,0 +1,49 @@
+#include "MappedFile.h"
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+MappedFile::MappedFile(const std::string& filename) : mappedData(nullptr), mappedSize(0) {
+    open(filename);
+}
+
+MappedFile::~MappedFile() {
+    close();
+}
+
+bool MappedFile::open(const std::string& filename) {
+    close();
+
+    int fd = ::open(filename.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+
+    struct stat info;
+    if (fstat(fd, &info) != 0 || info.st_size <= 0) {
+        ::close(fd);
+        return false;
+    }
+
+    void* mapping = mmap(nullptr, static_cast<std::size_t>(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd); // The mapping keeps the file referenced
+    if (mapping == MAP_FAILED) {
+        return false;
+    }
+
+    // Loaders walk the file front to back exactly once
+    madvise(mapping, static_cast<std::size_t>(info.st_size), MADV_SEQUENTIAL);
+    madvise(mapping, static_cast<std::size_t>(info.st_size), MADV_WILLNEED);
+    mappedData = static_cast<const char*>(mapping);
+    mappedSize = static_cast<std::size_t>(info.st_size);
+    return true;
+}
+
+void MappedFile::close() {
+    if (mappedData != nullptr) {
+        munmap(const_cast<char*>(mappedData), mappedSize);
+        mappedData = nullptr;
+        mappedSize = 0;
+    }
+}
@@ -0,0 +1,30 @@
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+#include <string>
+#include <cstddef>
+
+// Read-only memory mapping of a whole file. The mapping lives as long as the
+// object, so anything viewing into data() must not outlive it.
+class MappedFile {
+private:
+    const char* mappedData;
+    std::size_t mappedSize;
+
+public:
+    MappedFile() : mappedData(nullptr), mappedSize(0) {}
+    explicit MappedFile(const std::string& filename);
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    bool open(const std::string& filename);
+    void close();
+
+    bool isOpen() const { return mappedData != nullptr; }
+    const char* data() const { return mappedData; }
+    std::size_t size() const { return mappedSize; }
+};
+
+#endif // MAPPED_FILE_H
@@ -1,6 +1,7 @@
 #include "NonResident.h"
 #include "Reservation.h"
 #include "Ticket.h"
+#include "EventDirectory.h"
 #include "Event.h"
 #include <iostream>
 #include <fstream>
@@ -13,21 +14,11 @@ NonResident::NonResident(const std::string& username, const std::string& passwor
 
 bool NonResident::makeReservation(std::unique_ptr<Reservation> reservation) {
     // Check if the non-resident has reached the weekly limit (24 hours)
-    auto now = std::chrono::system_clock::now();
-    auto oneWeekAgo = now - std::chrono::hours(24 * 7);
-    
-    std::chrono::duration<double, std::ratio<3600>> totalHours(0);
-    for (const auto& res : reservations) {
-        if (res->getStartTime() >= oneWeekAgo) {
-            totalHours += std::chrono::duration_cast<std::chrono::duration<double, std::ratio<3600>>>(
-                res->getEndTime() - res->getStartTime());
-        }
-    }
-    
+    double totalHours = usage.weeklyHours();
     totalHours += std::chrono::duration_cast<std::chrono::duration<double, std::ratio<3600>>>(
-        reservation->getEndTime() - reservation->getStartTime());
+        reservation->getEndTime() - reservation->getStartTime()).count();
     
-    if (totalHours.count() > 24) {
+    if (totalHours > 24) {
         std::cout << "Reservation exceeds weekly limit of 24 hours for non-residents." << std::endl;
         return false;
     }
@@ -35,7 +26,7 @@ bool NonResident::makeReservation(std::unique_ptr<Reservation> reservation) {
     double cost = reservation->getTotalCost();
     if (deductFromBudget(cost)) {
         std::cout << "Making reservation for NonResident: " << getUsername() << std::endl;
-        reservations.push_back(std::move(reservation));
+        storeReservation(std::move(reservation));
         return true;
     } else {
         std::cout << "Insufficient funds to make the reservation." << std::endl;
@@ -43,36 +34,31 @@ bool NonResident::makeReservation(std::unique_ptr<Reservation> reservation) {
     }
 }
 
-bool NonResident::cancelReservation(const std::string& reservationId) {
-    auto it = std::find_if(reservations.begin(), reservations.end(),
-        [&reservationId](const std::unique_ptr<Reservation>& r) { return r->getId() == reservationId; });
+bool NonResident::cancelReservation(RecordId reservationId) {
+    Reservation* reservation = reservations.get(reservationId);
 
-    if (it != reservations.end()) {
-        double refundAmount = (*it)->calculateRefund();
+    if (reservation != nullptr) {
+        double refundAmount = reservation->calculateRefund();
         addToBudget(refundAmount);
         std::cout << "Canceling reservation for NonResident: " << getUsername() << std::endl;
         std::cout << "Refund amount: $" << refundAmount << std::endl;
-        reservations.erase(it);
+        eraseReservation(*reservation);
         return true;
     }
     std::cout << "Reservation not found." << std::endl;
     return false;
 }
 
-bool NonResident::purchaseTicket(std::unique_ptr<Ticket> ticket) {
+bool NonResident::purchaseTicket(Ticket* ticket) {
     if (!ticket->getEvent()->getAllowsNonResidents()) {
         std::cout << "This event is not open to non-residents." << std::endl;
         return false;
     }
     
-    if (deductFromBudget(ticket->getPrice())) {
-        std::cout << "Purchasing ticket for NonResident: " << getUsername() << std::endl;
-        tickets.push_back(std::move(ticket));
-        return true;
-    } else {
-        std::cout << "Insufficient funds to purchase the ticket." << std::endl;
-        return false;
-    }
+    // Payment was taken by the event when the ticket was issued
+    std::cout << "Purchasing ticket for NonResident: " << getUsername() << std::endl;
+    attachTicket(ticket);
+    return true;
 }
 
 void NonResident::viewSchedule() const {
@@ -85,6 +71,7 @@ void NonResident::viewSchedule() const {
         }
     }
     
+    std::lock_guard<std::mutex> lock(ticketsMutex);
     if (tickets.empty()) {
         std::cout << "No tickets purchased." << std::endl;
     } else {
@@ -95,7 +82,7 @@ void NonResident::viewSchedule() const {
     }
 }
 
-void NonResident::saveToFile(const std::string& filename) const {
+bool NonResident::saveIndexFile(const std::string& filename) const {
     std::ofstream file(filename);
     if (file.is_open()) {
         file << getUsername() << std::endl;
@@ -106,22 +93,42 @@ void NonResident::saveToFile(const std::string& filename) const {
         // Save reservations
         file << reservations.size() << std::endl;
         for (const auto& reservation : reservations) {
-            file << reservation->getId() << std::endl;
-            reservation->saveToFile(filename + "_" + reservation->getId());
+            file << reservation->getIdString() << std::endl;
         }
 
         // Save tickets
+        std::lock_guard<std::mutex> lock(ticketsMutex);
         file << tickets.size() << std::endl;
         for (const auto& ticket : tickets) {
-            file << ticket->getId() << std::endl;
-            ticket->saveToFile(filename + "_" + ticket->getId());
+            file << ticket->getIdString() << std::endl;
         }
 
         file.close();
         std::cout << "NonResident data saved to file: " << filename << std::endl;
+        return true;
     } else {
         std::cout << "Unable to open file: " << filename << std::endl;
+        return false;
+    }
+}
+
+bool NonResident::saveToFile(const std::string& filename) const {
+    std::size_t failed = 0;
+    bool indexSaved = saveIndexFile(filename);
+    saveRecordFiles(filename, 0, failed);
+    return indexSaved && failed == 0;
+}
+
+std::size_t NonResident::saveChanged(const std::string& filename, std::uint64_t since, std::size_t& failed) const {
+    std::size_t written = saveRecordFiles(filename, since, failed);
+    if (getModified() > since) {
+        if (saveIndexFile(filename)) {
+            ++written;
+        } else {
+            ++failed;
+        }
     }
+    return written;
 }
 
 void NonResident::loadFromFile(const std::string& filename, const std::vector<std::unique_ptr<Event>>& events) {
@@ -146,21 +153,20 @@ void NonResident::loadFromFile(const std::string& filename, const std::vector<st
             file >> reservationId;
             auto reservation = Reservation::loadFromFile(filename + "_" + reservationId, this);
             if (reservation) {
-                reservations.push_back(std::move(reservation));
+                storeReservation(std::move(reservation));
             }
         }
 
         // Load tickets
         int numTickets;
         file >> numTickets;
+        EventDirectory directory(events);
         for (int i = 0; i < numTickets; ++i) {
             std::string ticketId;
             file >> ticketId;
-            std::vector<std::unique_ptr<User>> users;
-            users.push_back(std::unique_ptr<User>(this));
-            auto ticket = Ticket::loadFromFile(filename + "_" + ticketId, events, users);
-            if (ticket) {
-                tickets.push_back(std::move(ticket));
+            Ticket* ticket = Ticket::loadFromFile(filename + "_" + ticketId, directory, this);
+            if (ticket && !holdsTicket(ticket)) {
+                attachTicket(ticket);
             }
         }
 
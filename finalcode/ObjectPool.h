@@ -0,0 +1,165 @@
+#ifndef OBJECT_POOL_H
+#define OBJECT_POOL_H
+
+#include <vector>
+#include <memory>
+#include <utility>
+#include <atomic>
+#include <mutex>
+#include <new>
+#include <cstddef>
+#include <type_traits>
+
+// Allocation counters for one pooled type, summed over every pool of that type
+struct AllocationCounts {
+    std::size_t created;   // Objects handed out
+    std::size_t destroyed; // Objects given back
+    std::size_t chunks;    // Heap allocations made to hold them
+
+    std::size_t live() const { return created - destroyed; }
+};
+
+template<typename T>
+class PoolStats {
+private:
+    static std::atomic<std::size_t>& counter(int which) {
+        static std::atomic<std::size_t> counters[3] = { {0}, {0}, {0} };
+        return counters[which];
+    }
+
+public:
+    static void created() { counter(0).fetch_add(1, std::memory_order_relaxed); }
+    static void destroyed() { counter(1).fetch_add(1, std::memory_order_relaxed); }
+    static void chunk() { counter(2).fetch_add(1, std::memory_order_relaxed); }
+
+    static AllocationCounts counts() {
+        return AllocationCounts{ counter(0).load(), counter(1).load(), counter(2).load() };
+    }
+};
+
+// Fixed-size object pool. Storage is carved out of chunks and recycled through
+// an intrusive free list, so creating an object only touches the heap when the
+// current chunk runs out. Objects must be returned with destroy(); the pool
+// releases its chunks on destruction but never runs destructors by itself.
+// Not synchronized; see PooledObject for a shared, locked pool.
+template<typename T>
+class ObjectPool {
+private:
+    union Slot {
+        Slot* next;
+        typename std::aligned_storage<sizeof(T), alignof(T)>::type storage;
+    };
+
+    std::vector<std::unique_ptr<Slot[]>> chunks;
+    Slot* freeList;
+    std::size_t chunkSize;
+
+    void grow() {
+        std::unique_ptr<Slot[]> chunk(new Slot[chunkSize]);
+        for (std::size_t i = 0; i < chunkSize; ++i) {
+            chunk[i].next = (i + 1 < chunkSize) ? &chunk[i + 1] : freeList;
+        }
+        freeList = &chunk[0];
+        chunks.push_back(std::move(chunk));
+        PoolStats<T>::chunk();
+    }
+
+public:
+    explicit ObjectPool(std::size_t chunkSize = 64)
+        : freeList(nullptr), chunkSize(chunkSize > 0 ? chunkSize : 1) {}
+
+    ObjectPool(const ObjectPool&) = delete;
+    ObjectPool& operator=(const ObjectPool&) = delete;
+
+    // Uninitialized storage for one T
+    void* allocate() {
+        if (freeList == nullptr) {
+            grow();
+        }
+        Slot* slot = freeList;
+        freeList = slot->next;
+        PoolStats<T>::created();
+        return &slot->storage;
+    }
+
+    // Takes back storage from allocate() whose object is already destroyed
+    void deallocate(void* storage) {
+        Slot* slot = static_cast<Slot*>(storage);
+        slot->next = freeList;
+        freeList = slot;
+        PoolStats<T>::destroyed();
+    }
+
+    template<typename... Args>
+    T* create(Args&&... args) {
+        void* storage = allocate();
+        try {
+            return new (storage) T(std::forward<Args>(args)...);
+        } catch (...) {
+            deallocate(storage);
+            throw;
+        }
+    }
+
+    void destroy(T* object) {
+        if (object == nullptr) {
+            return;
+        }
+        object->~T();
+        deallocate(object);
+    }
+
+    std::size_t chunkCount() const { return chunks.size(); }
+};
+
+// Base for classes whose every `new` should come from pooled chunks: the
+// creation paths (make_unique, loaders, replay) keep using new/unique_ptr and
+// get their storage from one process-wide ObjectPool<T> behind a mutex.
+// Objects of classes derived from T fall back to the global heap.
+template<typename T>
+class PooledObject {
+private:
+    struct SharedPool {
+        std::mutex mutex;
+        ObjectPool<T> pool;
+
+        SharedPool() : pool(256) {}
+    };
+
+    static SharedPool& shared() {
+        static SharedPool instance;
+        return instance;
+    }
+
+public:
+    static void* operator new(std::size_t size) {
+        if (size != sizeof(T)) {
+            return ::operator new(size);
+        }
+        SharedPool& shared = PooledObject::shared();
+        std::lock_guard<std::mutex> lock(shared.mutex);
+        return shared.pool.allocate();
+    }
+
+    static void operator delete(void* storage, std::size_t size) {
+        if (storage == nullptr) {
+            return;
+        }
+        if (size != sizeof(T)) {
+            ::operator delete(storage);
+            return;
+        }
+        SharedPool& shared = PooledObject::shared();
+        std::lock_guard<std::mutex> lock(shared.mutex);
+        shared.pool.deallocate(storage);
+    }
+
+    // Declaring operator new hides placement new; containers that manage their
+    // own slots still need it
+    static void* operator new(std::size_t, void* where) { return where; }
+    static void operator delete(void*, void*) {}
+
+    static AllocationCounts allocationCounts() { return PoolStats<T>::counts(); }
+};
+
+#endif // OBJECT_POOL_H
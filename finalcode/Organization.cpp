@@ -1,6 +1,7 @@
 #include "Organization.h"
 #include "Reservation.h"
 #include "Ticket.h"
+#include "EventDirectory.h"
 #include "Event.h"
 #include <iostream>
 #include <fstream>
@@ -13,21 +14,11 @@ Organization::Organization(const std::string& username, const std::string& passw
 
 bool Organization::makeReservation(std::unique_ptr<Reservation> reservation) {
     // Check if the organization has reached the weekly limit (36 hours)
-    auto now = std::chrono::system_clock::now();
-    auto oneWeekAgo = now - std::chrono::hours(24 * 7);
-    
-    std::chrono::duration<double, std::ratio<3600>> totalHours(0);
-    for (const auto& res : reservations) {
-        if (res->getStartTime() >= oneWeekAgo) {
-            totalHours += std::chrono::duration_cast<std::chrono::duration<double, std::ratio<3600>>>(
-                res->getEndTime() - res->getStartTime());
-        }
-    }
-    
+    double totalHours = usage.weeklyHours();
     totalHours += std::chrono::duration_cast<std::chrono::duration<double, std::ratio<3600>>>(
-        reservation->getEndTime() - reservation->getStartTime());
+        reservation->getEndTime() - reservation->getStartTime()).count();
     
-    if (totalHours.count() > 36) {
+    if (totalHours > 36) {
         std::cout << "Reservation exceeds weekly limit of 36 hours for organizations." << std::endl;
         return false;
     }
@@ -41,7 +32,7 @@ bool Organization::makeReservation(std::unique_ptr<Reservation> reservation) {
     double cost = reservation->getTotalCost();
     if (deductFromBudget(cost)) {
         std::cout << "Making reservation for Organization: " << getUsername() << std::endl;
-        reservations.push_back(std::move(reservation));
+        storeReservation(std::move(reservation));
         return true;
     } else {
         std::cout << "Insufficient funds to make the reservation." << std::endl;
@@ -49,31 +40,26 @@ bool Organization::makeReservation(std::unique_ptr<Reservation> reservation) {
     }
 }
 
-bool Organization::cancelReservation(const std::string& reservationId) {
-    auto it = std::find_if(reservations.begin(), reservations.end(),
-        [&reservationId](const std::unique_ptr<Reservation>& r) { return r->getId() == reservationId; });
+bool Organization::cancelReservation(RecordId reservationId) {
+    Reservation* reservation = reservations.get(reservationId);
 
-    if (it != reservations.end()) {
-        double refundAmount = (*it)->calculateRefund();
+    if (reservation != nullptr) {
+        double refundAmount = reservation->calculateRefund();
         addToBudget(refundAmount);
         std::cout << "Canceling reservation for Organization: " << getUsername() << std::endl;
         std::cout << "Refund amount: $" << refundAmount << std::endl;
-        reservations.erase(it);
+        eraseReservation(*reservation);
         return true;
     }
     std::cout << "Reservation not found." << std::endl;
     return false;
 }
 
-bool Organization::purchaseTicket(std::unique_ptr<Ticket> ticket) {
-    if (deductFromBudget(ticket->getPrice())) {
-        std::cout << "Purchasing ticket for Organization: " << getUsername() << std::endl;
-        tickets.push_back(std::move(ticket));
-        return true;
-    } else {
-        std::cout << "Insufficient funds to purchase the ticket." << std::endl;
-        return false;
-    }
+bool Organization::purchaseTicket(Ticket* ticket) {
+    // Payment was taken by the event when the ticket was issued
+    std::cout << "Purchasing ticket for Organization: " << getUsername() << std::endl;
+    attachTicket(ticket);
+    return true;
 }
 
 void Organization::viewSchedule() const {
@@ -86,6 +72,7 @@ void Organization::viewSchedule() const {
         }
     }
     
+    std::lock_guard<std::mutex> lock(ticketsMutex);
     if (tickets.empty()) {
         std::cout << "No tickets purchased." << std::endl;
     } else {
@@ -96,7 +83,7 @@ void Organization::viewSchedule() const {
     }
 }
 
-void Organization::saveToFile(const std::string& filename) const {
+bool Organization::saveIndexFile(const std::string& filename) const {
     std::ofstream file(filename);
     if (file.is_open()) {
         file << getUsername() << std::endl;
@@ -107,22 +94,42 @@ void Organization::saveToFile(const std::string& filename) const {
         // Save reservations
         file << reservations.size() << std::endl;
         for (const auto& reservation : reservations) {
-            file << reservation->getId() << std::endl;
-            reservation->saveToFile(filename + "_" + reservation->getId());
+            file << reservation->getIdString() << std::endl;
         }
 
         // Save tickets
+        std::lock_guard<std::mutex> lock(ticketsMutex);
         file << tickets.size() << std::endl;
         for (const auto& ticket : tickets) {
-            file << ticket->getId() << std::endl;
-            ticket->saveToFile(filename + "_" + ticket->getId());
+            file << ticket->getIdString() << std::endl;
         }
 
         file.close();
         std::cout << "Organization data saved to file: " << filename << std::endl;
+        return true;
     } else {
         std::cout << "Unable to open file: " << filename << std::endl;
+        return false;
+    }
+}
+
+bool Organization::saveToFile(const std::string& filename) const {
+    std::size_t failed = 0;
+    bool indexSaved = saveIndexFile(filename);
+    saveRecordFiles(filename, 0, failed);
+    return indexSaved && failed == 0;
+}
+
+std::size_t Organization::saveChanged(const std::string& filename, std::uint64_t since, std::size_t& failed) const {
+    std::size_t written = saveRecordFiles(filename, since, failed);
+    if (getModified() > since) {
+        if (saveIndexFile(filename)) {
+            ++written;
+        } else {
+            ++failed;
+        }
     }
+    return written;
 }
 
 void Organization::loadFromFile(const std::string& filename, 
@@ -148,21 +155,20 @@ void Organization::loadFromFile(const std::string& filename,
             file >> reservationId;
             auto reservation = Reservation::loadFromFile(filename + "_" + reservationId, this);
             if (reservation) {
-                reservations.push_back(std::move(reservation));
+                storeReservation(std::move(reservation));
             }
         }
 
         // Load tickets
         int numTickets;
         file >> numTickets;
+        EventDirectory directory(events);
         for (int i = 0; i < numTickets; ++i) {
             std::string ticketId;
             file >> ticketId;
-            std::vector<std::unique_ptr<User>> users;
-            users.push_back(std::unique_ptr<User>(this));
-            auto ticket = Ticket::loadFromFile(filename + "_" + ticketId, events, users);
-            if (ticket) {
-                tickets.push_back(std::move(ticket));
+            Ticket* ticket = Ticket::loadFromFile(filename + "_" + ticketId, directory, this);
+            if (ticket && !holdsTicket(ticket)) {
+                attachTicket(ticket);
             }
         }
 
@@ -13,15 +13,17 @@ public:
     Organization(const std::string& username, const std::string& password);
 
     bool makeReservation(std::unique_ptr<Reservation> reservation) override;
-    bool cancelReservation(const std::string& reservationId) override;
-    bool purchaseTicket(std::unique_ptr<Ticket> ticket) override;
+    bool cancelReservation(RecordId reservationId) override;
+    bool purchaseTicket(Ticket* ticket) override;
 
     void viewSchedule() const override;
 
-    void saveToFile(const std::string& filename) const override;
+    bool saveToFile(const std::string& filename) const override;
+    std::size_t saveChanged(const std::string& filename, std::uint64_t since, std::size_t& failed) const override;
     void loadFromFile(const std::string& filename, const std::vector<std::unique_ptr<Event>>& events) override;
 
 private:
+    bool saveIndexFile(const std::string& filename) const;
     bool isValidLayoutStyle(LayoutStyle style) const;
 };
 
@@ -0,0 +1,68 @@
+#ifndef RECORD_ID_H
+#define RECORD_ID_H
+
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+
+// Reservations and tickets are identified by a number. Code compares ids as
+// integers; the "RES0042"/"TKT0042" text is only produced for display and the
+// text files, and only parsed where it comes back in (user input, old files).
+typedef std::uint64_t RecordId;
+
+// Hands out ids for one kind of record. Anything restored from disk reports its
+// id through observe(), so new records never reuse an id from an earlier run.
+class IdSequence {
+private:
+    std::atomic<std::uint64_t> nextId;
+
+public:
+    IdSequence() : nextId(1) {}
+
+    RecordId next() { return nextId.fetch_add(1); }
+
+    void observe(RecordId id) {
+        std::uint64_t current = nextId.load();
+        while (current <= id && !nextId.compare_exchange_weak(current, id + 1)) {
+        }
+    }
+};
+
+// "RES" and 42 give "RES0042"
+inline std::string formatRecordId(const char* prefix, RecordId id) {
+    char buffer[32];
+    std::snprintf(buffer, sizeof(buffer), "%s%04llu", prefix, static_cast<unsigned long long>(id));
+    return buffer;
+}
+
+// Accepts the formatted id ("RES0042", any case) or just its number ("42")
+inline bool parseRecordId(const std::string& text, const char* prefix, RecordId& id) {
+    std::size_t i = 0;
+    std::size_t prefixLength = std::char_traits<char>::length(prefix);
+    if (text.size() > prefixLength) {
+        bool prefixed = true;
+        for (std::size_t k = 0; k < prefixLength; ++k) {
+            char c = text[k];
+            if (c >= 'a' && c <= 'z') {
+                c = static_cast<char>(c - 'a' + 'A');
+            }
+            prefixed = prefixed && c == prefix[k];
+        }
+        i = prefixed ? prefixLength : 0;
+    }
+    if (i == text.size() || text.size() - i > 19) {
+        return false;
+    }
+    RecordId value = 0;
+    for (; i < text.size(); ++i) {
+        if (text[i] < '0' || text[i] > '9') {
+            return false;
+        }
+        value = value * 10 + static_cast<RecordId>(text[i] - '0');
+    }
+    id = value;
+    return true;
+}
+
+#endif // RECORD_ID_H
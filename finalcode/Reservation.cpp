@@ -1,25 +1,44 @@
 #include "Reservation.h"
 #include "User.h"
 #include "FacilityManager.h"
+#include "Journal.h"
+#include "Generation.h"
 #include <iostream>
 #include <fstream>
 #include <sstream>
 #include <iomanip>
 #include <chrono>
 
-int Reservation::nextId = 1;
+IdSequence Reservation::ids;
 
 Reservation::Reservation(User* user, const std::chrono::system_clock::time_point& start,
                          const std::chrono::system_clock::time_point& end, LayoutStyle style, bool isPublic)
-    : user(user), startTime(start), endTime(end), layoutStyle(style), isPublic(isPublic), isPaid(false)
+    : id(ids.next()), user(user), startTime(start), endTime(end), layoutStyle(style), isPublic(isPublic),
+      isPaid(false), modified(Generation::next())
 {
-    std::stringstream ss;
-    ss << "RES" << std::setw(4) << std::setfill('0') << nextId++;
-    id = ss.str();
-
     totalCost = calculateCost();
 }
 
+Reservation::Reservation(User* user, const std::chrono::system_clock::time_point& start,
+                         const std::chrono::system_clock::time_point& end, LayoutStyle style, bool isPublic,
+                         RecordId id, bool isPaid, double totalCost)
+    : id(id), user(user), startTime(start), endTime(end), layoutStyle(style), isPublic(isPublic),
+      isPaid(isPaid), totalCost(totalCost), modified(Generation::next())
+{
+    ids.observe(id);
+}
+
+void Reservation::setId(RecordId newId)
+{
+    id = newId;
+    ids.observe(newId);
+}
+
+void Reservation::touch()
+{
+    modified = Generation::next();
+}
+
 bool Reservation::overlaps(const std::chrono::system_clock::time_point& start,
                            const std::chrono::system_clock::time_point& end) const
 {
@@ -56,6 +75,10 @@ bool Reservation::makePayment(double amount)
 {
     if (amount >= totalCost) {
         isPaid = true;
+        touch();
+        if (Journal* journal = Journal::active()) {
+            journal->reservationPaid(*this);
+        }
         return true;
     }
     return false;
@@ -95,7 +118,7 @@ std::string Reservation::toString() const
         return ss.str();
     };
 
-    ss << "Reservation " << id << " for " << user->getUsername()
+    ss << "Reservation " << getIdString() << " for " << user->getUsername()
        << ": " << timeToString(startTime) << " to " << timeToString(endTime)
        << " (Layout: " << static_cast<int>(layoutStyle) << ")"
        << " - " << (isPublic ? "Public" : "Private")
@@ -122,12 +145,12 @@ double Reservation::calculateRefund() const
     return 0.0;
 }
 
-void Reservation::saveToFile(const std::string& filename) const
+bool Reservation::saveToFile(const std::string& filename) const
 {
     std::ofstream file(filename);
     if (file.is_open()) {
-        file << id << std::endl;
-        file << user->getUsername() << std::endl;
+        file << getIdString() << std::endl;
+        file << (user ? user->getUsername() : "") << std::endl; // The facility may hold ownerless bookings
         file << startTime.time_since_epoch().count() << std::endl;
         file << endTime.time_since_epoch().count() << std::endl;
         file << static_cast<int>(layoutStyle) << std::endl;
@@ -136,8 +159,10 @@ void Reservation::saveToFile(const std::string& filename) const
         file << totalCost << std::endl;
         file.close();
         std::cout << "Reservation data saved to file: " << filename << std::endl;
+        return true;
     } else {
         std::cout << "Unable to open file: " << filename << std::endl;
+        return false;
     }
 }
 
@@ -145,13 +170,13 @@ std::unique_ptr<Reservation> Reservation::loadFromFile(const std::string& filena
 {
     std::ifstream file(filename);
     if (file.is_open()) {
-        std::string id, username;
+        std::string idText, username;
         long long startTimeCount, endTimeCount;
         int layoutStyleInt;
         bool isPublic, isPaid;
         double totalCost;
 
-        std::getline(file, id);
+        std::getline(file, idText);
         std::getline(file, username);
         file >> startTimeCount >> endTimeCount >> layoutStyleInt >> isPublic >> isPaid >> totalCost;
 
@@ -159,10 +184,14 @@ std::unique_ptr<Reservation> Reservation::loadFromFile(const std::string& filena
         auto endTime = std::chrono::system_clock::time_point(std::chrono::system_clock::duration(endTimeCount));
         auto layoutStyle = static_cast<LayoutStyle>(layoutStyleInt);
 
-        auto reservation = std::unique_ptr<Reservation>(new Reservation(user, startTime, endTime, layoutStyle, isPublic));
-        reservation->setId(id);
-        reservation->isPaid = isPaid;
-        reservation->totalCost = totalCost;
+        RecordId id;
+        if (!parseRecordId(idText, "RES", id)) {
+            std::cout << "Invalid reservation ID in file: " << filename << std::endl;
+            return nullptr;
+        }
+
+        auto reservation = std::unique_ptr<Reservation>(new Reservation(user, startTime, endTime, layoutStyle, isPublic,
+                                                                        id, isPaid, totalCost));
 
         file.close();
         std::cout << "Reservation data loaded from file: " << filename << std::endl;
@@ -4,14 +4,19 @@
 #include <string>
 #include <chrono>
 #include <memory>
+#include <cstdint>
 #include "LayoutStyle.h"
+#include "RecordId.h"
 
 class User;
 class FacilityManager;
 
+// Stored reservations live in ReservationStore slots, which pool them
 class Reservation {
+    friend class Snapshot;
+
 private:
-    std::string id;
+    RecordId id;
     User* user;
     std::chrono::system_clock::time_point startTime;
     std::chrono::system_clock::time_point endTime;
@@ -19,12 +24,17 @@ private:
     bool isPublic;
     bool isPaid;
     double totalCost;
+    std::uint64_t modified; // Generation of the last change, for incremental saves
 
-    static int nextId;
+    static IdSequence ids;
 
 public:
     Reservation(User* user, const std::chrono::system_clock::time_point& start,
                 const std::chrono::system_clock::time_point& end, LayoutStyle style, bool isPublic);
+    // Restores a saved reservation without drawing a new id or recomputing its cost
+    Reservation(User* user, const std::chrono::system_clock::time_point& start,
+                const std::chrono::system_clock::time_point& end, LayoutStyle style, bool isPublic,
+                RecordId id, bool isPaid, double totalCost);
 
     bool overlaps(const std::chrono::system_clock::time_point& start,
                   const std::chrono::system_clock::time_point& end) const;
@@ -35,7 +45,8 @@ public:
     double calculateRefund() const;
 
     // Getters
-    const std::string& getId() const { return id; }
+    RecordId getId() const { return id; }
+    std::string getIdString() const { return formatRecordId("RES", id); }
     User* getUser() const { return user; }
     const std::chrono::system_clock::time_point& getStartTime() const { return startTime; }
     const std::chrono::system_clock::time_point& getEndTime() const { return endTime; }
@@ -43,12 +54,17 @@ public:
     bool getIsPublic() const { return isPublic; }
     bool getIsPaid() const { return isPaid; }
     double getTotalCost() const { return totalCost; }
+    std::uint64_t getModified() const { return modified; }
+
+    // Marks the reservation changed. Containers also call this when one moves
+    // into them, as its file under the new owner has not been written yet.
+    void touch();
 
     // Setter for id (used in loading from file)
-    void setId(const std::string& newId) { id = newId; }
+    void setId(RecordId newId);
 
     // File operations
-    void saveToFile(const std::string& filename) const;
+    bool saveToFile(const std::string& filename) const;
     static std::unique_ptr<Reservation> loadFromFile(const std::string& filename, User* user);
 };
 
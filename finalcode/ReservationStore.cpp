@@ -0,0 +1,167 @@
+#include "ReservationStore.h"
+#include "User.h"
+
+ReservationStore::ReservationStore() : slotCount(0), freeHead(0), liveCount(0) {}
+
+ReservationStore::~ReservationStore() {
+    for (std::uint32_t i = 0; i < slotCount; ++i) {
+        Slot& slot = slotAt(i);
+        if (slot.live) {
+            reinterpret_cast<Reservation*>(&slot.storage)->~Reservation();
+        }
+    }
+}
+
+ReservationStore& ReservationStore::shared() {
+    static ReservationStore store;
+    return store;
+}
+
+ReservationStore::Slot* ReservationStore::resolve(ReservationHandle handle) const {
+    if (handle.isNull() || handle.slot >= slotCount) {
+        return nullptr;
+    }
+    Slot& slot = slotAt(handle.slot);
+    return slot.live && slot.generation == handle.generation ? &slot : nullptr;
+}
+
+std::uint32_t ReservationStore::takeSlot() {
+    if (freeHead == slotCount) {
+        if (slotCount % CHUNK_SIZE == 0) {
+            chunks.push_back(std::unique_ptr<Slot[]>(new Slot[CHUNK_SIZE]));
+            PoolStats<Reservation>::chunk();
+        }
+        Slot& fresh = slotAt(slotCount);
+        fresh.generation = 0;
+        fresh.live = false;
+        fresh.nextFree = ++slotCount;
+        freeHead = slotCount - 1;
+    }
+    std::uint32_t index = freeHead;
+    freeHead = slotAt(index).nextFree;
+    return index;
+}
+
+ReservationHandle ReservationStore::fill(std::uint32_t index) {
+    Slot& slot = slotAt(index);
+    if (++slot.generation == 0) {
+        slot.generation = 1;
+    }
+    slot.holders = 0;
+    slot.state = ReservationState::Booked;
+    slot.live = true;
+    ++liveCount;
+    PoolStats<Reservation>::created();
+    return ReservationHandle(index, slot.generation);
+}
+
+ReservationHandle ReservationStore::adopt(std::unique_ptr<Reservation> reservation) {
+    if (!reservation) {
+        return ReservationHandle();
+    }
+    return emplace(std::move(*reservation));
+}
+
+ReservationHandle ReservationStore::heldCopy(const User* user, RecordId id) {
+    return user != nullptr ? user->getReservations().find(id) : ReservationHandle();
+}
+
+Reservation* ReservationStore::get(ReservationHandle handle) const {
+    Slot* slot = resolve(handle);
+    return slot ? reinterpret_cast<Reservation*>(&slot->storage) : nullptr;
+}
+
+ReservationState ReservationStore::getState(ReservationHandle handle) const {
+    Slot* slot = resolve(handle);
+    return slot ? slot->state : ReservationState::Booked;
+}
+
+void ReservationStore::setState(ReservationHandle handle, ReservationState state) {
+    if (Slot* slot = resolve(handle)) {
+        slot->state = state;
+    }
+}
+
+void ReservationStore::retain(ReservationHandle handle) {
+    if (Slot* slot = resolve(handle)) {
+        ++slot->holders;
+    }
+}
+
+void ReservationStore::release(ReservationHandle handle) {
+    Slot* slot = resolve(handle);
+    if (slot != nullptr && slot->holders > 0 && --slot->holders == 0) {
+        destroy(handle.slot);
+    }
+}
+
+void ReservationStore::discardIfUnheld(ReservationHandle handle) {
+    Slot* slot = resolve(handle);
+    if (slot != nullptr && slot->holders == 0) {
+        destroy(handle.slot);
+    }
+}
+
+void ReservationStore::destroy(std::uint32_t index) {
+    Slot& slot = slotAt(index);
+    reinterpret_cast<Reservation*>(&slot.storage)->~Reservation();
+    slot.live = false;
+    ++slot.generation; // Outstanding handles stop resolving
+    slot.nextFree = freeHead;
+    freeHead = index;
+    --liveCount;
+    PoolStats<Reservation>::destroyed();
+}
+
+ReservationList::~ReservationList() {
+    clear();
+}
+
+bool ReservationList::add(ReservationHandle handle) {
+    ReservationStore& store = ReservationStore::shared();
+    Reservation* reservation = store.get(handle);
+    if (reservation == nullptr || !positions.insert(std::make_pair(reservation->getId(), handles.size())).second) {
+        return false;
+    }
+    store.retain(handle);
+    handles.push_back(handle);
+    return true;
+}
+
+bool ReservationList::remove(RecordId id) {
+    auto it = positions.find(id);
+    if (it == positions.end()) {
+        return false;
+    }
+    std::size_t position = it->second;
+    ReservationHandle handle = handles[position];
+    positions.erase(it);
+
+    // Fill the gap with the last handle
+    if (position + 1 != handles.size()) {
+        handles[position] = handles.back();
+        positions[ReservationStore::shared().get(handles[position])->getId()] = position;
+    }
+    handles.pop_back();
+
+    ReservationStore::shared().release(handle);
+    return true;
+}
+
+void ReservationList::clear() {
+    ReservationStore& store = ReservationStore::shared();
+    for (ReservationHandle handle : handles) {
+        store.release(handle);
+    }
+    handles.clear();
+    positions.clear();
+}
+
+ReservationHandle ReservationList::find(RecordId id) const {
+    auto it = positions.find(id);
+    return it != positions.end() ? handles[it->second] : ReservationHandle();
+}
+
+Reservation* ReservationList::get(RecordId id) const {
+    return ReservationStore::shared().get(find(id));
+}
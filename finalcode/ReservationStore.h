@@ -0,0 +1,168 @@
+#ifndef RESERVATION_STORE_H
+#define RESERVATION_STORE_H
+
+#include <vector>
+#include <memory>
+#include <unordered_map>
+#include <iterator>
+#include <cstdint>
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+#include <new>
+#include "Reservation.h"
+#include "RecordId.h"
+#include "ObjectPool.h"
+
+// Refers to a reservation in the ReservationStore. A slot's generation changes
+// whenever it is released, so a handle kept past that resolves to nullptr
+// instead of to whatever reservation reuses the slot.
+struct ReservationHandle {
+    std::uint32_t slot;
+    std::uint32_t generation; // 0 is never issued: the null handle
+
+    ReservationHandle() : slot(0), generation(0) {}
+    ReservationHandle(std::uint32_t slot, std::uint32_t generation) : slot(slot), generation(generation) {}
+
+    bool isNull() const { return generation == 0; }
+    bool operator==(const ReservationHandle& other) const {
+        return slot == other.slot && generation == other.generation;
+    }
+    bool operator!=(const ReservationHandle& other) const { return !(*this == other); }
+};
+
+// Where a reservation is in its life. Moving on is a change of state; the
+// reservation itself stays in its slot.
+enum class ReservationState : std::uint8_t {
+    Booked,   // Held by its user only
+    Pending,  // Waiting for the facility manager
+    Approved, // On the facility schedule
+    Rejected  // Turned down by the facility manager
+};
+
+// Owns every reservation. Reservations sit in fixed-size chunks of slots that
+// never move, so a Reservation* stays valid as long as the reservation is
+// held. The store is the reservations' pool: emplace builds one straight into
+// a slot, and the counts show up in PoolStats<Reservation>. Users, the facility manager and the facility keep ReservationLists of
+// handles; a reservation is destroyed when the last list lets go of it.
+// Like the lists, the store is used from one thread at a time.
+class ReservationStore {
+private:
+    static const std::uint32_t CHUNK_SIZE = 256;
+
+    struct Slot {
+        std::aligned_storage<sizeof(Reservation), alignof(Reservation)>::type storage;
+        std::uint32_t generation;
+        std::uint32_t holders; // Lists holding the reservation; 0 while the slot is free
+        std::uint32_t nextFree;
+        ReservationState state;
+        bool live;
+    };
+
+    std::vector<std::unique_ptr<Slot[]>> chunks;
+    std::uint32_t slotCount;
+    std::uint32_t freeHead; // Next free slot, or slotCount when none
+    std::size_t liveCount;
+
+    Slot& slotAt(std::uint32_t index) const { return chunks[index / CHUNK_SIZE][index % CHUNK_SIZE]; }
+    Slot* resolve(ReservationHandle handle) const;
+    std::uint32_t takeSlot(); // A free slot, growing the store if need be
+    ReservationHandle fill(std::uint32_t index); // Marks a constructed slot live
+    void destroy(std::uint32_t index);
+
+public:
+    ReservationStore();
+    ~ReservationStore();
+
+    ReservationStore(const ReservationStore&) = delete;
+    ReservationStore& operator=(const ReservationStore&) = delete;
+
+    // The store every list refers to
+    static ReservationStore& shared();
+
+    // Constructs a reservation from the arguments in a slot, in state Booked,
+    // with no holders yet
+    template<typename... Args>
+    ReservationHandle emplace(Args&&... args) {
+        std::uint32_t index = takeSlot();
+        new (&slotAt(index).storage) Reservation(std::forward<Args>(args)...);
+        return fill(index);
+    }
+    // Moves the reservation into a slot, like emplace
+    ReservationHandle adopt(std::unique_ptr<Reservation> reservation);
+    // For loading saved state, which lists a request under its user and again
+    // under the manager or facility: the copy the user already holds under the
+    // id, or the null handle
+    static ReservationHandle heldCopy(const User* user, RecordId id);
+    // nullptr for the null handle and for a reservation that no longer exists
+    Reservation* get(ReservationHandle handle) const;
+
+    ReservationState getState(ReservationHandle handle) const;
+    void setState(ReservationHandle handle, ReservationState state);
+
+    void retain(ReservationHandle handle);
+    // Destroys the reservation when its last holder lets go
+    void release(ReservationHandle handle);
+    // Destroys an adopted reservation that no list took
+    void discardIfUnheld(ReservationHandle handle);
+
+    std::size_t size() const { return liveCount; }
+    std::size_t chunkCount() const { return chunks.size(); }
+};
+
+// The reservations one owner holds, as handles into the shared store. Adding,
+// finding by id and removing are O(1); removal moves the last handle into the
+// gap, so the order is insertion order only until something is removed.
+// Iterating yields Reservation pointers.
+class ReservationList {
+private:
+    std::vector<ReservationHandle> handles;
+    std::unordered_map<RecordId, std::size_t> positions;
+
+public:
+    class const_iterator {
+    private:
+        std::vector<ReservationHandle>::const_iterator position;
+
+    public:
+        typedef std::forward_iterator_tag iterator_category;
+        typedef Reservation* value_type;
+        typedef std::ptrdiff_t difference_type;
+        typedef Reservation* const* pointer;
+        typedef Reservation* reference;
+
+        explicit const_iterator(std::vector<ReservationHandle>::const_iterator position) : position(position) {}
+
+        Reservation* operator*() const { return ReservationStore::shared().get(*position); }
+        const_iterator& operator++() {
+            ++position;
+            return *this;
+        }
+        bool operator==(const const_iterator& other) const { return position == other.position; }
+        bool operator!=(const const_iterator& other) const { return position != other.position; }
+        ReservationHandle handle() const { return *position; }
+    };
+
+    ReservationList() = default;
+    ~ReservationList();
+
+    ReservationList(const ReservationList&) = delete;
+    ReservationList& operator=(const ReservationList&) = delete;
+
+    // Holds the reservation; false if the handle is stale or its id is already listed
+    bool add(ReservationHandle handle);
+    // Lets go of the reservation; false if the id is not listed
+    bool remove(RecordId id);
+    void clear();
+
+    // The null handle / nullptr when the id is not listed
+    ReservationHandle find(RecordId id) const;
+    Reservation* get(RecordId id) const;
+
+    std::size_t size() const { return handles.size(); }
+    bool empty() const { return handles.empty(); }
+    const_iterator begin() const { return const_iterator(handles.begin()); }
+    const_iterator end() const { return const_iterator(handles.end()); }
+};
+
+#endif // RESERVATION_STORE_H
@@ -0,0 +1,150 @@
+#include "ScheduleColumns.h"
+#include "Reservation.h"
+#include "User.h"
+#include <algorithm>
+#include <limits>
+
+#if CC_HAVE_X86_SIMD
+#include <immintrin.h>
+#endif
+
+namespace {
+    std::size_t firstOverlapScalar(const std::int64_t* starts, const std::int64_t* ends, std::size_t count,
+                                   std::size_t from, std::int64_t start, std::int64_t end) {
+        for (std::size_t i = from; i < count; ++i) {
+            if (starts[i] < end && start < ends[i]) {
+                return i;
+            }
+        }
+        return count;
+    }
+
+#if CC_HAVE_X86_SIMD
+    __attribute__((target("sse4.2")))
+    std::size_t firstOverlapSSE42(const std::int64_t* starts, const std::int64_t* ends, std::size_t count,
+                                  std::int64_t start, std::int64_t end) {
+        const __m128i queryStart = _mm_set1_epi64x(start);
+        const __m128i queryEnd = _mm_set1_epi64x(end);
+        std::size_t i = 0;
+        for (; i + 2 <= count; i += 2) {
+            __m128i s = _mm_loadu_si128(reinterpret_cast<const __m128i*>(starts + i));
+            __m128i e = _mm_loadu_si128(reinterpret_cast<const __m128i*>(ends + i));
+            __m128i hit = _mm_and_si128(_mm_cmpgt_epi64(queryEnd, s), _mm_cmpgt_epi64(e, queryStart));
+            int mask = _mm_movemask_pd(_mm_castsi128_pd(hit));
+            if (mask != 0) {
+                return i + __builtin_ctz(mask);
+            }
+        }
+        return firstOverlapScalar(starts, ends, count, i, start, end);
+    }
+
+    // Two vectors (8 bookings) per iteration keep both compare ports busy
+    __attribute__((target("avx2")))
+    std::size_t firstOverlapAVX2(const std::int64_t* starts, const std::int64_t* ends, std::size_t count,
+                                 std::int64_t start, std::int64_t end) {
+        const __m256i queryStart = _mm256_set1_epi64x(start);
+        const __m256i queryEnd = _mm256_set1_epi64x(end);
+        std::size_t i = 0;
+        for (; i + 8 <= count; i += 8) {
+            __m256i s0 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(starts + i));
+            __m256i e0 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(ends + i));
+            __m256i s1 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(starts + i + 4));
+            __m256i e1 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(ends + i + 4));
+            __m256i hit0 = _mm256_and_si256(_mm256_cmpgt_epi64(queryEnd, s0), _mm256_cmpgt_epi64(e0, queryStart));
+            __m256i hit1 = _mm256_and_si256(_mm256_cmpgt_epi64(queryEnd, s1), _mm256_cmpgt_epi64(e1, queryStart));
+            int mask = _mm256_movemask_pd(_mm256_castsi256_pd(hit0)) |
+                       (_mm256_movemask_pd(_mm256_castsi256_pd(hit1)) << 4);
+            if (mask != 0) {
+                return i + __builtin_ctz(mask);
+            }
+        }
+        for (; i + 4 <= count; i += 4) {
+            __m256i s = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(starts + i));
+            __m256i e = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(ends + i));
+            __m256i hit = _mm256_and_si256(_mm256_cmpgt_epi64(queryEnd, s), _mm256_cmpgt_epi64(e, queryStart));
+            int mask = _mm256_movemask_pd(_mm256_castsi256_pd(hit));
+            if (mask != 0) {
+                return i + __builtin_ctz(mask);
+            }
+        }
+        return firstOverlapScalar(starts, ends, count, i, start, end);
+    }
+#endif
+}
+
+ScheduleColumns::ScheduleColumns() : longest(0), level(detectSimdLevel()) {}
+
+void ScheduleColumns::insert(const Reservation& reservation) {
+    std::int64_t start = ticks(reservation.getStartTime());
+    std::int64_t end = ticks(reservation.getEndTime());
+    // After any rows with the same start, so equal starts keep insertion order
+    std::size_t row = std::upper_bound(starts.begin(), starts.end(), start) - starts.begin();
+
+    starts.insert(starts.begin() + row, start);
+    ends.insert(ends.begin() + row, end);
+    users.insert(users.begin() + row, reservation.getUser() ? reservation.getUser()->getUsernameId() : SymbolTable::NONE);
+    ids.insert(ids.begin() + row, reservation.getId());
+    flags.insert(flags.begin() + row, static_cast<std::uint8_t>(reservation.getIsPublic() ? PUBLIC : 0));
+    longest = std::max(longest, end - start);
+}
+
+bool ScheduleColumns::erase(const Reservation& reservation) {
+    std::int64_t start = ticks(reservation.getStartTime());
+    auto range = std::equal_range(starts.begin(), starts.end(), start);
+    for (auto it = range.first; it != range.second; ++it) {
+        std::size_t row = it - starts.begin();
+        if (ids[row] == reservation.getId()) {
+            starts.erase(starts.begin() + row);
+            ends.erase(ends.begin() + row);
+            users.erase(users.begin() + row);
+            ids.erase(ids.begin() + row);
+            flags.erase(flags.begin() + row);
+            return true;
+        }
+    }
+    return false;
+}
+
+void ScheduleColumns::clear() {
+    starts.clear();
+    ends.clear();
+    users.clear();
+    ids.clear();
+    flags.clear();
+    longest = 0;
+}
+
+void ScheduleColumns::window(std::int64_t start, std::int64_t end, std::size_t& first, std::size_t& last) const {
+    // Rows starting at or after end cannot overlap, nor can rows starting more
+    // than `longest` before start: they have already ended
+    std::int64_t earliest = start < std::numeric_limits<std::int64_t>::min() + longest
+                                ? std::numeric_limits<std::int64_t>::min() : start - longest;
+    first = std::lower_bound(starts.begin(), starts.end(), earliest) - starts.begin();
+    last = std::lower_bound(starts.begin() + first, starts.end(), end) - starts.begin();
+}
+
+bool ScheduleColumns::overlaps(std::int64_t start, std::int64_t end) const {
+    std::size_t first, last;
+    window(start, end, first, last);
+    std::size_t count = last - first;
+    return firstOverlap(starts.data() + first, ends.data() + first, count, start, end, level) != count;
+}
+
+std::size_t ScheduleColumns::firstOverlap(const std::int64_t* starts, const std::int64_t* ends, std::size_t count,
+                                          std::int64_t start, std::int64_t end, SimdLevel level) {
+#if CC_HAVE_X86_SIMD
+    SimdLevel supported = detectSimdLevel();
+    if (level > supported) {
+        level = supported;
+    }
+    if (level == SimdLevel::AVX2) {
+        return firstOverlapAVX2(starts, ends, count, start, end);
+    }
+    if (level == SimdLevel::SSE42) {
+        return firstOverlapSSE42(starts, ends, count, start, end);
+    }
+#else
+    (void)level;
+#endif
+    return firstOverlapScalar(starts, ends, count, 0, start, end);
+}
@@ -0,0 +1,75 @@
+#ifndef SCHEDULE_COLUMNS_H
+#define SCHEDULE_COLUMNS_H
+
+#include <vector>
+#include <chrono>
+#include <cstdint>
+#include <cstddef>
+#include "RecordId.h"
+#include "SymbolTable.h"
+#include "CpuFeatures.h"
+
+class Reservation;
+
+// The facility schedule as parallel arrays, one row per booking, kept sorted
+// by start time. Conflict checks read only the start and end columns, which
+// sit contiguously in memory, instead of following a pointer per reservation.
+//
+// A query binary-searches the rows that start within `longest` before its
+// window (earlier ones have ended) up to its end (later ones have not begun),
+// then runs the overlap kernel over that slice.
+class ScheduleColumns {
+public:
+    enum Flag : std::uint8_t {
+        PUBLIC = 1
+    };
+
+private:
+    std::vector<std::int64_t> starts; // Clock ticks, ascending
+    std::vector<std::int64_t> ends;
+    std::vector<SymbolId> users;      // SymbolTable::NONE for a reservation without a user
+    std::vector<RecordId> ids;
+    std::vector<std::uint8_t> flags;
+    std::int64_t longest; // Longest booking ever inserted; an upper bound after erases
+    SimdLevel level;
+
+public:
+    ScheduleColumns();
+
+    void insert(const Reservation& reservation);
+    // False if the reservation is not on the schedule
+    bool erase(const Reservation& reservation);
+    void clear();
+
+    // True if any booking overlaps [start, end)
+    bool overlaps(std::int64_t start, std::int64_t end) const;
+    // Rows [first, last) are the only ones that can overlap [start, end): they
+    // start before end and at most `longest` before start
+    void window(std::int64_t start, std::int64_t end, std::size_t& first, std::size_t& last) const;
+    // The first row from `row` up to `last` that ends after start, or last
+    std::size_t nextEndingAfter(std::size_t row, std::size_t last, std::int64_t start) const {
+        while (row < last && ends[row] <= start) {
+            ++row;
+        }
+        return row;
+    }
+
+    std::size_t size() const { return starts.size(); }
+    std::int64_t startAt(std::size_t row) const { return starts[row]; }
+    std::int64_t endAt(std::size_t row) const { return ends[row]; }
+    SymbolId userAt(std::size_t row) const { return users[row]; }
+    RecordId idAt(std::size_t row) const { return ids[row]; }
+    std::uint8_t flagsAt(std::size_t row) const { return flags[row]; }
+
+    static std::int64_t ticks(const std::chrono::system_clock::time_point& time) {
+        return static_cast<std::int64_t>(time.time_since_epoch().count());
+    }
+
+    // Overlap kernel: the first i with starts[i] < end && start < ends[i], or
+    // count when there is none. Runs at the given level, or the widest one the
+    // CPU supports if that is narrower.
+    static std::size_t firstOverlap(const std::int64_t* starts, const std::int64_t* ends, std::size_t count,
+                                    std::int64_t start, std::int64_t end, SimdLevel level = detectSimdLevel());
+};
+
+#endif // SCHEDULE_COLUMNS_H
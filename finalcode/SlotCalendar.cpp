@@ -0,0 +1,195 @@
+#include "SlotCalendar.h"
+#include <chrono>
+#include <algorithm>
+
+#if CC_HAVE_X86_SIMD
+#include <immintrin.h>
+#endif
+
+namespace {
+    const std::int64_t TICKS_PER_MINUTE =
+        std::chrono::duration_cast<std::chrono::system_clock::duration>(std::chrono::minutes(1)).count();
+    const std::int64_t TICKS_PER_SLOT = TICKS_PER_MINUTE * SlotCalendar::SLOT_MINUTES;
+    const std::int64_t TICKS_PER_DAY = TICKS_PER_MINUTE * 24 * 60;
+
+    std::int64_t floorDiv(std::int64_t value, std::int64_t divisor) {
+        std::int64_t quotient = value / divisor;
+        return (value % divisor != 0 && value < 0) ? quotient - 1 : quotient;
+    }
+
+    // Bits [from, to) of a word
+    std::uint64_t bitRange(std::int64_t from, std::int64_t to) {
+        if (to <= from) {
+            return 0;
+        }
+        std::uint64_t upTo = to >= 64 ? ~std::uint64_t(0) : (std::uint64_t(1) << to) - 1;
+        std::uint64_t below = (std::uint64_t(1) << from) - 1;
+        return upTo & ~below;
+    }
+
+    void classifyScalar(const std::uint64_t* touched, const std::uint64_t* full, std::size_t from, std::size_t count,
+                        std::uint64_t touchedMask, std::uint64_t fullMask,
+                        std::uint64_t& freeBits, std::uint64_t& busyBits) {
+        for (std::size_t i = from; i < count; ++i) {
+            freeBits |= static_cast<std::uint64_t>((touched[i] & touchedMask) == 0) << i;
+            busyBits |= static_cast<std::uint64_t>((full[i] & fullMask) != 0) << i;
+        }
+    }
+
+#if CC_HAVE_X86_SIMD
+    __attribute__((target("avx2")))
+    void classifyAVX2(const std::uint64_t* touched, const std::uint64_t* full, std::size_t count,
+                      std::uint64_t touchedMask, std::uint64_t fullMask,
+                      std::uint64_t& freeBits, std::uint64_t& busyBits) {
+        const __m256i touchedMasks = _mm256_set1_epi64x(static_cast<long long>(touchedMask));
+        const __m256i fullMasks = _mm256_set1_epi64x(static_cast<long long>(fullMask));
+        const __m256i zero = _mm256_setzero_si256();
+        std::size_t i = 0;
+        for (; i + 4 <= count; i += 4) {
+            __m256i t = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(touched + i));
+            __m256i f = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(full + i));
+            __m256i clear = _mm256_cmpeq_epi64(_mm256_and_si256(t, touchedMasks), zero);
+            __m256i notCovered = _mm256_cmpeq_epi64(_mm256_and_si256(f, fullMasks), zero);
+            freeBits |= static_cast<std::uint64_t>(_mm256_movemask_pd(_mm256_castsi256_pd(clear))) << i;
+            busyBits |= static_cast<std::uint64_t>(~_mm256_movemask_pd(_mm256_castsi256_pd(notCovered)) & 0xF) << i;
+        }
+        classifyScalar(touched, full, i, count, touchedMask, fullMask, freeBits, busyBits);
+    }
+#endif
+}
+
+const int SlotCalendar::SLOT_MINUTES;
+const int SlotCalendar::SLOTS;
+
+SlotCalendar::SlotCalendar(int openingHour)
+    : coverageStart(TICKS_PER_MINUTE * 60 * openingHour), level(detectSimdLevel()) {}
+
+std::int64_t SlotCalendar::ticksPerDay() {
+    return TICKS_PER_DAY;
+}
+
+std::int64_t SlotCalendar::dayOf(std::int64_t ticks) {
+    return floorDiv(ticks, TICKS_PER_DAY);
+}
+
+bool SlotCalendar::slotMasks(std::int64_t start, std::int64_t end, std::uint64_t& touched, std::uint64_t& full) const {
+    std::int64_t from = start - coverageStart;
+    std::int64_t to = end - coverageStart;
+    if (from < 0 || to > SLOTS * TICKS_PER_SLOT || to <= from) {
+        return false;
+    }
+    touched = bitRange(from / TICKS_PER_SLOT, (to + TICKS_PER_SLOT - 1) / TICKS_PER_SLOT);
+    full = bitRange((from + TICKS_PER_SLOT - 1) / TICKS_PER_SLOT, to / TICKS_PER_SLOT);
+    return true;
+}
+
+void SlotCalendar::mark(std::int64_t day, std::uint64_t touched, std::uint64_t full) {
+    Block& block = blocks[floorDiv(day, 64)]; // Value-initialized: all slots free
+    std::int64_t index = day - floorDiv(day, 64) * 64;
+    block.touched[index] |= touched;
+    block.full[index] |= full;
+}
+
+void SlotCalendar::add(std::int64_t start, std::int64_t end) {
+    if (end <= start) {
+        return;
+    }
+    std::int64_t lastDay = dayOf(end - 1);
+    for (std::int64_t day = dayOf(start); day <= lastDay; ++day) {
+        // Only windows inside the covered hours are decided from the bitmap,
+        // and the part of a booking outside them cannot overlap those
+        std::int64_t midnight = day * TICKS_PER_DAY;
+        std::int64_t from = std::max(start - midnight, coverageStart);
+        std::int64_t to = std::min(end - midnight, coverageStart + SLOTS * TICKS_PER_SLOT);
+        std::uint64_t touched, full;
+        if (slotMasks(from, to, touched, full)) {
+            mark(day, touched, full);
+        }
+    }
+}
+
+void SlotCalendar::clearDays(std::int64_t firstDay, std::int64_t lastDay) {
+    for (std::int64_t day = firstDay; day <= lastDay; ++day) {
+        auto it = blocks.find(floorDiv(day, 64));
+        if (it != blocks.end()) {
+            std::int64_t index = day - it->first * 64;
+            it->second.touched[index] = 0;
+            it->second.full[index] = 0;
+        }
+    }
+}
+
+SlotCalendar::Answer SlotCalendar::test(std::int64_t start, std::int64_t end) const {
+    std::int64_t day = dayOf(start);
+    std::int64_t midnight = day * TICKS_PER_DAY;
+    std::uint64_t touchedMask, fullMask;
+    if (end > midnight + TICKS_PER_DAY || !slotMasks(start - midnight, end - midnight, touchedMask, fullMask)) {
+        return Unknown;
+    }
+    auto it = blocks.find(floorDiv(day, 64));
+    if (it == blocks.end()) {
+        return Free;
+    }
+    std::int64_t index = day - it->first * 64;
+    if ((it->second.touched[index] & touchedMask) == 0) {
+        return Free;
+    }
+    if ((it->second.full[index] & fullMask) != 0) {
+        return Busy;
+    }
+    return Unknown;
+}
+
+bool SlotCalendar::classifyDays(std::int64_t firstDay, std::size_t dayCount, int startMinute, int endMinute,
+                                std::uint64_t* freeDays, std::uint64_t* busyDays) const {
+    std::uint64_t touchedMask, fullMask;
+    if (!slotMasks(startMinute * TICKS_PER_MINUTE, endMinute * TICKS_PER_MINUTE, touchedMask, fullMask)) {
+        return false;
+    }
+
+    std::int64_t lastDay = firstDay + static_cast<std::int64_t>(dayCount);
+    for (std::int64_t blockIndex = floorDiv(firstDay, 64); blockIndex * 64 < lastDay; ++blockIndex) {
+        std::int64_t blockStart = blockIndex * 64;
+        std::uint64_t freeBits = ~std::uint64_t(0), busyBits = 0;
+        auto it = blocks.find(blockIndex);
+        if (it != blocks.end()) {
+            freeBits = 0;
+            classify(it->second.touched, it->second.full, 64, touchedMask, fullMask, freeBits, busyBits, level);
+        }
+
+        // Keep the days inside [firstDay, lastDay) and move them to their place in the result
+        std::uint64_t wanted = bitRange(std::max<std::int64_t>(firstDay - blockStart, 0),
+                                        std::min<std::int64_t>(lastDay - blockStart, 64));
+        freeBits &= wanted;
+        busyBits &= wanted;
+        std::int64_t offset = blockStart - firstDay;
+        if (offset < 0) {
+            freeDays[0] |= freeBits >> -offset;
+            busyDays[0] |= busyBits >> -offset;
+            continue;
+        }
+        std::size_t word = static_cast<std::size_t>(offset / 64);
+        unsigned shift = static_cast<unsigned>(offset % 64);
+        freeDays[word] |= freeBits << shift;
+        busyDays[word] |= busyBits << shift;
+        if (shift != 0 && word + 1 < (dayCount + 63) / 64) {
+            freeDays[word + 1] |= freeBits >> (64 - shift);
+            busyDays[word + 1] |= busyBits >> (64 - shift);
+        }
+    }
+    return true;
+}
+
+void SlotCalendar::classify(const std::uint64_t* touched, const std::uint64_t* full, std::size_t count,
+                            std::uint64_t touchedMask, std::uint64_t fullMask,
+                            std::uint64_t& freeBits, std::uint64_t& busyBits, SimdLevel level) {
+#if CC_HAVE_X86_SIMD
+    if (level == SimdLevel::AVX2 && detectSimdLevel() == SimdLevel::AVX2) {
+        classifyAVX2(touched, full, count, touchedMask, fullMask, freeBits, busyBits);
+        return;
+    }
+#else
+    (void)level;
+#endif
+    classifyScalar(touched, full, 0, count, touchedMask, fullMask, freeBits, busyBits);
+}
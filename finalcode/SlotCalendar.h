@@ -0,0 +1,78 @@
+#ifndef SLOT_CALENDAR_H
+#define SLOT_CALENDAR_H
+
+#include <unordered_map>
+#include <cstdint>
+#include <cstddef>
+#include "CpuFeatures.h"
+
+// Per-day occupancy bitmaps of a facility's schedule, in 15-minute slots.
+// A day's word covers 64 slots (16 hours) from the opening hour, UTC like the
+// facility's own hour checks. For every slot the calendar keeps whether any
+// booking touches it and whether some booking covers all of it, so:
+//   - a window whose slots no booking touches is free,
+//   - a window that fully contains a fully covered slot is taken,
+//   - anything else (bookings or windows off the 15-minute grid, windows
+//     outside the 16 hours) is left to the exact check on the schedule columns.
+// With bookings and windows on the grid the bitmaps alone always decide.
+//
+// Days are kept in blocks of 64, so a run of days is a contiguous array of
+// words that the classification kernel tests four at a time.
+class SlotCalendar {
+public:
+    static const int SLOT_MINUTES = 15;
+    static const int SLOTS = 64;
+
+    enum Answer {
+        Free,
+        Busy,
+        Unknown
+    };
+
+private:
+    struct Block {
+        std::uint64_t touched[64];
+        std::uint64_t full[64];
+    };
+
+    std::unordered_map<std::int64_t, Block> blocks; // By day / 64
+    std::int64_t coverageStart; // Opening hour, in ticks after midnight
+    SimdLevel level;
+
+    void mark(std::int64_t day, std::uint64_t touched, std::uint64_t full);
+    // Slots of one day that [start, end) touches and fully covers; false if
+    // it reaches outside the covered hours. start and end are ticks after midnight.
+    bool slotMasks(std::int64_t start, std::int64_t end, std::uint64_t& touched, std::uint64_t& full) const;
+
+public:
+    explicit SlotCalendar(int openingHour);
+
+    // Records a booking of [start, end), in clock ticks
+    void add(std::int64_t start, std::int64_t end);
+    // Forgets every booking on days [firstDay, lastDay]; the caller adds back
+    // the ones that remain
+    void clearDays(std::int64_t firstDay, std::int64_t lastDay);
+    void clear() { blocks.clear(); }
+
+    Answer test(std::int64_t start, std::int64_t end) const;
+
+    // For the window [startMinute, endMinute) of every day from firstDay on,
+    // sets bit i of freeDays where day firstDay + i is certainly free and of
+    // busyDays where it is certainly taken. Both hold (dayCount + 63) / 64
+    // words and are OR-ed into. False if the window is outside the covered hours.
+    bool classifyDays(std::int64_t firstDay, std::size_t dayCount, int startMinute, int endMinute,
+                      std::uint64_t* freeDays, std::uint64_t* busyDays) const;
+
+    static std::int64_t ticksPerDay();
+    // Days since the epoch, rounded down
+    static std::int64_t dayOf(std::int64_t ticks);
+
+    // Kernel: bit i of the results is day i of count (at most 64) being free,
+    // (touched[i] & touchedMask) == 0, or busy, (full[i] & fullMask) != 0.
+    // Runs AVX2 when asked for and supported, otherwise scalar.
+    static void classify(const std::uint64_t* touched, const std::uint64_t* full, std::size_t count,
+                         std::uint64_t touchedMask, std::uint64_t fullMask,
+                         std::uint64_t& freeBits, std::uint64_t& busyBits, SimdLevel level = detectSimdLevel());
+};
+
+#endif // SLOT_CALENDAR_H
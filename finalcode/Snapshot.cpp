@@ -0,0 +1,486 @@
+#include "Snapshot.h"
+#include "User.h"
+#include "Resident.h"
+#include "NonResident.h"
+#include "CityUser.h"
+#include "Organization.h"
+#include "Event.h"
+#include "Ticket.h"
+#include "Reservation.h"
+#include "Facility.h"
+#include "FacilityManager.h"
+#include "MappedFile.h"
+#include "BinaryIO.h"
+#include <iostream>
+#include <fstream>
+#include <cstring>
+
+namespace {
+    const char MAGIC[8] = { 'C', 'C', 'S', 'N', 'A', 'P', '\0', '\0' };
+    const std::uint32_t NO_REF = 0xFFFFFFFFu;
+
+    enum SectionTag : std::uint32_t {
+        SECTION_DICTIONARY = 1,
+        SECTION_USERS = 2,
+        SECTION_EVENTS = 3,
+        SECTION_SCHEDULE = 4,
+        SECTION_PENDING = 5
+    };
+
+    // Numbers the interned names a snapshot mentions from 0, in first-use order
+    class Dictionary {
+    private:
+        std::vector<std::uint32_t> refs; // Indexed by SymbolId; NO_REF until the name is added
+
+    public:
+        std::vector<SymbolId> entries;
+
+        std::uint32_t ref(SymbolId name) {
+            if (name >= refs.size()) {
+                refs.resize(name + 1, NO_REF);
+            }
+            if (refs[name] == NO_REF) {
+                refs[name] = static_cast<std::uint32_t>(entries.size());
+                entries.push_back(name);
+            }
+            return refs[name];
+        }
+
+        std::uint32_t find(SymbolId name) const {
+            return name < refs.size() ? refs[name] : NO_REF;
+        }
+    };
+
+    std::int64_t ticks(const std::chrono::system_clock::time_point& time) {
+        return static_cast<std::int64_t>(time.time_since_epoch().count());
+    }
+
+    std::chrono::system_clock::time_point fromTicks(std::int64_t value) {
+        return std::chrono::system_clock::time_point(std::chrono::system_clock::duration(value));
+    }
+
+    std::unique_ptr<User> makeUser(const std::string& username, const std::string& password, UserType type) {
+        switch (type) {
+            case UserType::Resident: return std::unique_ptr<User>(new Resident(username, password));
+            case UserType::NonResident: return std::unique_ptr<User>(new NonResident(username, password));
+            case UserType::City: return std::unique_ptr<User>(new CityUser(username, password));
+            case UserType::Organization: return std::unique_ptr<User>(new Organization(username, password));
+        }
+        return nullptr;
+    }
+
+    template<typename T>
+    T* lookup(const std::vector<T*>& table, std::uint32_t ref) {
+        return ref < table.size() ? table[ref] : nullptr;
+    }
+}
+
+// FNV-1a folded over 8-byte words (then the tail bytes), so verifying a large
+// snapshot costs one multiply per word rather than per byte.
+std::uint64_t Snapshot::checksum(const char* data, std::size_t size) {
+    const std::uint64_t prime = 1099511628211ULL;
+    std::uint64_t hash = 14695981039346656037ULL;
+    std::size_t i = 0;
+    for (; i + sizeof(std::uint64_t) <= size; i += sizeof(std::uint64_t)) {
+        std::uint64_t word;
+        std::memcpy(&word, data + i, sizeof(word));
+        hash ^= word;
+        hash *= prime;
+    }
+    for (; i < size; ++i) {
+        hash ^= static_cast<unsigned char>(data[i]);
+        hash *= prime;
+    }
+    return hash;
+}
+
+bool Snapshot::save(const std::string& filename,
+                    const std::vector<std::unique_ptr<User>>& users,
+                    const std::vector<std::unique_ptr<Event>>& events,
+                    const Facility& facility,
+                    const FacilityManager& manager) {
+    BinaryWriter out;
+    out.buffer.reserve(64 * 1024);
+    out.buffer.append(MAGIC, sizeof(MAGIC));
+    out.put<std::uint32_t>(VERSION);
+    out.put<std::uint32_t>(5);
+
+    Dictionary dictionary;
+    auto writeReservation = [&out, &dictionary](const Reservation& reservation) {
+        out.put<std::uint64_t>(reservation.getId());
+        out.put<std::uint32_t>(reservation.getUser() ? dictionary.find(reservation.getUser()->getUsernameId()) : NO_REF);
+        out.put<std::int64_t>(ticks(reservation.getStartTime()));
+        out.put<std::int64_t>(ticks(reservation.getEndTime()));
+        out.put<std::uint8_t>(static_cast<std::uint8_t>(reservation.getLayoutStyle()));
+        out.put<std::uint8_t>((reservation.getIsPublic() ? 1 : 0) | (reservation.getIsPaid() ? 2 : 0));
+        out.put<double>(reservation.getTotalCost());
+    };
+
+    for (const auto& user : users) {
+        dictionary.ref(user->getUsernameId());
+    }
+    for (const auto& event : events) {
+        dictionary.ref(event->getNameId());
+    }
+
+    std::size_t section = out.beginSection(SECTION_DICTIONARY);
+    out.put<std::uint32_t>(static_cast<std::uint32_t>(dictionary.entries.size()));
+    for (SymbolId entry : dictionary.entries) {
+        out.putString(SymbolTable::shared().name(entry));
+    }
+    out.endSection(section);
+
+    section = out.beginSection(SECTION_USERS);
+    out.put<std::uint32_t>(static_cast<std::uint32_t>(users.size()));
+    for (const auto& user : users) {
+        out.put<std::uint32_t>(dictionary.find(user->getUsernameId()));
+        out.putString(user->password);
+        out.put<std::uint8_t>(static_cast<std::uint8_t>(user->getType()));
+        out.put<double>(user->getBudget());
+        out.put<std::uint32_t>(static_cast<std::uint32_t>(user->reservations.size()));
+        for (const auto& reservation : user->reservations) {
+            writeReservation(*reservation);
+        }
+    }
+    out.endSection(section);
+
+    section = out.beginSection(SECTION_EVENTS);
+    out.put<std::uint32_t>(static_cast<std::uint32_t>(events.size()));
+    for (const auto& event : events) {
+        std::lock_guard<std::mutex> lock(event->registryMutex);
+        out.put<std::uint32_t>(dictionary.find(event->getNameId()));
+        out.putString(event->getDescription());
+        out.put<std::uint32_t>(dictionary.find(event->getOrganizer()->getUsernameId()));
+        out.put<double>(event->getTicketPrice());
+        out.put<std::int32_t>(event->getMaxCapacity());
+        out.put<std::int32_t>(event->getCurrentCapacity());
+        out.put<std::uint8_t>((event->getIsPublic() ? 1 : 0) |
+                              (event->getAllowsResidents() ? 2 : 0) |
+                              (event->getAllowsNonResidents() ? 4 : 0));
+        out.put<std::int64_t>(ticks(event->getStartTime()));
+        out.put<std::int64_t>(ticks(event->getEndTime()));
+
+        out.put<std::uint32_t>(static_cast<std::uint32_t>(event->tickets.size()));
+        for (const Ticket* ticket : event->tickets) {
+            out.put<std::uint64_t>(ticket->getId());
+            out.put<std::uint32_t>(dictionary.find(ticket->getUser()->getUsernameId()));
+            out.put<double>(ticket->getPrice());
+            out.put<std::uint8_t>((ticket->getIsValid() ? 1 : 0) | (ticket->getCheckedIn() ? 2 : 0));
+        }
+
+        out.put<std::uint32_t>(static_cast<std::uint32_t>(event->waitlist.size()));
+        for (const User* user : event->waitlist) {
+            out.put<std::uint32_t>(dictionary.find(user->getUsernameId()));
+        }
+    }
+    out.endSection(section);
+
+    section = out.beginSection(SECTION_SCHEDULE);
+    out.put<std::uint32_t>(static_cast<std::uint32_t>(facility.schedule.size()));
+    for (const auto& reservation : facility.schedule) {
+        writeReservation(*reservation);
+    }
+    out.endSection(section);
+
+    section = out.beginSection(SECTION_PENDING);
+    out.put<double>(manager.budget);
+    out.put<std::uint32_t>(static_cast<std::uint32_t>(manager.pendingReservations.size()));
+    for (const auto& reservation : manager.pendingReservations) {
+        writeReservation(*reservation);
+    }
+    out.endSection(section);
+
+    out.put<std::uint64_t>(checksum(out.buffer.data(), out.buffer.size()));
+
+    std::ofstream file(filename, std::ios::binary | std::ios::trunc);
+    if (!file.is_open()) {
+        std::cout << "Unable to open file: " << filename << std::endl;
+        return false;
+    }
+    file.write(out.buffer.data(), static_cast<std::streamsize>(out.buffer.size()));
+    file.close();
+    if (!file) {
+        std::cout << "Failed to write snapshot: " << filename << std::endl;
+        return false;
+    }
+    std::cout << "Snapshot saved to file: " << filename << std::endl;
+    return true;
+}
+
+bool Snapshot::load(const std::string& filename,
+                    std::vector<std::unique_ptr<User>>& users,
+                    std::vector<std::unique_ptr<Event>>& events,
+                    Facility& facility,
+                    FacilityManager& manager,
+                    std::uint64_t* loadedChecksum) {
+    std::ifstream file(filename, std::ios::binary | std::ios::ate);
+    if (!file.is_open()) {
+        std::cout << "Unable to open file: " << filename << std::endl;
+        return false;
+    }
+    std::streamsize size = file.tellg();
+    file.seekg(0, std::ios::beg);
+    std::vector<char> data(static_cast<std::size_t>(size > 0 ? size : 0));
+    if (size <= 0 || !file.read(data.data(), size)) {
+        std::cout << "Unable to read snapshot: " << filename << std::endl;
+        return false;
+    }
+    file.close();
+
+    std::uint64_t parsedChecksum;
+    if (!parse(data.data(), data.size(), users, events, facility, manager, parsedChecksum)) {
+        std::cout << "Snapshot is corrupt or from an unsupported version: " << filename << std::endl;
+        return false;
+    }
+    if (loadedChecksum != nullptr) {
+        *loadedChecksum = parsedChecksum;
+    }
+    std::cout << "Snapshot loaded from file: " << filename << std::endl;
+    return true;
+}
+
+bool Snapshot::loadMapped(const std::string& filename,
+                          std::vector<std::unique_ptr<User>>& users,
+                          std::vector<std::unique_ptr<Event>>& events,
+                          Facility& facility,
+                          FacilityManager& manager,
+                          std::uint64_t* loadedChecksum) {
+    MappedFile mapping(filename);
+    if (!mapping.isOpen()) {
+        std::cout << "Unable to map file: " << filename << std::endl;
+        return false;
+    }
+
+    std::uint64_t parsedChecksum;
+    if (!parse(mapping.data(), mapping.size(), users, events, facility, manager, parsedChecksum)) {
+        std::cout << "Snapshot is corrupt or from an unsupported version: " << filename << std::endl;
+        return false;
+    }
+    if (loadedChecksum != nullptr) {
+        *loadedChecksum = parsedChecksum;
+    }
+    std::cout << "Snapshot mapped from file: " << filename << std::endl;
+    return true;
+}
+
+bool Snapshot::parse(const char* data, std::size_t size,
+                     std::vector<std::unique_ptr<User>>& users,
+                     std::vector<std::unique_ptr<Event>>& events,
+                     Facility& facility,
+                     FacilityManager& manager,
+                     std::uint64_t& loadedChecksum) {
+    const std::size_t headerSize = sizeof(MAGIC) + 2 * sizeof(std::uint32_t);
+    if (size < headerSize + sizeof(std::uint64_t) || std::memcmp(data, MAGIC, sizeof(MAGIC)) != 0) {
+        return false;
+    }
+
+    std::size_t bodySize = size - sizeof(std::uint64_t);
+    std::uint64_t storedChecksum;
+    std::memcpy(&storedChecksum, data + bodySize, sizeof(storedChecksum));
+    if (storedChecksum != checksum(data, bodySize)) {
+        return false;
+    }
+    loadedChecksum = storedChecksum;
+
+    BinaryReader in(data + sizeof(MAGIC), bodySize - sizeof(MAGIC));
+    if (in.get<std::uint32_t>() != VERSION) {
+        return false;
+    }
+    std::uint32_t sectionCount = in.get<std::uint32_t>();
+
+    std::vector<StringRef> dictionary;
+    std::vector<User*> usersByRef;
+
+    // Everything is read into these first, so a snapshot that turns out to be
+    // bad part way through leaves the caller's state untouched
+    std::vector<std::unique_ptr<User>> loadedUsers;
+    std::vector<std::unique_ptr<Event>> loadedEvents;
+    ReservationList scheduled;
+    ReservationList pending;
+    double budget = manager.budget;
+
+    // Builds the reservation in the store, or shares the copy its user already
+    // holds. Only the facility schedule may hold a reservation nobody owns (NO_REF).
+    auto readReservation = [&usersByRef](BinaryReader& in, bool ownerless) -> ReservationHandle {
+        RecordId id = in.get<std::uint64_t>();
+        std::uint32_t userRef = in.get<std::uint32_t>();
+        User* user = lookup(usersByRef, userRef);
+        std::int64_t start = in.get<std::int64_t>();
+        std::int64_t end = in.get<std::int64_t>();
+        std::uint8_t layout = in.get<std::uint8_t>();
+        std::uint8_t flags = in.get<std::uint8_t>();
+        double totalCost = in.get<double>();
+        if (!in.ok() || (user == nullptr && !(ownerless && userRef == NO_REF))) {
+            return ReservationHandle();
+        }
+
+        ReservationHandle held = ReservationStore::heldCopy(user, id);
+        if (!held.isNull()) {
+            return held;
+        }
+        return ReservationStore::shared().emplace(user, fromTicks(start), fromTicks(end),
+                                                  static_cast<LayoutStyle>(layout), (flags & 1) != 0,
+                                                  id, (flags & 2) != 0, totalCost);
+    };
+
+    for (std::uint32_t s = 0; s < sectionCount && in.ok(); ++s) {
+        std::uint32_t tag = in.get<std::uint32_t>();
+        BinaryReader section = in.sub(in.get<std::uint64_t>());
+
+        switch (tag) {
+            case SECTION_DICTIONARY: {
+                std::uint32_t count = section.get<std::uint32_t>();
+                dictionary.reserve(count);
+                for (std::uint32_t i = 0; i < count && section.ok(); ++i) {
+                    dictionary.push_back(section.getString());
+                }
+                usersByRef.assign(dictionary.size(), nullptr);
+                break;
+            }
+            case SECTION_USERS: {
+                std::uint32_t count = section.get<std::uint32_t>();
+                loadedUsers.reserve(count);
+                for (std::uint32_t i = 0; i < count && section.ok(); ++i) {
+                    std::uint32_t nameRef = section.get<std::uint32_t>();
+                    StringRef password = section.getString();
+                    UserType type = static_cast<UserType>(section.get<std::uint8_t>());
+                    double budget = section.get<double>();
+                    if (nameRef >= dictionary.size()) {
+                        return false;
+                    }
+
+                    std::unique_ptr<User> user = makeUser(dictionary[nameRef].str(), password.str(), type);
+                    if (!user) {
+                        return false;
+                    }
+                    user->budget = budget;
+                    usersByRef[nameRef] = user.get();
+
+                    std::uint32_t reservationCount = section.get<std::uint32_t>();
+                    for (std::uint32_t r = 0; r < reservationCount && section.ok(); ++r) {
+                        ReservationHandle handle = readReservation(section, false);
+                        if (!handle.isNull()) {
+                            user->storeReservation(handle);
+                        }
+                    }
+                    loadedUsers.push_back(std::move(user));
+                }
+                break;
+            }
+            case SECTION_EVENTS: {
+                std::uint32_t count = section.get<std::uint32_t>();
+                loadedEvents.reserve(count);
+                // Journal records find events by name, so only the first event
+                // with a name is loaded; a later one is read past
+                std::vector<bool> named(dictionary.size(), false);
+                for (std::uint32_t i = 0; i < count && section.ok(); ++i) {
+                    std::uint32_t nameRef = section.get<std::uint32_t>();
+                    StringRef description = section.getString();
+                    User* organizer = lookup(usersByRef, section.get<std::uint32_t>());
+                    double ticketPrice = section.get<double>();
+                    std::int32_t maxCapacity = section.get<std::int32_t>();
+                    std::int32_t currentCapacity = section.get<std::int32_t>();
+                    std::uint8_t flags = section.get<std::uint8_t>();
+                    std::int64_t start = section.get<std::int64_t>();
+                    std::int64_t end = section.get<std::int64_t>();
+                    if (nameRef >= dictionary.size() || organizer == nullptr) {
+                        return false;
+                    }
+                    bool duplicate = named[nameRef];
+                    named[nameRef] = true;
+
+                    std::unique_ptr<Event> event(new Event(dictionary[nameRef].str(), description.str(), organizer,
+                                                           ticketPrice, maxCapacity, (flags & 1) != 0,
+                                                           (flags & 2) != 0, (flags & 4) != 0,
+                                                           fromTicks(start), fromTicks(end)));
+                    event->currentCapacity = currentCapacity;
+
+                    std::uint32_t ticketCount = section.get<std::uint32_t>();
+                    event->tickets.reserve(ticketCount);
+                    for (std::uint32_t t = 0; t < ticketCount && section.ok(); ++t) {
+                        RecordId id = section.get<std::uint64_t>();
+                        User* buyer = lookup(usersByRef, section.get<std::uint32_t>());
+                        double price = section.get<double>();
+                        std::uint8_t valid = section.get<std::uint8_t>();
+                        if (buyer == nullptr || duplicate) {
+                            continue;
+                        }
+                        Ticket* ticket = event->ticketPool.create(event.get(), buyer, price, id, (valid & 1) != 0);
+                        ticket->checkedIn = (valid & 2) != 0;
+                        if (!event->tickets.add(ticket)) {
+                            event->ticketPool.destroy(ticket); // Duplicate id
+                            continue;
+                        }
+                        buyer->attachTicket(ticket);
+                    }
+
+                    std::uint32_t waitlistSize = section.get<std::uint32_t>();
+                    for (std::uint32_t w = 0; w < waitlistSize && section.ok(); ++w) {
+                        User* waiting = lookup(usersByRef, section.get<std::uint32_t>());
+                        if (waiting != nullptr) {
+                            event->waitlist.push_back(waiting);
+                        }
+                    }
+                    if (!duplicate) {
+                        loadedEvents.push_back(std::move(event));
+                    }
+                }
+                break;
+            }
+            case SECTION_SCHEDULE: {
+                std::uint32_t count = section.get<std::uint32_t>();
+                for (std::uint32_t i = 0; i < count && section.ok(); ++i) {
+                    ReservationHandle handle = readReservation(section, true);
+                    if (!handle.isNull()) {
+                        scheduled.add(handle);
+                        ReservationStore::shared().discardIfUnheld(handle);
+                    }
+                }
+                break;
+            }
+            case SECTION_PENDING: {
+                budget = section.get<double>();
+                std::uint32_t count = section.get<std::uint32_t>();
+                for (std::uint32_t i = 0; i < count && section.ok(); ++i) {
+                    ReservationHandle handle = readReservation(section, false);
+                    if (!handle.isNull()) {
+                        pending.add(handle);
+                        ReservationStore::shared().discardIfUnheld(handle);
+                    }
+                }
+                break;
+            }
+            default:
+                // Unknown sections from newer writers are skipped
+                break;
+        }
+
+        if (!section.ok()) {
+            return false;
+        }
+    }
+    if (!in.ok()) {
+        return false;
+    }
+
+    users.reserve(users.size() + loadedUsers.size());
+    for (auto& user : loadedUsers) {
+        users.push_back(std::move(user));
+    }
+    events.reserve(events.size() + loadedEvents.size());
+    for (auto& event : loadedEvents) {
+        events.push_back(std::move(event));
+    }
+    for (auto it = scheduled.begin(); it != scheduled.end(); ++it) {
+        facility.insertReservation(it.handle());
+    }
+    ReservationStore& store = ReservationStore::shared();
+    for (auto it = pending.begin(); it != pending.end(); ++it) {
+        if (manager.pendingReservations.add(it.handle())) {
+            store.setState(it.handle(), ReservationState::Pending);
+        }
+    }
+    manager.budget = budget;
+    manager.touch();
+    return true;
+}
@@ -0,0 +1,67 @@
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <cstdint>
+#include <cstddef>
+
+class User;
+class Event;
+class Facility;
+class FacilityManager;
+
+// Single-file binary snapshot of the whole system state.
+//
+// Layout (little-endian, native widths):
+//   header   "CCSNAP\0\0", u32 version, u32 section count
+//   sections u32 tag, u64 payload length, payload
+//   footer   u64 FNV-1a checksum (folded per 8-byte word) of every byte before it
+//
+// Usernames and event names go into a dictionary section once; every other
+// record refers to them by index. Saving builds the image in memory and
+// writes it with one call, loading reads the file with one call and parses it
+// in place. loadMapped skips even that read: it maps the file and builds the
+// objects straight from the mapped bytes, viewing strings where they lie.
+class Snapshot {
+public:
+    static const std::uint32_t VERSION = 3;
+
+    static bool save(const std::string& filename,
+                     const std::vector<std::unique_ptr<User>>& users,
+                     const std::vector<std::unique_ptr<Event>>& events,
+                     const Facility& facility,
+                     const FacilityManager& manager);
+
+    // Appends the snapshot's users and events to the (normally empty) vectors
+    // and restores the facility schedule and pending queue. A bad snapshot
+    // changes none of them. On success
+    // *loadedChecksum, when given, is the checksum of the snapshot loaded.
+    static bool load(const std::string& filename,
+                     std::vector<std::unique_ptr<User>>& users,
+                     std::vector<std::unique_ptr<Event>>& events,
+                     Facility& facility,
+                     FacilityManager& manager,
+                     std::uint64_t* loadedChecksum = nullptr);
+
+    // Same as load, but through a read-only memory mapping of the file
+    static bool loadMapped(const std::string& filename,
+                           std::vector<std::unique_ptr<User>>& users,
+                           std::vector<std::unique_ptr<Event>>& events,
+                           Facility& facility,
+                           FacilityManager& manager,
+                           std::uint64_t* loadedChecksum = nullptr);
+
+    static std::uint64_t checksum(const char* data, std::size_t size);
+
+private:
+    static bool parse(const char* data, std::size_t size,
+                      std::vector<std::unique_ptr<User>>& users,
+                      std::vector<std::unique_ptr<Event>>& events,
+                      Facility& facility,
+                      FacilityManager& manager,
+                      std::uint64_t& loadedChecksum);
+};
+
+#endif // SNAPSHOT_H
@@ -0,0 +1,39 @@
+#ifndef STRING_REF_H
+#define STRING_REF_H
+
+#include <string>
+#include <cstring>
+#include <cstddef>
+#include <cstdint>
+
+// Non-owning view of characters held elsewhere (e.g. a mapped snapshot).
+// Only valid while the underlying buffer is.
+struct StringRef {
+    const char* data;
+    std::size_t size;
+
+    StringRef() : data(nullptr), size(0) {}
+    StringRef(const char* data, std::size_t size) : data(data), size(size) {}
+    StringRef(const std::string& value) : data(value.data()), size(value.size()) {}
+
+    std::string str() const { return std::string(data, size); }
+
+    bool operator==(const StringRef& other) const {
+        return size == other.size && (size == 0 || std::memcmp(data, other.data, size) == 0);
+    }
+    bool operator!=(const StringRef& other) const { return !(*this == other); }
+};
+
+// FNV-1a, for hash containers keyed by views
+struct StringRefHash {
+    std::size_t operator()(const StringRef& value) const {
+        std::uint64_t hash = 14695981039346656037ULL;
+        for (std::size_t i = 0; i < value.size; ++i) {
+            hash ^= static_cast<unsigned char>(value.data[i]);
+            hash *= 1099511628211ULL;
+        }
+        return static_cast<std::size_t>(hash);
+    }
+};
+
+#endif // STRING_REF_H
@@ -0,0 +1,77 @@
+#include "SymbolTable.h"
+#include <stdexcept>
+
+const SymbolId SymbolTable::NONE;
+
+SymbolTable::SymbolTable() : count(0), entries(1024, Entry{ 0, NONE }) {}
+
+SymbolTable& SymbolTable::shared() {
+    static SymbolTable table;
+    return table;
+}
+
+SymbolId SymbolTable::lookup(StringRef name, std::uint64_t hash) const {
+    std::size_t mask = entries.size() - 1;
+    for (std::size_t i = hash & mask; entries[i].id != NONE; i = (i + 1) & mask) {
+        if (entries[i].hash == hash && StringRef(this->name(entries[i].id)) == name) {
+            return entries[i].id;
+        }
+    }
+    return NONE;
+}
+
+void SymbolTable::grow() {
+    std::vector<Entry> old(entries.size() * 2, Entry{ 0, NONE });
+    old.swap(entries);
+    std::size_t mask = entries.size() - 1;
+    for (const Entry& entry : old) {
+        if (entry.id != NONE) {
+            std::size_t i = entry.hash & mask;
+            while (entries[i].id != NONE) {
+                i = (i + 1) & mask;
+            }
+            entries[i] = entry;
+        }
+    }
+}
+
+SymbolId SymbolTable::intern(StringRef name) {
+    std::uint64_t hash = StringRefHash()(name);
+    std::lock_guard<std::mutex> lock(mutex);
+    SymbolId id = lookup(name, hash);
+    if (id != NONE) {
+        return id;
+    }
+    if (count == CHUNK_SIZE * MAX_CHUNKS) {
+        throw std::length_error("SymbolTable is full");
+    }
+
+    id = count;
+    if (id % CHUNK_SIZE == 0) {
+        chunks[id / CHUNK_SIZE].reset(new std::string[CHUNK_SIZE]);
+    }
+    chunks[id / CHUNK_SIZE][id % CHUNK_SIZE].assign(name.data, name.size);
+    ++count;
+
+    if (count * 2 > entries.size()) {
+        grow();
+    }
+    std::size_t mask = entries.size() - 1;
+    std::size_t i = hash & mask;
+    while (entries[i].id != NONE) {
+        i = (i + 1) & mask;
+    }
+    entries[i] = Entry{ hash, id };
+    return id;
+}
+
+SymbolId SymbolTable::find(StringRef name) const {
+    std::uint64_t hash = StringRefHash()(name);
+    std::lock_guard<std::mutex> lock(mutex);
+    return lookup(name, hash);
+}
+
+std::size_t SymbolTable::size() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return count;
+}
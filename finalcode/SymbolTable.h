@@ -0,0 +1,63 @@
+#ifndef SYMBOL_TABLE_H
+#define SYMBOL_TABLE_H
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <cstdint>
+#include <cstddef>
+#include "StringRef.h"
+
+// Dense id of an interned name; ids are handed out from 0 in interning order
+typedef std::uint32_t SymbolId;
+
+// Interns usernames and event names. Each distinct name is stored once and
+// gets a dense SymbolId, so users and events keep an id instead of a string,
+// lookups index arrays by id, and the journal and snapshot write each name
+// once and refer to it by number.
+//
+// Names live in fixed-size chunks that never move and are never freed, so
+// name() takes no lock: an id can only be obtained from intern() or find(),
+// which publish the chunk holding it. Interning and finding are locked and
+// may be called from any thread.
+class SymbolTable {
+private:
+    static const std::uint32_t CHUNK_SIZE = 4096;
+    static const std::uint32_t MAX_CHUNKS = 16384;
+
+    struct Entry {
+        std::uint64_t hash;
+        SymbolId id; // NONE while the entry is empty
+    };
+
+    std::unique_ptr<std::string[]> chunks[MAX_CHUNKS];
+    std::uint32_t count;
+    // Open addressing (linear probing, never more than half full) from a name to its id
+    std::vector<Entry> entries;
+    mutable std::mutex mutex;
+
+    SymbolId lookup(StringRef name, std::uint64_t hash) const; // Caller holds mutex
+    void grow();
+
+public:
+    static const SymbolId NONE = 0xFFFFFFFF;
+
+    SymbolTable();
+
+    SymbolTable(const SymbolTable&) = delete;
+    SymbolTable& operator=(const SymbolTable&) = delete;
+
+    // The table every user and event name is interned in
+    static SymbolTable& shared();
+
+    // The name's id, adding the name if it is new
+    SymbolId intern(StringRef name);
+    // NONE if the name was never interned
+    SymbolId find(StringRef name) const;
+    const std::string& name(SymbolId id) const { return chunks[id / CHUNK_SIZE][id % CHUNK_SIZE]; }
+
+    std::size_t size() const;
+};
+
+#endif // SYMBOL_TABLE_H
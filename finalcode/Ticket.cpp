@@ -1,84 +1,125 @@
 #include "Ticket.h"
 #include "Event.h"
 #include "User.h"
+#include "Generation.h"
+#include "UserDirectory.h"
+#include "EventDirectory.h"
 #include <iostream>
 #include <fstream>
 #include <sstream>
 #include <iomanip>
 #include <algorithm>
 
-int Ticket::nextId = 1;
+IdSequence Ticket::ids;
 
 Ticket::Ticket(Event* event, User* user, double price)
-    : event(event), user(user), price(price), isValid(true) {
-    std::stringstream ss;
-    ss << "TKT" << std::setw(4) << std::setfill('0') << nextId++;
-    id = ss.str();
+    : id(ids.next()), event(event), user(user), price(price), isValid(true), checkedIn(false), modified(Generation::next()) {}
+
+Ticket::Ticket(Event* event, User* user, double price, RecordId id, bool isValid)
+    : id(id), event(event), user(user), price(price), isValid(isValid), checkedIn(false), modified(Generation::next()) {
+    ids.observe(id);
+}
+
+bool Ticket::markCheckedIn() {
+    if (checkedIn.exchange(true)) {
+        return false;
+    }
+    modified = Generation::next();
+    return true;
 }
 
 bool Ticket::cancel() {
-    if (isValid) {
-        isValid = false;
-        user->addToBudget(price); // Refund the ticket price to the user's budget
-        std::cout << "Ticket " << id << " has been cancelled and refunded." << std::endl;
+    std::string idText = getIdString();
+    if (isValid && event->cancelTicket(this)) {
+        std::cout << "Ticket " << idText << " has been cancelled and refunded." << std::endl;
         return true;
     }
-    std::cout << "Ticket " << id << " is already cancelled or invalid." << std::endl;
+    std::cout << "Ticket " << idText << " is already cancelled or invalid." << std::endl;
     return false;
 }
 
 std::string Ticket::toString() const {
     std::stringstream ss;
-    ss << "Ticket ID: " << id << std::endl
+    ss << "Ticket ID: " << getIdString() << std::endl
        << "Event: " << event->getName() << std::endl
        << "User: " << user->getUsername() << std::endl
        << "Price: $" << std::fixed << std::setprecision(2) << price << std::endl
-       << "Status: " << (isValid ? "Valid" : "Cancelled");
+       << "Status: " << (!isValid ? "Cancelled" : checkedIn.load() ? "Checked in" : "Valid");
     return ss.str();
 }
 
-void Ticket::saveToFile(const std::string& filename) const {
+bool Ticket::saveToFile(const std::string& filename) const {
     std::ofstream file(filename);
     if (file.is_open()) {
-        file << id << std::endl;
+        file << getIdString() << std::endl;
         file << event->getName() << std::endl;
         file << user->getUsername() << std::endl;
         file << price << std::endl;
         file << isValid << std::endl;
         file.close();
         std::cout << "Ticket data saved to file: " << filename << std::endl;
+        return true;
+    } else {
+        std::cout << "Unable to open file: " << filename << std::endl;
+        return false;
+    }
+}
+
+Ticket* Ticket::loadFromFile(const std::string& filename,
+                             const std::vector<std::unique_ptr<Event>>& events,
+                             const UserDirectory& users) {
+    std::ifstream file(filename);
+    if (file.is_open()) {
+        std::string idText, eventName, username;
+        std::getline(file, idText);
+        std::getline(file, eventName);
+        std::getline(file, username);
+        file.close();
+
+        if (User* user = users.find(username)) {
+            return loadFromFile(filename, events, user);
+        }
+        std::cout << "Event or User not found when loading ticket." << std::endl;
     } else {
         std::cout << "Unable to open file: " << filename << std::endl;
     }
+    return nullptr;
 }
 
-std::unique_ptr<Ticket> Ticket::loadFromFile(const std::string& filename,
-                                             const std::vector<std::unique_ptr<Event>>& events,
-                                             const std::vector<std::unique_ptr<User>>& users) {
+Ticket* Ticket::loadFromFile(const std::string& filename,
+                             const std::vector<std::unique_ptr<Event>>& events,
+                             User* user) {
+    return loadFromFile(filename, EventDirectory(events), user);
+}
+
+Ticket* Ticket::loadFromFile(const std::string& filename, const EventDirectory& events, User* user) {
     std::ifstream file(filename);
     if (file.is_open()) {
-        std::string id, eventName, username;
+        std::string idText, eventName, username;
         double price;
         bool isValid;
+        RecordId id;
 
-        std::getline(file, id);
+        std::getline(file, idText);
         std::getline(file, eventName);
         std::getline(file, username);
         file >> price >> isValid;
 
-        auto eventIt = std::find_if(events.begin(), events.end(),
-            [&eventName](const std::unique_ptr<Event>& e) { return e->getName() == eventName; });
-        
-        auto userIt = std::find_if(users.begin(), users.end(),
-            [&username](const std::unique_ptr<User>& u) { return u->getUsername() == username; });
+        Event* event = events.find(eventName);
 
-        if (eventIt != events.end() && userIt != users.end()) {
-            auto ticket = std::unique_ptr<Ticket>(new Ticket(eventIt->get(), userIt->get(), price));
-            ticket->id = id;
-            ticket->isValid = isValid;
-            file.close();
-            std::cout << "Ticket data loaded from file: " << filename << std::endl;
-            return ticket;
+        if (!parseRecordId(idText, "TKT", id)) {
+            std::cout << "Invalid ticket ID in file: " << filename << std::endl;
+        } else if (event != nullptr && user != nullptr) {
+            // Reuse the event's record of this ticket if the event file already restored it
+            Ticket* ticket = event->claimTicket(user, id, price);
+            if (ticket == nullptr) {
+                std::cout << "Duplicate ticket ID in file: " << filename << std::endl;
+            } else {
+                ticket->isValid = isValid;
+                file.close();
+                std::cout << "Ticket data loaded from file: " << filename << std::endl;
+                return ticket;
+            }
         } else {
             std::cout << "Event or User not found when loading ticket." << std::endl;
         }
@@ -88,4 +129,4 @@ std::unique_ptr<Ticket> Ticket::loadFromFile(const std::string& filename,
         std::cout << "Unable to open file: " << filename << std::endl;
     }
     return nullptr;
-}
+}
\ No newline at end of file
@@ -4,37 +4,64 @@
 #include <string>
 #include <memory>
 #include <vector>
+#include <cstdint>
+#include <atomic>
+#include "RecordId.h"
 class Event;
 class User;
+class UserDirectory;
+class EventDirectory;
 
 class Ticket {
+    friend class Snapshot;
+    friend class Event;
+    friend class Journal;
+
 private:
-    std::string id;
+    RecordId id;
     Event* event;
     User* user;
     double price;
     bool isValid;
+    std::atomic<bool> checkedIn; // Admitted at the door
+    std::uint64_t modified; // Generation of the last change, for incremental saves
+
+    static IdSequence ids;
 
-    static int nextId;
+    // True for the first caller only
+    bool markCheckedIn();
 
 public:
     Ticket(Event* event, User* user, double price);
+    // Restores a saved ticket without drawing a new id
+    Ticket(Event* event, User* user, double price, RecordId id, bool isValid);
 
     // Getters
-    const std::string& getId() const { return id; }
+    RecordId getId() const { return id; }
+    std::string getIdString() const { return formatRecordId("TKT", id); }
     Event* getEvent() const { return event; }
     User* getUser() const { return user; }
     double getPrice() const { return price; }
     bool getIsValid() const { return isValid; }
+    bool getCheckedIn() const { return checkedIn.load(); }
+    std::uint64_t getModified() const { return modified; }
 
+    // Cancels through the event, which refunds the buyer, frees the seat and
+    // destroys this ticket: do not use it after a successful cancel
     bool cancel();
     std::string toString() const;
 
     // File I/O operations
-    void saveToFile(const std::string& filename) const;
-    static std::unique_ptr<Ticket> loadFromFile(const std::string& filename, 
-                                                const std::vector<std::unique_ptr<Event>>& events,
-                                                const std::vector<std::unique_ptr<User>>& users);
+    bool saveToFile(const std::string& filename) const;
+    // Loaded tickets are handed back to their event, which owns them
+    static Ticket* loadFromFile(const std::string& filename,
+                                const std::vector<std::unique_ptr<Event>>& events,
+                                const UserDirectory& users);
+    static Ticket* loadFromFile(const std::string& filename,
+                                const std::vector<std::unique_ptr<Event>>& events,
+                                User* user);
+    // For loops over many tickets: build the directory once and pass it in
+    static Ticket* loadFromFile(const std::string& filename, const EventDirectory& events, User* user);
 };
 
 #endif // TICKET_H
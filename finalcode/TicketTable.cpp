@@ -0,0 +1,89 @@
+#include "TicketTable.h"
+#include "Ticket.h"
+#include <algorithm>
+
+TicketTable::TicketTable(std::size_t expectedTickets) : filter(expectedTickets) {}
+
+bool TicketTable::add(Ticket* ticket) {
+    if (!positions.insert(std::make_pair(ticket->getId(), rows.size())).second) {
+        return false;
+    }
+    rows.push_back(ticket);
+    filter.add(ticket->getId());
+    byBuyer.insert(std::make_pair(ticket->getUser(), ticket->getId()));
+    return true;
+}
+
+Ticket* TicketTable::remove(RecordId id) {
+    auto it = positions.find(id);
+    if (it == positions.end()) {
+        return nullptr;
+    }
+    std::size_t position = it->second;
+    Ticket* ticket = rows[position];
+    positions.erase(it);
+    filter.remove(id);
+
+    auto range = byBuyer.equal_range(ticket->getUser());
+    for (auto entry = range.first; entry != range.second; ++entry) {
+        if (entry->second == id) {
+            byBuyer.erase(entry);
+            break;
+        }
+    }
+
+    // Fill the gap with the last ticket
+    if (position + 1 != rows.size()) {
+        rows[position] = rows.back();
+        positions[rows[position]->getId()] = position;
+    }
+    rows.pop_back();
+    return ticket;
+}
+
+void TicketTable::clear() {
+    rows.clear();
+    positions.clear();
+    byBuyer.clear();
+    filter.clear();
+}
+
+void TicketTable::reserve(std::size_t count) {
+    rows.reserve(count);
+    positions.reserve(count);
+    byBuyer.reserve(count);
+}
+
+Ticket* TicketTable::find(RecordId id) const {
+    auto it = positions.find(id);
+    return it != positions.end() ? rows[it->second] : nullptr;
+}
+
+Ticket* TicketTable::findByBuyer(const User* user) const {
+    auto range = byBuyer.equal_range(user);
+    Ticket* earliest = nullptr;
+    std::size_t earliestPosition = 0;
+    for (auto entry = range.first; entry != range.second; ++entry) {
+        std::size_t position = positions.find(entry->second)->second;
+        if (earliest == nullptr || position < earliestPosition) {
+            earliest = rows[position];
+            earliestPosition = position;
+        }
+    }
+    return earliest;
+}
+
+std::vector<Ticket*> TicketTable::findAllByBuyer(const User* user) const {
+    std::vector<std::size_t> found;
+    auto range = byBuyer.equal_range(user);
+    for (auto entry = range.first; entry != range.second; ++entry) {
+        found.push_back(positions.find(entry->second)->second);
+    }
+    std::sort(found.begin(), found.end());
+    std::vector<Ticket*> result;
+    result.reserve(found.size());
+    for (std::size_t position : found) {
+        result.push_back(rows[position]);
+    }
+    return result;
+}
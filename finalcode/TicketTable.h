@@ -0,0 +1,55 @@
+#ifndef TICKET_TABLE_H
+#define TICKET_TABLE_H
+
+#include <vector>
+#include <unordered_map>
+#include <cstddef>
+#include "RecordId.h"
+#include "CountingBloomFilter.h"
+
+class Ticket;
+class User;
+
+// The tickets one event has sold. Adding, finding by ticket id or by buyer and
+// removing are O(1); removal moves the last ticket into the gap, so the order
+// is sale order only until something is removed. The table does not own the
+// tickets and is not synchronized; Event guards it with its registryMutex.
+//
+// A counting Bloom filter over the listed ids lets door check-in turn away
+// unknown and cancelled ids without taking that lock.
+class TicketTable {
+private:
+    std::vector<Ticket*> rows;
+    std::unordered_map<RecordId, std::size_t> positions;
+    std::unordered_multimap<const User*, RecordId> byBuyer; // A buyer may hold several tickets
+    CountingBloomFilter filter;
+
+public:
+    // Sizes the filter; more tickets than expected only raise its false positive rate
+    explicit TicketTable(std::size_t expectedTickets = 0);
+
+    // False if a ticket with the same id is already listed
+    bool add(Ticket* ticket);
+    // The removed ticket, or nullptr if the id is not listed
+    Ticket* remove(RecordId id);
+    void clear();
+    void reserve(std::size_t count);
+
+    // nullptr when there is no such ticket
+    Ticket* find(RecordId id) const;
+    // One of the buyer's tickets; the earliest sold unless removals reordered them
+    Ticket* findByBuyer(const User* user) const;
+    // All of the buyer's tickets, in table order
+    std::vector<Ticket*> findAllByBuyer(const User* user) const;
+    // False only if the id is certainly not listed. Safe without the lock.
+    bool mightContain(RecordId id) const { return filter.mightContain(id); }
+    std::size_t filterBytes() const { return filter.bytes(); }
+
+    std::size_t size() const { return rows.size(); }
+    bool empty() const { return rows.empty(); }
+    const std::vector<Ticket*>& all() const { return rows; }
+    std::vector<Ticket*>::const_iterator begin() const { return rows.begin(); }
+    std::vector<Ticket*>::const_iterator end() const { return rows.end(); }
+};
+
+#endif // TICKET_TABLE_H
@@ -0,0 +1,122 @@
+#include "UsageTracker.h"
+#include <algorithm>
+#include <limits>
+
+namespace {
+    const long long TICKS_PER_DAY =
+        std::chrono::duration_cast<std::chrono::system_clock::duration>(std::chrono::hours(24)).count();
+}
+
+UsageTracker::UsageTracker()
+    : windowStartDay(std::numeric_limits<long long>::min()), laterDaysTotal(0) {}
+
+long long UsageTracker::dayOf(Ticks time) {
+    long long day = time / TICKS_PER_DAY;
+    if (time % TICKS_PER_DAY < 0) {
+        --day;
+    }
+    return day;
+}
+
+void UsageTracker::adjust(const std::chrono::system_clock::time_point& startTime,
+                          const std::chrono::system_clock::time_point& endTime, int sign) {
+    Ticks start = startTime.time_since_epoch().count();
+    Ticks length = (endTime - startTime).count();
+    long long day = dayOf(start);
+
+    if (sign > 0) {
+        Day& bucket = days[day];
+        bucket.bookings.push_back(Booking{ start, length });
+        bucket.total += length;
+    } else {
+        auto it = days.find(day);
+        if (it == days.end()) {
+            return;
+        }
+        std::vector<Booking>& bookings = it->second.bookings;
+        auto match = std::find_if(bookings.begin(), bookings.end(), [&](const Booking& booking) {
+            return booking.start == start && booking.length == length;
+        });
+        if (match == bookings.end()) {
+            return;
+        }
+        *match = bookings.back();
+        bookings.pop_back();
+        it->second.total -= length;
+        if (bookings.empty()) {
+            days.erase(it);
+        }
+    }
+
+    if (day > windowStartDay) {
+        laterDaysTotal += sign * length;
+    }
+}
+
+void UsageTracker::add(const std::chrono::system_clock::time_point& startTime,
+                       const std::chrono::system_clock::time_point& endTime) {
+    adjust(startTime, endTime, 1);
+}
+
+void UsageTracker::remove(const std::chrono::system_clock::time_point& startTime,
+                          const std::chrono::system_clock::time_point& endTime) {
+    adjust(startTime, endTime, -1);
+}
+
+void UsageTracker::clear() {
+    days.clear();
+    windowStartDay = std::numeric_limits<long long>::min();
+    laterDaysTotal = 0;
+}
+
+double UsageTracker::hoursSince(const std::chrono::system_clock::time_point& cutoff) const {
+    Ticks cutoffTicks = cutoff.time_since_epoch().count();
+    long long newStartDay = dayOf(cutoffTicks);
+
+    // Slide the window over only the days between the old and new start day,
+    // unless that is more days than there are buckets to recount
+    if (newStartDay != windowStartDay) {
+        bool recount = windowStartDay == std::numeric_limits<long long>::min() ||
+                       std::max(newStartDay, windowStartDay) - std::min(newStartDay, windowStartDay) >
+                           static_cast<long long>(days.size());
+        if (recount) {
+            laterDaysTotal = 0;
+            for (const auto& entry : days) {
+                if (entry.first > newStartDay) {
+                    laterDaysTotal += entry.second.total;
+                }
+            }
+        } else if (newStartDay > windowStartDay) {
+            for (long long day = windowStartDay + 1; day <= newStartDay; ++day) {
+                auto it = days.find(day);
+                if (it != days.end()) {
+                    laterDaysTotal -= it->second.total;
+                }
+            }
+        } else {
+            for (long long day = newStartDay + 1; day <= windowStartDay; ++day) {
+                auto it = days.find(day);
+                if (it != days.end()) {
+                    laterDaysTotal += it->second.total;
+                }
+            }
+        }
+        windowStartDay = newStartDay;
+    }
+
+    // The day the cutoff falls in counts from the cutoff on
+    Ticks total = laterDaysTotal;
+    auto boundary = days.find(newStartDay);
+    if (boundary != days.end()) {
+        for (const Booking& booking : boundary->second.bookings) {
+            if (booking.start >= cutoffTicks) {
+                total += booking.length;
+            }
+        }
+    }
+    return std::chrono::duration<double, std::ratio<3600>>(std::chrono::system_clock::duration(total)).count();
+}
+
+double UsageTracker::weeklyHours() const {
+    return hoursSince(std::chrono::system_clock::now() - std::chrono::hours(24 * 7));
+}
@@ -0,0 +1,53 @@
+#ifndef USAGE_TRACKER_H
+#define USAGE_TRACKER_H
+
+#include <unordered_map>
+#include <vector>
+#include <chrono>
+
+// Rolling per-user booking counter used for the weekly reservation limits.
+// Booked time is bucketed by the day (UTC, matching Facility's hour checks) its
+// reservation starts on, and a running total is kept for the days after the
+// one holding the current window start. Only that boundary day is summed
+// booking by booking, so the window starts exactly at the cutoff. Moving the
+// window only touches the days it slides over, so a weekly limit check costs
+// O(1) amortized no matter how many reservations a user holds, and adding or
+// removing a booking is a hash lookup plus a scan of its own day.
+class UsageTracker {
+private:
+    typedef std::chrono::system_clock::duration::rep Ticks;
+
+    struct Booking {
+        Ticks start;
+        Ticks length;
+    };
+
+    struct Day {
+        Ticks total = 0;
+        std::vector<Booking> bookings;
+    };
+
+    std::unordered_map<long long, Day> days;
+    mutable long long windowStartDay;
+    mutable Ticks laterDaysTotal; // Booked in the days after windowStartDay
+
+    static long long dayOf(Ticks time);
+    void adjust(const std::chrono::system_clock::time_point& startTime,
+                const std::chrono::system_clock::time_point& endTime, int sign);
+
+public:
+    UsageTracker();
+
+    void add(const std::chrono::system_clock::time_point& startTime,
+             const std::chrono::system_clock::time_point& endTime);
+    void remove(const std::chrono::system_clock::time_point& startTime,
+                const std::chrono::system_clock::time_point& endTime);
+    void clear();
+
+    // Hours booked by reservations starting at or after cutoff.
+    double hoursSince(const std::chrono::system_clock::time_point& cutoff) const;
+    // Hours booked in the seven days leading up to now (and everything after).
+    double weeklyHours() const;
+};
+
+#endif // USAGE_TRACKER_H
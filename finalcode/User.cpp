@@ -2,6 +2,9 @@
 #include "Reservation.h"
 #include "Ticket.h"
 #include "Event.h"
+#include "Journal.h"
+#include "Generation.h"
+#include "EventDirectory.h"
 #include <iostream>
 #include <fstream>
 #include <algorithm>
@@ -9,44 +12,112 @@
 #include <iomanip>
 
 User::User(const std::string& username, const std::string& password, UserType type)
-    : username(username), password(password), type(type), budget(1000.0) {} // Start with $1000 budget
+    : usernameId(SymbolTable::shared().intern(username)), password(password), type(type), budget(1000.0),
+      modified(Generation::next()) {} // Start with $1000 budget
 
 bool User::login(const std::string& inputUsername, const std::string& inputPassword) const {
-    return (inputUsername == username && inputPassword == password);
+    return (inputUsername == getUsername() && inputPassword == password);
 }
 
 bool User::makeReservation(std::unique_ptr<Reservation> reservation) {
     double cost = reservation->getTotalCost();
-    if (budget >= cost) {
-        reservations.push_back(std::move(reservation));
-        budget -= cost;
+    if (deductFromBudget(cost)) {
+        storeReservation(std::move(reservation));
         return true;
     }
     return false;
 }
 
-bool User::cancelReservation(const std::string& reservationId) {
-    auto it = std::find_if(reservations.begin(), reservations.end(),
-        [&reservationId](const std::unique_ptr<Reservation>& res) { return res->getId() == reservationId; });
-    if (it != reservations.end()) {
-        double refundAmount = (*it)->calculateRefund();
+bool User::cancelReservation(RecordId reservationId) {
+    Reservation* reservation = reservations.get(reservationId);
+    if (reservation != nullptr) {
+        double refundAmount = reservation->calculateRefund();
         addToBudget(refundAmount);
-        reservations.erase(it);
+        eraseReservation(*reservation);
         return true;
     }
     return false;
 }
 
-bool User::purchaseTicket(std::unique_ptr<Ticket> ticket) {
-    if (deductFromBudget(ticket->getPrice())) {
-        tickets.push_back(std::move(ticket));
+ReservationHandle User::storeReservation(std::unique_ptr<Reservation> reservation) {
+    return storeReservation(ReservationStore::shared().adopt(std::move(reservation)));
+}
+
+ReservationHandle User::storeReservation(ReservationHandle handle) {
+    ReservationStore& store = ReservationStore::shared();
+    if (!reservations.add(handle)) {
+        store.discardIfUnheld(handle); // Already holding a reservation with this id
+        return ReservationHandle();
+    }
+    const Reservation& stored = *store.get(handle);
+    if (Journal* journal = Journal::active()) {
+        journal->reservationStored(stored);
+    }
+    usage.add(stored.getStartTime(), stored.getEndTime());
+    touch();
+    return handle;
+}
+
+void User::eraseReservation(const Reservation& reservation) {
+    if (Journal* journal = Journal::active()) {
+        journal->reservationErased(reservation);
+    }
+    usage.remove(reservation.getStartTime(), reservation.getEndTime());
+    // Last: the reservation is destroyed here unless another list still holds it
+    reservations.remove(reservation.getId());
+    touch();
+}
+
+void User::touch() {
+    modified.store(Generation::next());
+}
+
+bool User::changedSince(std::uint64_t since) const {
+    if (modified.load() > since) {
         return true;
     }
+    for (const auto& reservation : reservations) {
+        if (reservation->getModified() > since) {
+            return true;
+        }
+    }
+    std::lock_guard<std::mutex> lock(ticketsMutex);
+    for (const Ticket* ticket : tickets) {
+        if (ticket->getModified() > since) {
+            return true;
+        }
+    }
     return false;
 }
 
+bool User::purchaseTicket(Ticket* ticket) {
+    // The event has already charged for the ticket; the user only keeps the handle
+    attachTicket(ticket);
+    return true;
+}
+
+void User::attachTicket(Ticket* ticket) {
+    std::lock_guard<std::mutex> lock(ticketsMutex);
+    tickets.push_back(ticket);
+    touch();
+}
+
+void User::releaseTicket(const Ticket* ticket) {
+    std::lock_guard<std::mutex> lock(ticketsMutex);
+    auto it = std::find(tickets.begin(), tickets.end(), ticket);
+    if (it != tickets.end()) {
+        tickets.erase(it);
+        touch();
+    }
+}
+
+bool User::holdsTicket(const Ticket* ticket) const {
+    std::lock_guard<std::mutex> lock(ticketsMutex);
+    return std::find(tickets.begin(), tickets.end(), ticket) != tickets.end();
+}
+
 void User::viewSchedule() const {
-    std::cout << "Schedule for " << username << ":" << std::endl;
+    std::cout << "Schedule for " << getUsername() << ":" << std::endl;
     if (reservations.empty()) {
         std::cout << "No reservations scheduled." << std::endl;
     } else {
@@ -55,6 +126,7 @@ void User::viewSchedule() const {
         }
     }
     
+    std::lock_guard<std::mutex> lock(ticketsMutex);
     if (tickets.empty()) {
         std::cout << "No tickets purchased." << std::endl;
     } else {
@@ -66,29 +138,41 @@ void User::viewSchedule() const {
 }
 
 void User::addToBudget(double amount) {
-    budget += amount;
+    double current = budget.load();
+    while (!budget.compare_exchange_weak(current, current + amount)) {
+    }
+    touch();
+    if (Journal* journal = Journal::active()) {
+        journal->budgetChanged(*this, amount);
+    }
 }
 
 bool User::deductFromBudget(double amount) {
-    if (budget >= amount) {
-        budget -= amount;
-        return true;
+    double current = budget.load();
+    do {
+        if (current < amount) {
+            return false;
+        }
+    } while (!budget.compare_exchange_weak(current, current - amount));
+    touch();
+    if (Journal* journal = Journal::active()) {
+        journal->budgetChanged(*this, -amount);
     }
-    return false;
+    return true;
 }
 
-void User::saveToFile(const std::string& filename) const {
+bool User::saveToFile(const std::string& filename) const {
     std::ofstream file(filename);
     if (file.is_open()) {
-        file << username << std::endl;
+        file << getUsername() << std::endl;
         file << password << std::endl;
         file << static_cast<int>(type) << std::endl;
-        file << budget << std::endl;
+        file << budget.load() << std::endl;
 
         // Save reservations
         file << reservations.size() << std::endl;
         for (const auto& reservation : reservations) {
-            file << reservation->getId() << std::endl;
+            file << reservation->getIdString() << std::endl;
             file << reservation->getStartTime().time_since_epoch().count() << std::endl;
             file << reservation->getEndTime().time_since_epoch().count() << std::endl;
             file << static_cast<int>(reservation->getLayoutStyle()) << std::endl;
@@ -96,61 +180,124 @@ void User::saveToFile(const std::string& filename) const {
         }
 
         // Save tickets
+        std::lock_guard<std::mutex> lock(ticketsMutex);
         file << tickets.size() << std::endl;
         for (const auto& ticket : tickets) {
             file << ticket->getEvent()->getName() << std::endl;
             file << ticket->getPrice() << std::endl;
+            file << ticket->getIdString() << std::endl;
         }
 
         file.close();
         std::cout << "User data saved to file: " << filename << std::endl;
+        return true;
     } else {
         std::cout << "Unable to open file: " << filename << std::endl;
+        return false;
+    }
+}
+
+// The base format keeps everything in one file, so any change rewrites it
+std::size_t User::saveChanged(const std::string& filename, std::uint64_t since, std::size_t& failed) const {
+    if (!changedSince(since)) {
+        return 0;
+    }
+    if (!saveToFile(filename)) {
+        ++failed;
+        return 0;
     }
+    return 1;
+}
+
+std::size_t User::saveRecordFiles(const std::string& filename, std::uint64_t since, std::size_t& failed) const {
+    std::size_t written = 0;
+    for (const auto& reservation : reservations) {
+        if (reservation->getModified() > since) {
+            if (reservation->saveToFile(filename + "_" + reservation->getIdString())) {
+                ++written;
+            } else {
+                ++failed;
+            }
+        }
+    }
+    std::lock_guard<std::mutex> lock(ticketsMutex);
+    for (const Ticket* ticket : tickets) {
+        if (ticket->getModified() > since) {
+            if (ticket->saveToFile(filename + "_" + ticket->getIdString())) {
+                ++written;
+            } else {
+                ++failed;
+            }
+        }
+    }
+    return written;
 }
 
 void User::loadFromFile(const std::string& filename, const std::vector<std::unique_ptr<Event>>& events) {
     std::ifstream file(filename);
     if (file.is_open()) {
-        file >> username;
+        std::string savedUsername;
+        file >> savedUsername;
+        usernameId = SymbolTable::shared().intern(savedUsername);
         file >> password;
         int typeInt;
         file >> typeInt;
         type = static_cast<UserType>(typeInt);
-        file >> budget;
+        double savedBudget;
+        file >> savedBudget;
+        budget = savedBudget;
 
         // Load reservations
         size_t reservationCount;
         file >> reservationCount;
         reservations.clear();
+        usage.clear();
         for (size_t i = 0; i < reservationCount; ++i) {
-            std::string id;
+            std::string idText;
             long long startTime, endTime;
             int layoutStyleInt;
             bool isPublic;
-            file >> id >> startTime >> endTime >> layoutStyleInt >> isPublic;
+            file >> idText >> startTime >> endTime >> layoutStyleInt >> isPublic;
+            RecordId id;
+            if (!parseRecordId(idText, "RES", id)) {
+                std::cout << "Invalid reservation ID in file: " << filename << std::endl;
+                continue;
+            }
             auto start = std::chrono::system_clock::time_point(std::chrono::system_clock::duration(startTime));
             auto end = std::chrono::system_clock::time_point(std::chrono::system_clock::duration(endTime));
-            reservations.push_back(std::unique_ptr<Reservation>(new Reservation(this, start, end, static_cast<LayoutStyle>(layoutStyleInt), isPublic)));
-            reservations.back()->setId(id);
+            std::unique_ptr<Reservation> reservation(new Reservation(this, start, end, static_cast<LayoutStyle>(layoutStyleInt), isPublic));
+            reservation->setId(id);
+            storeReservation(std::move(reservation));
         }
 
         // Load tickets
         size_t ticketCount;
         file >> ticketCount;
-        tickets.clear();
+        {
+            std::lock_guard<std::mutex> lock(ticketsMutex);
+            tickets.clear();
+        }
+        EventDirectory directory(events);
         for (size_t i = 0; i < ticketCount; ++i) {
-            std::string eventName;
+            std::string eventName, idText;
             double price;
-            file >> eventName >> price;
-            auto it = std::find_if(events.begin(), events.end(),
-                [&eventName](const std::unique_ptr<Event>& e) { return e->getName() == eventName; });
-            if (it != events.end()) {
-                tickets.push_back(std::unique_ptr<Ticket>(new Ticket(it->get(), this, price)));
+            RecordId id;
+            file >> eventName >> price >> idText;
+            if (!parseRecordId(idText, "TKT", id)) {
+                std::cout << "Invalid ticket ID in file: " << filename << std::endl;
+                continue;
+            }
+            // A name never interned matches no event
+            if (Event* event = directory.find(eventName)) {
+                Ticket* ticket = event->claimTicket(this, id, price);
+                if (ticket != nullptr && !holdsTicket(ticket)) {
+                    attachTicket(ticket);
+                }
             }
         }
 
         file.close();
+        touch();
         std::cout << "User data loaded from file: " << filename << std::endl;
     } else {
         std::cout << "Unable to open file: " << filename << std::endl;
@@ -159,7 +306,7 @@ void User::loadFromFile(const std::string& filename, const std::vector<std::uniq
 
 void User::displayUserInfo() const {
     std::cout << "User Information:" << std::endl;
-    std::cout << "Username: " << username << std::endl;
+    std::cout << "Username: " << getUsername() << std::endl;
     std::cout << "User Type: ";
     switch (type) {
         case UserType::Resident:
@@ -176,6 +323,6 @@ void User::displayUserInfo() const {
             break;
     }
     std::cout << std::endl;
-    std::cout << "Budget: $" << std::fixed << std::setprecision(2) << budget << std::endl;
+    std::cout << "Budget: $" << std::fixed << std::setprecision(2) << budget.load() << std::endl;
     viewSchedule();
 }
\ No newline at end of file
@@ -5,8 +5,15 @@
 #include <vector>
 #include <memory>
 #include <chrono>
+#include <atomic>
+#include <mutex>
+#include <cstdint>
+#include <cstddef>
+#include "UsageTracker.h"
+#include "RecordId.h"
+#include "ReservationStore.h"
+#include "SymbolTable.h"
 
-class Reservation;
 class Ticket;
 class Event;
 
@@ -18,13 +25,30 @@ enum class UserType {
 };
 
 class User {
+    friend class Snapshot;
+    friend class Journal;
+
 protected:
-    std::string username;
+    SymbolId usernameId; // Interned in SymbolTable::shared()
     std::string password;
     UserType type;
-    double budget;
-    std::vector<std::unique_ptr<Reservation>> reservations;
-    std::vector<std::unique_ptr<Ticket>> tickets;
+    std::atomic<double> budget; // Updated lock-free so concurrent ticket sales can charge safely
+    ReservationList reservations;
+    std::vector<Ticket*> tickets; // Handles to tickets owned by their Event
+    mutable std::mutex ticketsMutex; // Guards tickets: events attach and release them from selling threads
+    UsageTracker usage; // Booked hours across this user's reservations
+    std::atomic<std::uint64_t> modified; // Generation of the last change to the user's own fields or lists
+
+    // Keep the reservation list and its usage counter in step
+    ReservationHandle storeReservation(std::unique_ptr<Reservation> reservation);
+    // Same for a reservation already in the store; an unheld one is discarded if refused
+    ReservationHandle storeReservation(ReservationHandle handle);
+    void eraseReservation(const Reservation& reservation);
+    void touch();
+    // Writes the per-record files kept next to an index file (filename + "_" + id)
+    // for reservations and tickets changed after 'since'. Returns files written
+    // and adds the ones that could not be written to 'failed'.
+    std::size_t saveRecordFiles(const std::string& filename, std::uint64_t since, std::size_t& failed) const;
 
 public:
     User(const std::string& username, const std::string& password, UserType type);
@@ -32,21 +56,37 @@ public:
 
     bool login(const std::string& inputUsername, const std::string& inputPassword) const;
     virtual bool makeReservation(std::unique_ptr<Reservation> reservation);
-    virtual bool cancelReservation(const std::string& reservationId);
-    virtual bool purchaseTicket(std::unique_ptr<Ticket> ticket);
+    virtual bool cancelReservation(RecordId reservationId);
+    virtual bool purchaseTicket(Ticket* ticket);
     virtual void viewSchedule() const;
     void addToBudget(double amount);
     bool deductFromBudget(double amount);
+    void attachTicket(Ticket* ticket);
+    void releaseTicket(const Ticket* ticket);
+    bool holdsTicket(const Ticket* ticket) const;
 
     // Getters
-    const std::string& getUsername() const { return username; }
+    const std::string& getUsername() const { return SymbolTable::shared().name(usernameId); }
+    SymbolId getUsernameId() const { return usernameId; }
     UserType getType() const { return type; }
-    double getBudget() const { return budget; }
-    const std::vector<std::unique_ptr<Reservation>>& getReservations() const { return reservations; }
+    double getBudget() const { return budget.load(); }
+    const ReservationList& getReservations() const { return reservations; }
+    double getWeeklyHours() const { return usage.weeklyHours(); }
+    // Unguarded: only while no tickets are being sold or cancelled
+    const std::vector<Ticket*>& getTickets() const { return tickets; }
+    std::uint64_t getModified() const { return modified.load(); }
+    // True if the user or any of its reservations or tickets changed after 'since'
+    bool changedSince(std::uint64_t since) const;
 
     // File operations
-    virtual void saveToFile(const std::string& filename) const;
+    // Returns false if any file could not be written
+    virtual bool saveToFile(const std::string& filename) const;
     virtual void loadFromFile(const std::string& filename, const std::vector<std::unique_ptr<Event>>& events);
+    // Writes only what changed after generation 'since'; returns the number of
+    // files written and adds any that could not be written to 'failed'.
+    // Subclasses keep an index file plus one file per record, so they rewrite
+    // the index only when the user itself changed.
+    virtual std::size_t saveChanged(const std::string& filename, std::uint64_t since, std::size_t& failed) const;
 
     // New method
     virtual void displayUserInfo() const;
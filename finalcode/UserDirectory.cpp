@@ -0,0 +1,28 @@
+#include "UserDirectory.h"
+#include "User.h"
+
+UserDirectory::UserDirectory() : count(0) {}
+
+UserDirectory::UserDirectory(const std::vector<std::unique_ptr<User>>& users) : count(0) {
+    bySymbol.reserve(SymbolTable::shared().size());
+    for (const auto& user : users) {
+        add(user.get());
+    }
+}
+
+bool UserDirectory::add(User* user) {
+    SymbolId id = user->getUsernameId();
+    if (id >= bySymbol.size()) {
+        bySymbol.resize(id + 1, nullptr);
+    }
+    if (bySymbol[id] != nullptr) {
+        return false;
+    }
+    bySymbol[id] = user;
+    ++count;
+    return true;
+}
+
+User* UserDirectory::find(StringRef username) const {
+    return find(SymbolTable::shared().find(username));
+}
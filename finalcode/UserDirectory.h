@@ -0,0 +1,37 @@
+#ifndef USER_DIRECTORY_H
+#define USER_DIRECTORY_H
+
+#include <vector>
+#include <memory>
+#include <cstddef>
+#include "StringRef.h"
+#include "SymbolTable.h"
+
+class User;
+
+// Finds users by username in O(1) instead of scanning the user list.
+//
+// Users are filed under their username's SymbolId, so a lookup by id is an
+// array index and a lookup by name is one probe of the SymbolTable. The
+// directory does not own the users; users created after it was built have to
+// be add()ed.
+class UserDirectory {
+private:
+    std::vector<User*> bySymbol; // nullptr where no user has the name
+    std::size_t count;
+
+public:
+    UserDirectory();
+    explicit UserDirectory(const std::vector<std::unique_ptr<User>>& users);
+
+    // False if the name is taken; as with the old scans, the first user keeps it
+    bool add(User* user);
+    User* find(SymbolId username) const {
+        return username < bySymbol.size() ? bySymbol[username] : nullptr;
+    }
+    User* find(StringRef username) const;
+
+    std::size_t size() const { return count; }
+};
+
+#endif // USER_DIRECTORY_H
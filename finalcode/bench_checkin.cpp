@@ -0,0 +1,138 @@
+// Door check-in throughput.
+//
+// Sells one ticket per attendee for a single large event and cancels a tenth
+// of them, then replays a scan stream through Event::checkIn from several
+// scanner threads at once. The stream holds every valid ticket once, a share
+// of repeat scans of valid tickets, the cancelled tickets, and forged ids that
+// were never sold, in shuffled order. Every valid ticket must be admitted
+// exactly once; repeats, cancelled and forged ids never. Also reports how many
+// bad ids the ticket filter turned away without a table lookup.
+//
+// Usage: ./checkin_bench [tickets] [scannerThreads] [repeatPercent] [forgedPercent]
+
+#include <iostream>
+#include <streambuf>
+#include <vector>
+#include <memory>
+#include <string>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <random>
+#include <algorithm>
+#include <cstdlib>
+#include "Resident.h"
+#include "Event.h"
+#include "Ticket.h"
+#include "BenchSupport.h"
+
+int main(int argc, char* argv[]) {
+    int ticketCount = argc > 1 ? std::atoi(argv[1]) : 100000;
+    unsigned hardwareThreads = std::thread::hardware_concurrency();
+    int threadCount = argc > 2 ? std::atoi(argv[2]) : static_cast<int>(hardwareThreads > 0 ? hardwareThreads : 4);
+    int repeatPercent = argc > 3 ? std::atoi(argv[3]) : 20;
+    int forgedPercent = argc > 4 ? std::atoi(argv[4]) : 50;
+    if (ticketCount < 10) {
+        ticketCount = 10;
+    }
+    if (threadCount < 1) {
+        threadCount = 1;
+    }
+
+    NullBuffer discard;
+    std::streambuf* original = std::cout.rdbuf(&discard);
+
+    std::vector<std::unique_ptr<User>> users;
+    Resident organizer("door_organizer", "pw");
+    Event event("Door Gala", "Synthetic event", &organizer, 10.0, ticketCount, true, true, true);
+    std::vector<RecordId> valid, cancelled;
+    RecordId highestId = 0;
+    for (int i = 0; i < ticketCount; ++i) {
+        users.push_back(std::unique_ptr<User>(new Resident("attendee" + std::to_string(i), "pw")));
+        users.back()->addToBudget(10.0);
+        if (Ticket* ticket = event.purchaseTicket(users.back().get())) {
+            users.back()->attachTicket(ticket);
+            highestId = std::max(highestId, ticket->getId());
+            if (i % 10 == 0) {
+                cancelled.push_back(ticket->getId());
+                event.cancelTicket(ticket);
+            } else {
+                valid.push_back(ticket->getId());
+            }
+        }
+    }
+
+    std::mt19937_64 random(42);
+    std::vector<RecordId> stream(valid);
+    std::uniform_int_distribution<size_t> pickValid(0, valid.size() - 1);
+    for (size_t i = 0; i < valid.size() * repeatPercent / 100; ++i) {
+        stream.push_back(valid[pickValid(random)]);
+    }
+    stream.insert(stream.end(), cancelled.begin(), cancelled.end());
+    std::uniform_int_distribution<RecordId> pickForged(highestId + 1, highestId + 1000000000ULL);
+    size_t forgedCount = valid.size() * forgedPercent / 100;
+    for (size_t i = 0; i < forgedCount; ++i) {
+        stream.push_back(pickForged(random));
+    }
+    std::shuffle(stream.begin(), stream.end(), random);
+
+    std::atomic<int> counts[5];
+    for (auto& count : counts) {
+        count.store(0);
+    }
+    std::atomic<bool> start(false);
+    std::vector<std::thread> scanners;
+    for (int t = 0; t < threadCount; ++t) {
+        scanners.emplace_back([&, t]() {
+            int local[5] = { 0, 0, 0, 0, 0 };
+            while (!start.load()) {
+                std::this_thread::yield();
+            }
+            for (size_t i = t; i < stream.size(); i += threadCount) {
+                ++local[static_cast<int>(event.checkIn(stream[i]))];
+            }
+            for (int r = 0; r < 5; ++r) {
+                counts[r].fetch_add(local[r]);
+            }
+        });
+    }
+    auto begin = std::chrono::steady_clock::now();
+    start.store(true);
+    for (std::thread& scanner : scanners) {
+        scanner.join();
+    }
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+
+    // A second pass over one ticket in string form, as a scanner would present it
+    bool repeatRefused = event.checkIn(formatRecordId("TKT", valid[0])) == CheckInResult::AlreadyCheckedIn;
+
+    std::cout.rdbuf(original);
+
+    int admitted = counts[static_cast<int>(CheckInResult::Admitted)].load();
+    int repeats = counts[static_cast<int>(CheckInResult::AlreadyCheckedIn)].load();
+    int unknown = counts[static_cast<int>(CheckInResult::Unknown)].load();
+    int filtered = counts[static_cast<int>(CheckInResult::Filtered)].load();
+    int bad = unknown + filtered;
+    bool allCheckedIn = true;
+    for (const Ticket* ticket : event.getTickets()) {
+        allCheckedIn = allCheckedIn && ticket->getCheckedIn();
+    }
+
+    std::cout << "Scans: " << stream.size() << " (" << valid.size() << " valid, " << stream.size() - valid.size() - cancelled.size() - forgedCount
+              << " repeats, " << cancelled.size() << " cancelled, " << forgedCount << " forged) on "
+              << threadCount << " scanner threads" << std::endl;
+    std::cout << "Throughput: " << static_cast<long long>(stream.size() / elapsed) << " scans/s ("
+              << elapsed * 1e9 / stream.size() << " ns/scan)" << std::endl;
+    std::cout << "Admitted " << admitted << ", refused as repeats " << repeats << ", bad ids " << bad
+              << " of which the filter turned away " << filtered << " ("
+              << (bad > 0 ? 100.0 * filtered / bad : 100.0) << "%)" << std::endl;
+
+    bool ok = admitted == static_cast<int>(valid.size()) &&
+              repeats == static_cast<int>(stream.size() - valid.size() - cancelled.size() - forgedCount) &&
+              bad == static_cast<int>(cancelled.size() + forgedCount) &&
+              counts[static_cast<int>(CheckInResult::Cancelled)].load() == 0 &&
+              allCheckedIn && repeatRefused && filtered * 100 >= bad * 98;
+    std::cout << (ok ? "PASS: every valid ticket admitted once, every bad id refused"
+                     : "FAIL: check-in admitted or refused the wrong tickets") << std::endl;
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,119 @@
+// Times "which rooms are free?" across a large pool of rooms, checked on one
+// thread and fanned out across threads.
+//
+// Builds rooms of mixed sizes, opening hours and layouts, books each one for
+// random hours over a month, then for random one- or two-hour windows runs
+// FacilityPool::freeRooms and FacilityPool::bestRoom on a single-threaded pool
+// and on a pool that splits the rooms across threads. Both must give the same
+// rooms; every room returned must really be free and, for bestRoom, no free
+// room that fits may be smaller.
+//
+// Usage: ./facility_pool_bench [rooms] [bookingsPerRoom] [queries] [threads]
+
+#include <iostream>
+#include <vector>
+#include <memory>
+#include <string>
+#include <chrono>
+#include <random>
+#include <thread>
+#include <cstdlib>
+#include "Resident.h"
+#include "Reservation.h"
+#include "Facility.h"
+#include "FacilityPool.h"
+#include "BenchSupport.h"
+
+struct Query {
+    std::chrono::system_clock::time_point start;
+    std::chrono::system_clock::time_point end;
+    int guests;
+    LayoutStyle layout;
+};
+
+void build(FacilityPool& pool, int roomCount, int bookingsPerRoom, User* owner) {
+    typedef std::chrono::system_clock Clock;
+    const Clock::time_point base = Clock::from_time_t(1704067200); // 2024-01-01 00:00 UTC
+    std::mt19937 random(7);
+    const int capacities[] = { 10, 20, 40, 80, 150 };
+    for (int r = 0; r < roomCount; ++r) {
+        int opening = 7 + r % 3;
+        if (r % 4 == 0) {
+            pool.addRoom("Room " + std::to_string(r), opening, 23, capacities[r % 5], { LayoutStyle::Meeting, LayoutStyle::Lecture });
+        } else {
+            pool.addRoom("Room " + std::to_string(r), opening, 23, capacities[r % 5]);
+        }
+        std::uniform_int_distribution<int> pickDay(0, 29), pickHour(opening, 21);
+        for (int b = 0; b < bookingsPerRoom; ++b) {
+            Clock::time_point start = base + std::chrono::hours(24 * pickDay(random) + pickHour(random));
+            pool.room(r).addReservation(std::unique_ptr<Reservation>(new Reservation(
+                owner, start, start + std::chrono::hours(1), LayoutStyle::Meeting, true)));
+        }
+    }
+}
+
+int main(int argc, char* argv[]) {
+    int roomCount = argc > 1 ? std::atoi(argv[1]) : 4096;
+    int bookingsPerRoom = argc > 2 ? std::atoi(argv[2]) : 200;
+    int queryCount = argc > 3 ? std::atoi(argv[3]) : 500;
+    unsigned hardwareThreads = std::thread::hardware_concurrency();
+    unsigned threadCount = argc > 4 ? static_cast<unsigned>(std::atoi(argv[4])) : (hardwareThreads > 1 ? hardwareThreads : 4);
+    if (roomCount < 1) {
+        roomCount = 1;
+    }
+
+    Resident owner("pool_owner", "pw");
+    FacilityPool serial(1), parallel(threadCount, 0);
+    build(serial, roomCount, bookingsPerRoom, &owner);
+    build(parallel, roomCount, bookingsPerRoom, &owner);
+
+    typedef std::chrono::system_clock Clock;
+    const Clock::time_point base = Clock::from_time_t(1704067200);
+    std::mt19937 random(42);
+    std::uniform_int_distribution<int> pickDay(0, 29), pickHour(8, 20), pickLength(1, 2), pickGuests(5, 120), pickLayout(0, 3);
+    std::vector<Query> queries;
+    for (int i = 0; i < queryCount; ++i) {
+        Clock::time_point start = base + std::chrono::hours(24 * pickDay(random) + pickHour(random));
+        queries.push_back(Query{ start, start + std::chrono::hours(pickLength(random)), pickGuests(random),
+                                 static_cast<LayoutStyle>(pickLayout(random)) });
+    }
+
+    std::vector<std::vector<std::size_t>> serialFree(queries.size()), parallelFree(queries.size());
+    std::vector<std::size_t> serialBest(queries.size()), parallelBest(queries.size());
+    double serialTime = timeIt([&]() {
+        for (size_t q = 0; q < queries.size(); ++q) {
+            serialFree[q] = serial.freeRooms(queries[q].start, queries[q].end);
+            serialBest[q] = serial.bestRoom(queries[q].start, queries[q].end, queries[q].guests, queries[q].layout);
+        }
+    });
+    double parallelTime = timeIt([&]() {
+        for (size_t q = 0; q < queries.size(); ++q) {
+            parallelFree[q] = parallel.freeRooms(queries[q].start, queries[q].end);
+            parallelBest[q] = parallel.bestRoom(queries[q].start, queries[q].end, queries[q].guests, queries[q].layout);
+        }
+    });
+
+    bool valid = serialFree == parallelFree && serialBest == parallelBest;
+    std::size_t freeTotal = 0;
+    for (size_t q = 0; q < queries.size() && valid; ++q) {
+        freeTotal += serialFree[q].size();
+        for (std::size_t room : serialFree[q]) {
+            valid = valid && serial.room(room).isAvailable(queries[q].start, queries[q].end);
+        }
+        std::size_t best = serialBest[q];
+        for (std::size_t room : serialFree[q]) {
+            bool fits = serial.supportsLayout(room, queries[q].layout) && serial.room(room).getMaxCapacity() >= queries[q].guests;
+            valid = valid && (!fits || (best != FacilityPool::NO_ROOM &&
+                                        serial.room(best).getMaxCapacity() <= serial.room(room).getMaxCapacity()));
+        }
+    }
+
+    std::cout << "Rooms: " << roomCount << ", bookings/room: " << bookingsPerRoom << ", queries: " << queryCount
+              << ", free rooms/query: " << (queries.empty() ? 0 : freeTotal / queries.size()) << std::endl;
+    std::cout << "One thread:  " << serialTime * 1000 / queryCount << " us/query" << std::endl;
+    std::cout << threadCount << " threads:   " << parallelTime * 1000 / queryCount << " us/query ("
+              << serialTime / parallelTime << "x; " << hardwareThreads << " hardware threads)" << std::endl;
+    std::cout << (valid ? "PASS: fan-out finds the same free and best rooms"
+                        : "FAIL: room search results disagree") << std::endl;
+    return valid ? 0 : 1;
+}
@@ -0,0 +1,177 @@
+// Compares ways of finding the next free windows of a given length on a dense
+// schedule.
+//
+// Fills a year of opening hours with back-to-back bookings of one to three
+// hours, leaving a short gap before a booking now and then, then asks for the
+// next five two-hour windows after random times with:
+//   - pointer probe:   every quarter hour from the start time, the hour rule
+//                      plus Reservation::overlaps over every booking
+//   - isAvailable:     every quarter hour, Facility::isAvailable
+//   - findFreeSlots:   Facility::findFreeSlots, which jumps from gap to gap
+//                      through the ordered schedule columns
+// Every method must suggest the same windows.
+//
+// Usage: ./free_slots_bench [days] [gapPercent] [queries]
+
+#include <iostream>
+#include <vector>
+#include <memory>
+#include <string>
+#include <chrono>
+#include <random>
+#include <cstdlib>
+#include <cstdint>
+#include "Resident.h"
+#include "Reservation.h"
+#include "Facility.h"
+#include "BenchSupport.h"
+
+typedef std::chrono::system_clock Clock;
+
+// Quarter-hour probing, as a caller without findFreeSlots would do it
+template<typename IsFree>
+std::vector<TimeWindow> probe(const Facility& facility, Clock::time_point after, Clock::duration duration,
+                              std::size_t count, IsFree isFree) {
+    const Clock::duration slot = std::chrono::minutes(15);
+    const Clock::duration day = std::chrono::hours(24);
+    std::vector<TimeWindow> found;
+    Clock::time_point start = Clock::time_point((after.time_since_epoch() + slot - Clock::duration(1)) / slot * slot);
+    Clock::time_point horizon = start + day * 366;
+    while (found.size() < count && start < horizon) {
+        Clock::time_point midnight = Clock::time_point(start.time_since_epoch() / day * day);
+        Clock::time_point end = start + duration;
+        if (start >= midnight + std::chrono::hours(facility.getOpeningHour()) &&
+            end <= midnight + std::chrono::hours(facility.getClosingHour()) && isFree(start, end)) {
+            found.push_back(TimeWindow{ start, end });
+            start = end;
+        } else {
+            start += slot;
+        }
+    }
+    return found;
+}
+
+bool sameWindows(const std::vector<std::vector<TimeWindow>>& a, const std::vector<std::vector<TimeWindow>>& b) {
+    if (a.size() != b.size()) {
+        return false;
+    }
+    for (std::size_t q = 0; q < a.size(); ++q) {
+        if (a[q].size() != b[q].size()) {
+            return false;
+        }
+        for (std::size_t i = 0; i < a[q].size(); ++i) {
+            if (a[q][i].start != b[q][i].start || a[q][i].end != b[q][i].end) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+int main(int argc, char* argv[]) {
+    int dayCount = argc > 1 ? std::atoi(argv[1]) : 365;
+    int gapPercent = argc > 2 ? std::atoi(argv[2]) : 10;
+    int queryCount = argc > 3 ? std::atoi(argv[3]) : 20;
+    if (dayCount < 1) {
+        dayCount = 1;
+    }
+
+    const Clock::time_point base = Clock::from_time_t(1704067200); // 2024-01-01
+    const std::size_t suggestions = 5;
+    const Clock::duration length = std::chrono::hours(2);
+    std::mt19937 random(42);
+    std::uniform_int_distribution<int> percent(0, 99);
+    std::uniform_int_distribution<int> quarters(1, 4);
+
+    Resident owner("bench_owner", "pw");
+    Facility facility;
+    std::vector<std::unique_ptr<Reservation>> reservations;
+    RecordId nextId = 1;
+    for (int d = 0; d < dayCount; ++d) {
+        Clock::time_point midnight = base + std::chrono::hours(24 * d);
+        Clock::time_point cursor = midnight + std::chrono::hours(facility.getOpeningHour());
+        Clock::time_point closing = midnight + std::chrono::hours(facility.getClosingHour());
+        while (true) {
+            if (percent(random) < gapPercent) {
+                cursor += std::chrono::minutes(15 * quarters(random));
+            }
+            Clock::time_point end = cursor + std::chrono::minutes(60 + 30 * (quarters(random) - 1));
+            if (end > closing) {
+                break;
+            }
+            // The facility takes its own copy; the vector is the baseline's
+            reservations.push_back(std::unique_ptr<Reservation>(new Reservation(
+                &owner, cursor, end, LayoutStyle::Meeting, true, nextId, true, 0.0)));
+            facility.addReservation(std::unique_ptr<Reservation>(new Reservation(
+                &owner, cursor, end, LayoutStyle::Meeting, true, nextId, true, 0.0)));
+            ++nextId;
+            cursor = end;
+        }
+    }
+
+    std::vector<Clock::time_point> queries;
+    std::uniform_int_distribution<int> pick(0, dayCount * 24 * 4 - 1);
+    for (int i = 0; i < queryCount; ++i) {
+        queries.push_back(base + std::chrono::minutes(15 * pick(random)) + std::chrono::minutes(random() % 15));
+    }
+
+    std::vector<std::vector<TimeWindow>> expected(queries.size());
+    double pointerTime = timeIt([&]() {
+        for (std::size_t q = 0; q < queries.size(); ++q) {
+            expected[q] = probe(facility, queries[q], length, suggestions,
+                                [&](Clock::time_point start, Clock::time_point end) {
+                // The hour rule of Facility::isAvailable
+                auto startHour = std::chrono::duration_cast<std::chrono::hours>(start.time_since_epoch()).count() % 24;
+                auto endHour = std::chrono::duration_cast<std::chrono::hours>(end.time_since_epoch()).count() % 24;
+                if (startHour >= endHour) {
+                    return false;
+                }
+                for (const auto& reservation : reservations) {
+                    if (reservation->overlaps(start, end)) {
+                        return false;
+                    }
+                }
+                return true;
+            });
+        }
+    });
+
+    std::vector<std::vector<TimeWindow>> probed(queries.size());
+    double availableTime = timeIt([&]() {
+        for (std::size_t q = 0; q < queries.size(); ++q) {
+            probed[q] = probe(facility, queries[q], length, suggestions,
+                              [&](Clock::time_point start, Clock::time_point end) {
+                return facility.isAvailable(start, end);
+            });
+        }
+    });
+
+    std::vector<std::vector<TimeWindow>> found(queries.size());
+    double findTime = timeIt([&]() {
+        for (std::size_t q = 0; q < queries.size(); ++q) {
+            found[q] = facility.findFreeSlots(queries[q], length, suggestions, LayoutStyle::Meeting);
+        }
+    });
+
+    std::size_t windows = 0;
+    for (const auto& list : expected) {
+        windows += list.size();
+    }
+    std::cout << "Days: " << dayCount << ", bookings: " << reservations.size() << ", queries: " << queryCount
+              << ", windows suggested: " << windows << std::endl;
+    std::cout << "Pointer probe:  " << pointerTime / queryCount << " ms/query" << std::endl;
+    std::cout << "isAvailable:    " << availableTime / queryCount << " ms/query ("
+              << pointerTime / availableTime << "x faster)" << std::endl;
+    std::cout << "findFreeSlots:  " << findTime / queryCount << " ms/query ("
+              << pointerTime / findTime << "x faster, " << availableTime / findTime << "x over isAvailable)" << std::endl;
+
+    // A room that cannot be set up for a dance suggests nothing for one
+    Facility meetingRoom(8, 23, 20, { LayoutStyle::Meeting, LayoutStyle::Lecture });
+    bool layouts = meetingRoom.findFreeSlots(base, length, suggestions, LayoutStyle::Dance).empty() &&
+                   meetingRoom.findFreeSlots(base, length, suggestions, LayoutStyle::Lecture).size() == suggestions;
+
+    bool ok = sameWindows(expected, probed) && sameWindows(expected, found) && layouts;
+    std::cout << (ok ? "PASS: every method suggests the same free windows"
+                     : "FAIL: findFreeSlots disagrees with probing the schedule") << std::endl;
+    return ok ? 0 : 1;
+}
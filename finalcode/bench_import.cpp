@@ -0,0 +1,228 @@
+// Compares the bulk importer with the line-by-line stream loaders it replaced.
+//
+// Writes a large users.txt and events.txt (every event row with start and end
+// times, a few rows deliberately broken), then loads them with the old
+// getline/istringstream loop, with the importer on one thread and on all
+// threads. The importer must load the same rows and report every broken one at
+// its line number.
+//
+// Usage: ./import_bench [users] [events] [threads] [dataDir]
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <streambuf>
+#include <vector>
+#include <memory>
+#include <string>
+#include <thread>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <ctime>
+#include <sys/stat.h>
+#include "User.h"
+#include "Resident.h"
+#include "NonResident.h"
+#include "CityUser.h"
+#include "Organization.h"
+#include "Reservation.h"
+#include "Event.h"
+#include "Ticket.h"
+#include "BulkImporter.h"
+#include "BenchSupport.h"
+
+std::chrono::system_clock::time_point streamTimePoint(const std::string& timeStr) {
+    std::tm tm = {};
+    std::istringstream ss(timeStr);
+    ss >> std::get_time(&tm, "%Y-%m-%d %H:%M");
+    return std::chrono::system_clock::from_time_t(std::mktime(&tm));
+}
+
+// The loaders main.cpp used before, extended only to read the event times
+void streamLoadUsers(std::vector<std::unique_ptr<User>>& users, const std::string& filename) {
+    std::ifstream file(filename);
+    std::string line;
+    while (std::getline(file, line)) {
+        std::istringstream iss(line);
+        std::string username, password, type;
+        double budget;
+        if (!(iss >> username >> password >> type >> budget)) {
+            continue;
+        }
+        std::unique_ptr<User> user;
+        if (type == "0") {
+            user.reset(new Resident(username, password));
+        } else if (type == "1") {
+            user.reset(new NonResident(username, password));
+        } else if (type == "2") {
+            user.reset(new CityUser(username, password));
+        } else if (type == "3") {
+            user.reset(new Organization(username, password));
+        } else {
+            continue;
+        }
+        user->addToBudget(budget - user->getBudget());
+        users.push_back(std::move(user));
+    }
+}
+
+void streamLoadEvents(std::vector<std::unique_ptr<Event>>& events, const std::vector<std::unique_ptr<User>>& users,
+                      const std::string& filename) {
+    std::ifstream file(filename);
+    std::string line;
+    while (std::getline(file, line)) {
+        std::istringstream iss(line);
+        std::string name, description, organizerUsername, startDate, startClock, endDate, endClock;
+        double ticketPrice;
+        int maxCapacity;
+        bool isPublic, allowsResidents, allowsNonResidents;
+        std::getline(iss, name, ' ');
+        std::getline(iss, description, '"');
+        std::getline(iss, description, '"');
+        iss >> organizerUsername >> ticketPrice >> maxCapacity >> isPublic >> allowsResidents >> allowsNonResidents
+            >> startDate >> startClock >> endDate >> endClock;
+        if (iss.fail()) {
+            continue;
+        }
+        User* organizer = nullptr;
+        for (const auto& user : users) {
+            if (user->getUsername() == organizerUsername) {
+                organizer = user.get();
+                break;
+            }
+        }
+        if (!organizer) {
+            continue;
+        }
+        events.push_back(std::unique_ptr<Event>(new Event(name, description, organizer, ticketPrice, maxCapacity,
+                                                          isPublic, allowsResidents, allowsNonResidents,
+                                                          streamTimePoint(startDate + " " + startClock),
+                                                          streamTimePoint(endDate + " " + endClock))));
+    }
+}
+
+bool sameUsers(const std::vector<std::unique_ptr<User>>& a, const std::vector<std::unique_ptr<User>>& b) {
+    if (a.size() != b.size()) {
+        return false;
+    }
+    for (size_t i = 0; i < a.size(); ++i) {
+        if (a[i]->getUsername() != b[i]->getUsername() || a[i]->getType() != b[i]->getType() ||
+            std::fabs(a[i]->getBudget() - b[i]->getBudget()) > 1e-6) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool sameEvents(const std::vector<std::unique_ptr<Event>>& a, const std::vector<std::unique_ptr<Event>>& b) {
+    if (a.size() != b.size()) {
+        return false;
+    }
+    for (size_t i = 0; i < a.size(); ++i) {
+        if (a[i]->getName() != b[i]->getName() ||
+            a[i]->getOrganizer()->getUsername() != b[i]->getOrganizer()->getUsername() ||
+            std::fabs(a[i]->getTicketPrice() - b[i]->getTicketPrice()) > 1e-9 ||
+            a[i]->getMaxCapacity() != b[i]->getMaxCapacity() ||
+            a[i]->getStartTime() != b[i]->getStartTime() || a[i]->getEndTime() != b[i]->getEndTime()) {
+            return false;
+        }
+    }
+    return true;
+}
+
+int main(int argc, char* argv[]) {
+    int userCount = argc > 1 ? std::atoi(argv[1]) : 100000;
+    int eventCount = argc > 2 ? std::atoi(argv[2]) : 5000;
+    unsigned hardwareThreads = std::thread::hardware_concurrency();
+    unsigned threadCount = argc > 3 ? std::atoi(argv[3]) : (hardwareThreads > 0 ? hardwareThreads : 4);
+    std::string dataDir = argc > 4 ? argv[4] : "import_bench_data";
+    mkdir(dataDir.c_str(), 0755);
+    const std::string usersFile = dataDir + "/users.txt";
+    const std::string eventsFile = dataDir + "/events.txt";
+
+    // Every 10007th line is broken in a way the importer must name
+    std::vector<size_t> brokenUserLines;
+    std::vector<size_t> brokenEventLines;
+    {
+        std::ofstream users(usersFile);
+        for (int i = 0; i < userCount; ++i) {
+            if (i % 10007 == 5000) {
+                users << "broken" << i << " pw 9 100.00\n";
+                brokenUserLines.push_back(i + 1);
+            } else {
+                users << "user" << i << " pass" << i << " " << i % 4 << " " << 100 + i % 900 << "." << i % 100 / 10 << "5\n";
+            }
+        }
+        std::ofstream events(eventsFile);
+        for (int e = 0; e < eventCount; ++e) {
+            int day = 1 + e % 28;
+            int hour = e % 20;
+            events << "event" << e << " \"Synthetic event " << e << "\" ";
+            if (e % 10007 == 3000) {
+                events << "nobody";
+                brokenEventLines.push_back(e + 1);
+            } else {
+                events << "user" << (e * 7) % userCount;
+            }
+            events << " " << e % 90 << ".50 " << 10 + e % 500 << " 1 " << e % 2 << " 1 2024-"
+                   << std::setw(2) << std::setfill('0') << 1 + e % 12 << "-" << std::setw(2) << day << " "
+                   << std::setw(2) << hour << ":30 2024-"
+                   << std::setw(2) << 1 + e % 12 << "-" << std::setw(2) << day << " "
+                   << std::setw(2) << hour + 3 << ":00" << std::setfill(' ') << "\n";
+        }
+    }
+
+    std::vector<std::unique_ptr<User>> streamUsers;
+    std::vector<std::unique_ptr<Event>> streamEvents;
+    double streamUsersTime = timeIt([&]() { streamLoadUsers(streamUsers, usersFile); });
+    double streamEventsTime = timeIt([&]() { streamLoadEvents(streamEvents, streamUsers, eventsFile); });
+
+    // Broken rows go to std::cerr; keep the report readable
+    std::streambuf* original = std::cerr.rdbuf();
+    std::ostringstream reported;
+    std::cerr.rdbuf(reported.rdbuf());
+
+    const unsigned threadCounts[] = { 1, threadCount };
+    double importUsersTime[2];
+    double importEventsTime[2];
+    bool matches = true;
+    for (int run = 0; run < 2; ++run) {
+        BulkImporter importer(threadCounts[run]);
+        std::vector<std::unique_ptr<User>> users;
+        std::vector<std::unique_ptr<Event>> events;
+
+        importUsersTime[run] = timeIt([&]() { importer.loadUsers(usersFile, users); });
+        std::vector<size_t> userErrors;
+        for (const auto& error : importer.getErrors()) {
+            userErrors.push_back(error.line);
+        }
+        importEventsTime[run] = timeIt([&]() { importer.loadEvents(eventsFile, events, users); });
+        std::vector<size_t> eventErrors;
+        for (const auto& error : importer.getErrors()) {
+            eventErrors.push_back(error.line);
+        }
+
+        matches = matches && sameUsers(users, streamUsers) && sameEvents(events, streamEvents) &&
+                  userErrors == brokenUserLines && eventErrors == brokenEventLines;
+    }
+    std::cerr.rdbuf(original);
+
+    std::cout << "Rows: " << userCount << " users, " << eventCount << " events" << std::endl;
+    std::cout << "Stream loaders:         users " << streamUsersTime << " ms, events " << streamEventsTime << " ms" << std::endl;
+    for (int run = 0; run < 2; ++run) {
+        std::cout << "Bulk import, " << threadCounts[run] << (threadCounts[run] == 1 ? " thread:  " : " threads: ")
+                  << "users " << importUsersTime[run] << " ms, events " << importEventsTime[run] << " ms ("
+                  << (streamUsersTime + streamEventsTime) / (importUsersTime[run] + importEventsTime[run])
+                  << "x faster)" << std::endl;
+    }
+    std::cout << (matches ? "PASS: same rows loaded and broken rows reported by line"
+                          : "FAIL: importer disagrees with the stream loaders") << std::endl;
+
+    std::string cleanup = "rm -rf '" + dataDir + "'";
+    if (std::system(cleanup.c_str()) != 0) {
+        std::cerr << "Could not remove " << dataDir << std::endl;
+    }
+    return matches ? 0 : 1;
+}
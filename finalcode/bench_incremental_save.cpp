@@ -0,0 +1,177 @@
+// Compares a full text save with an incremental one after a handful of changes.
+//
+// Builds a large deployment, saves it once in full, then runs rounds of a few
+// bookings, ticket sales and pending requests. Each round is followed by an
+// IncrementalSaver pass, whose cost should track the changes rather than the
+// dataset, and the same round is timed against a full rewrite.
+//
+// One event is named like a path ("../Spring Gala/2024"); its file must stay
+// inside the directory. A second saver writes to a directory where that
+// event's file is blocked by a subdirectory: its pass must report the failed
+// write and not advance, and once the block is gone the next pass must retry it.
+//
+// Usage: ./incremental_save_bench [users] [events] [changesPerRound] [dataDir]
+
+#include <iostream>
+#include <streambuf>
+#include <vector>
+#include <memory>
+#include <string>
+#include <chrono>
+#include <cstdlib>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "User.h"
+#include "Resident.h"
+#include "NonResident.h"
+#include "Organization.h"
+#include "Event.h"
+#include "Ticket.h"
+#include "Reservation.h"
+#include "Facility.h"
+#include "FacilityManager.h"
+#include "IncrementalSaver.h"
+#include "BenchSupport.h"
+
+int main(int argc, char* argv[]) {
+    int userCount = argc > 1 ? std::atoi(argv[1]) : 5000;
+    int eventCount = argc > 2 ? std::atoi(argv[2]) : 100;
+    int changes = argc > 3 ? std::atoi(argv[3]) : 10;
+    std::string dataDir = argc > 4 ? argv[4] : "incremental_save_data";
+    std::string fullDir = dataDir + "/full";
+    mkdir(dataDir.c_str(), 0755);
+    mkdir(fullDir.c_str(), 0755);
+
+    NullBuffer discard;
+    std::streambuf* original = std::cout.rdbuf(&discard);
+
+    std::vector<std::unique_ptr<User>> users;
+    std::vector<std::unique_ptr<Event>> events;
+    Facility facility;
+    FacilityManager manager(facility);
+    auto base = std::chrono::system_clock::time_point(std::chrono::hours(24 * 20000));
+
+    for (int i = 0; i < userCount; ++i) {
+        std::string name = "user" + std::to_string(i);
+        std::unique_ptr<User> user;
+        if (i % 3 == 0) {
+            user.reset(new Resident(name, "pw"));
+        } else if (i % 3 == 1) {
+            user.reset(new NonResident(name, "pw"));
+        } else {
+            user.reset(new Organization(name, "pw"));
+        }
+        user->addToBudget(1000000.0);
+        auto start = base + std::chrono::hours(24 * i + 10);
+        user->makeReservation(std::unique_ptr<Reservation>(
+            new Reservation(user.get(), start, start + std::chrono::hours(2), LayoutStyle::Meeting, true)));
+        users.push_back(std::move(user));
+    }
+    for (int e = 0; e < eventCount; ++e) {
+        std::unique_ptr<Event> event(new Event("event" + std::to_string(e), "Synthetic event", users[e % userCount].get(),
+                                               5.0, 1000, true, true, true));
+        for (int t = 0; t < 50; ++t) {
+            User* buyer = users[(e * 31 + t) % userCount].get();
+            Ticket* ticket = event->purchaseTicket(buyer);
+            if (ticket) {
+                buyer->purchaseTicket(ticket);
+            }
+        }
+        events.push_back(std::move(event));
+    }
+    const std::string trickyName = "../Spring Gala/2024";
+    events.push_back(std::unique_ptr<Event>(new Event(trickyName, "Named like a path", users[0].get(),
+                                                      5.0, 100, true, true, true)));
+    const std::string trickyFile = "/event_" + IncrementalSaver::fileNameFor(trickyName);
+    struct stat info;
+
+    // A subdirectory where the tricky event's file belongs makes that one write fail
+    std::string retryDir = dataDir + "/retry";
+    mkdir(retryDir.c_str(), 0755);
+    mkdir((retryDir + trickyFile).c_str(), 0755);
+    IncrementalSaver retrying(retryDir);
+    retrying.saveChanged(users, events, facility, manager);
+    bool reported = retrying.getFailedWrites() == 1 && retrying.getSavedThrough() == 0;
+    rmdir((retryDir + trickyFile).c_str());
+    retrying.saveChanged(users, events, facility, manager);
+    bool retried = retrying.getFailedWrites() == 0 && retrying.getSavedThrough() != 0 &&
+                   stat((retryDir + trickyFile).c_str(), &info) == 0 && S_ISREG(info.st_mode);
+
+    IncrementalSaver saver(dataDir);
+    std::size_t firstFiles = 0;
+    double firstPass = timeIt([&]() {
+        firstFiles = saver.saveChanged(users, events, facility, manager);
+    });
+    std::size_t idleFiles = saver.saveChanged(users, events, facility, manager);
+
+    const int rounds = 5;
+    double incremental = 0.0;
+    double full = 0.0;
+    std::size_t roundFiles = 0;
+    for (int round = 0; round < rounds; ++round) {
+        for (int c = 0; c < changes; ++c) {
+            User* user = users[(round * 7919 + c * 104729) % userCount].get();
+            auto start = base + std::chrono::hours(24 * (userCount + round * changes + c) + 12);
+            switch (c % 3) {
+                case 0:
+                    user->makeReservation(std::unique_ptr<Reservation>(
+                        new Reservation(user, start, start + std::chrono::hours(1), LayoutStyle::Meeting, true)));
+                    break;
+                case 1: {
+                    Event* event = events[(round + c) % eventCount].get();
+                    Ticket* ticket = event->purchaseTicket(user);
+                    if (ticket) {
+                        user->purchaseTicket(ticket);
+                    }
+                    break;
+                }
+                default:
+                    manager.addPendingReservation(std::unique_ptr<Reservation>(
+                        new Reservation(user, start, start + std::chrono::hours(3), LayoutStyle::Lecture, false)));
+                    break;
+            }
+        }
+
+        incremental += timeIt([&]() {
+            roundFiles += saver.saveChanged(users, events, facility, manager);
+        });
+        full += timeIt([&]() {
+            for (const auto& user : users) {
+                user->saveToFile(fullDir + "/user_" + IncrementalSaver::fileNameFor(user->getUsername()));
+            }
+            for (const auto& event : events) {
+                event->saveToFile(fullDir + "/event_" + IncrementalSaver::fileNameFor(event->getName()));
+            }
+            facility.saveToFile(fullDir + "/facility");
+            manager.saveToFile(fullDir + "/manager");
+        });
+    }
+
+    std::cout.rdbuf(original);
+
+    // Each change touches at most three files (owner index, record, event or manager index)
+    bool bounded = idleFiles == 0 && roundFiles <= static_cast<std::size_t>(rounds * changes * 3);
+    // The path-like name lands in a plain file inside the directory
+    bool contained = stat((dataDir + trickyFile).c_str(), &info) == 0 && S_ISREG(info.st_mode);
+    bool ok = bounded && contained && reported && retried;
+
+    std::cout << "Dataset: " << userCount << " users, " << eventCount << " events, "
+              << changes << " changes per round" << std::endl;
+    std::cout << "First pass:        " << firstPass << " ms, " << firstFiles << " files" << std::endl;
+    std::cout << "Idle pass:         " << idleFiles << " files" << std::endl;
+    std::cout << "Incremental round: " << incremental / rounds << " ms, "
+              << static_cast<double>(roundFiles) / rounds << " files" << std::endl;
+    std::cout << "Full rewrite:      " << full / rounds << " ms (" << (full / incremental) << "x slower)" << std::endl;
+    std::cout << "Path-like name:    " << (contained ? "kept inside the directory" : "escaped the directory") << std::endl;
+    std::cout << "Failed write:      " << (reported ? "reported" : "not reported") << ", "
+              << (retried ? "retried" : "not retried") << " on the next pass" << std::endl;
+    std::cout << (ok ? "PASS: incremental passes write only changed records, all of them inside the directory"
+                     : "FAIL: incremental pass wrote unchanged records, left the directory or lost a failed write")
+              << std::endl;
+
+    std::string cleanup = "rm -rf '" + dataDir + "'";
+    if (std::system(cleanup.c_str()) != 0) {
+        std::cerr << "Could not remove " << dataDir << std::endl;
+    }
+    return ok ? 0 : 1;
+}
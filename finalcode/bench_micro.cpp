@@ -0,0 +1,338 @@
+// Microbenchmarks of the scheduling and ticketing hot paths, each run over
+// datasets of 10 to 1,000,000 elements so a change in complexity shows up as
+// a change in how the time grows with size:
+//   Facility::isAvailable                  schedule of N bookings, random windows
+//   FacilityManager::checkReservationLimits  same schedule, random requesters
+//   Event::purchaseTicket+cancelTicket      event already holding N tickets
+//   Reservation::calculateCost             cycling over N reservations
+//   Reservation::toString                  cycling over N reservations
+//   Event::loadFromFile                    event file with N tickets
+//   BulkImporter::loadUsers                users.txt with N rows, one thread
+//
+// Each measurement is calibrated to about 20 ms per round. It runs one warm-up
+// round and then several timed rounds, and reports the median time per
+// operation with the spread between the fastest and slowest round. Inputs are
+// drawn from a fixed seed.
+//
+// --save writes the results to a baseline file. --compare reads one back and
+// flags every case more than 25% slower than the baseline. Any flagged case
+// makes the run fail.
+//
+// Usage: ./micro_bench [--save file | --compare file] [maxSize] [rounds]
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <streambuf>
+#include <vector>
+#include <map>
+#include <memory>
+#include <string>
+#include <chrono>
+#include <random>
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstdint>
+#include "User.h"
+#include "Resident.h"
+#include "Organization.h"
+#include "Event.h"
+#include "Ticket.h"
+#include "Reservation.h"
+#include "Facility.h"
+#include "FacilityManager.h"
+#include "UserDirectory.h"
+#include "BulkImporter.h"
+#include "BenchSupport.h"
+
+typedef std::chrono::system_clock Clock;
+
+namespace {
+    const double ROUND_MS = 20.0;
+    const double REGRESSION = 0.25; // Slowdown against the baseline that fails the run
+    const Clock::time_point base = Clock::from_time_t(1704067200); // 2024-01-01
+
+    // Keeps results alive so the measured calls are not optimized away
+    volatile double sink;
+
+    struct Result {
+        std::string name;
+        std::size_t size;
+        double nanoseconds; // Median per operation
+        double spread;      // (slowest - fastest) / median over the rounds
+    };
+
+    // body(n) performs the operation n times
+    template<typename Body>
+    Result measure(const std::string& name, std::size_t size, int rounds, Body body) {
+        std::size_t iterations = 1;
+        double ms = timeIt([&]() { body(iterations); });
+        while (ms < ROUND_MS / 8 && iterations < (std::size_t(1) << 32)) {
+            iterations *= 4;
+            ms = timeIt([&]() { body(iterations); });
+        }
+        iterations = std::max<std::size_t>(1, static_cast<std::size_t>(iterations * ROUND_MS / std::max(ms, 1e-3)));
+        body(iterations); // Warm-up at the final size
+
+        std::vector<double> perOperation;
+        for (int r = 0; r < rounds; ++r) {
+            perOperation.push_back(timeIt([&]() { body(iterations); }) * 1e6 / iterations);
+        }
+        std::sort(perOperation.begin(), perOperation.end());
+        double median = perOperation[perOperation.size() / 2];
+        return Result{ name, size, median, median > 0.0 ? (perOperation.back() - perOperation.front()) / median : 0.0 };
+    }
+
+    // Users named prefix0.. with a large budget
+    void makeUsers(std::size_t count, const std::string& prefix, std::vector<std::unique_ptr<User>>& users) {
+        for (std::size_t i = 0; i < count; ++i) {
+            users.push_back(std::unique_ptr<User>(new Resident(prefix + std::to_string(i), "pw")));
+            users.back()->addToBudget(1e12);
+        }
+    }
+
+    // One-hour bookings on every other hour from 8 am to 10 pm, spread over users
+    void bookSchedule(std::size_t size, const std::vector<std::unique_ptr<User>>& users, Facility& facility) {
+        for (std::size_t i = 0; i < size; ++i) {
+            Clock::time_point start = base + std::chrono::hours(24 * static_cast<long long>(i / 7) + 8 + 2 * (i % 7));
+            facility.addReservation(std::unique_ptr<Reservation>(new Reservation(
+                users[i % users.size()].get(), start, start + std::chrono::hours(1), LayoutStyle::Meeting, true)));
+        }
+    }
+
+    void benchSchedule(std::size_t size, int rounds, std::vector<Result>& results) {
+        std::vector<std::unique_ptr<User>> users;
+        makeUsers(std::min<std::size_t>(size, 1000), "micro_schedule", users);
+        Facility facility;
+        FacilityManager manager(facility);
+        bookSchedule(size, users, facility);
+
+        // Hour-long windows over the booked days, about half of them taken
+        std::mt19937 random(42);
+        std::uniform_int_distribution<long long> day(0, (size - 1) / 7);
+        std::uniform_int_distribution<int> hour(8, 21);
+        std::uniform_int_distribution<std::size_t> user(0, users.size() - 1);
+        std::vector<Clock::time_point> windows;
+        std::vector<std::unique_ptr<Reservation>> requests;
+        for (int i = 0; i < 1024; ++i) {
+            windows.push_back(base + std::chrono::hours(24 * day(random) + hour(random)));
+            requests.push_back(std::unique_ptr<Reservation>(new Reservation(
+                users[user(random)].get(), windows.back(), windows.back() + std::chrono::hours(2), LayoutStyle::Meeting, true)));
+        }
+
+        results.push_back(measure("Facility::isAvailable", size, rounds, [&](std::size_t n) {
+            std::size_t free = 0;
+            for (std::size_t i = 0; i < n; ++i) {
+                const Clock::time_point& start = windows[i & 1023];
+                free += facility.isAvailable(start, start + std::chrono::hours(1));
+            }
+            sink = static_cast<double>(free);
+        }));
+        results.push_back(measure("FacilityManager::checkReservationLimits", size, rounds, [&](std::size_t n) {
+            std::size_t allowed = 0;
+            for (std::size_t i = 0; i < n; ++i) {
+                const Reservation* request = requests[i & 1023].get();
+                allowed += manager.checkReservationLimits(request->getUser(), request);
+            }
+            sink = static_cast<double>(allowed);
+        }));
+    }
+
+    void benchTickets(std::size_t size, int rounds, std::vector<Result>& results) {
+        std::vector<std::unique_ptr<User>> users;
+        makeUsers(std::min<std::size_t>(size, 1000), "micro_buyer", users);
+        Organization organizer("micro_organizer", "pw");
+        Event event("micro_event", "Microbenchmark", &organizer, 10.0, static_cast<int>(size) + 1, true, true, true);
+        for (std::size_t i = 0; i < size; ++i) {
+            User* buyer = users[i % users.size()].get();
+            buyer->purchaseTicket(event.purchaseTicket(buyer));
+        }
+
+        // A buyer holding no other tickets, so the user's own list stays short
+        Resident buyer("micro_fresh_buyer", "pw");
+        buyer.addToBudget(1e12);
+        results.push_back(measure("Event::purchaseTicket+cancelTicket", size, rounds, [&](std::size_t n) {
+            for (std::size_t i = 0; i < n; ++i) {
+                Ticket* ticket = event.purchaseTicket(&buyer);
+                buyer.purchaseTicket(ticket);
+                event.cancelTicket(ticket);
+            }
+            sink = event.getCurrentCapacity();
+        }));
+    }
+
+    void benchReservations(std::size_t size, int rounds, std::vector<Result>& results) {
+        std::vector<std::unique_ptr<User>> users;
+        makeUsers(std::min<std::size_t>(size, 1000), "micro_holder", users);
+        std::vector<std::unique_ptr<Reservation>> reservations;
+        for (std::size_t i = 0; i < size; ++i) {
+            Clock::time_point start = base + std::chrono::hours(static_cast<long long>(i));
+            reservations.push_back(std::unique_ptr<Reservation>(new Reservation(
+                users[i % users.size()].get(), start, start + std::chrono::hours(1 + i % 3),
+                static_cast<LayoutStyle>(i % 4), i % 2 == 0)));
+        }
+
+        results.push_back(measure("Reservation::calculateCost", size, rounds, [&](std::size_t n) {
+            double total = 0.0;
+            for (std::size_t i = 0, r = 0; i < n; ++i, r = r + 1 < size ? r + 1 : 0) {
+                total += reservations[r]->calculateCost();
+            }
+            sink = total;
+        }));
+        results.push_back(measure("Reservation::toString", size, rounds, [&](std::size_t n) {
+            std::size_t length = 0;
+            for (std::size_t i = 0, r = 0; i < n; ++i, r = r + 1 < size ? r + 1 : 0) {
+                length += reservations[r]->toString().size();
+            }
+            sink = static_cast<double>(length);
+        }));
+    }
+
+    void benchLoading(std::size_t size, int rounds, std::vector<Result>& results) {
+        std::vector<std::unique_ptr<User>> users;
+        makeUsers(std::min<std::size_t>(size, 1000), "micro_attendee", users);
+        users.push_back(std::unique_ptr<User>(new Organization("micro_host", "pw")));
+        const std::string eventFile = "micro_bench_event.txt";
+        {
+            Event event("micro_loaded", "Microbenchmark", users.back().get(), 10.0, static_cast<int>(size), true, true, true);
+            for (std::size_t i = 0; i < size; ++i) {
+                event.purchaseTicket(users[i % (users.size() - 1)].get());
+            }
+            event.saveToFile(eventFile);
+        }
+        UserDirectory directory(users);
+        results.push_back(measure("Event::loadFromFile", size, rounds, [&](std::size_t n) {
+            std::size_t loaded = 0;
+            for (std::size_t i = 0; i < n; ++i) {
+                std::unique_ptr<Event> loadedEvent = Event::loadFromFile(eventFile, directory);
+                loaded += loadedEvent ? loadedEvent->getTickets().size() : 0;
+            }
+            sink = static_cast<double>(loaded);
+        }));
+        std::remove(eventFile.c_str());
+
+        const std::string usersFile = "micro_bench_users.txt";
+        {
+            std::ofstream file(usersFile);
+            for (std::size_t i = 0; i < size; ++i) {
+                file << "micro_row" << i << " pw" << i << ' ' << i % 4 << " 100.00\n";
+            }
+        }
+        BulkImporter importer(1);
+        results.push_back(measure("BulkImporter::loadUsers", size, rounds, [&](std::size_t n) {
+            std::size_t loaded = 0;
+            for (std::size_t i = 0; i < n; ++i) {
+                std::vector<std::unique_ptr<User>> loadedUsers;
+                loaded += importer.loadUsers(usersFile, loadedUsers);
+            }
+            sink = static_cast<double>(loaded);
+        }));
+        std::remove(usersFile.c_str());
+    }
+
+    std::string key(const Result& result) {
+        return result.name + " " + std::to_string(result.size);
+    }
+
+    bool readBaseline(const std::string& filename, std::map<std::string, double>& baseline) {
+        std::ifstream file(filename);
+        if (!file.is_open()) {
+            return false;
+        }
+        std::string line;
+        while (std::getline(file, line)) {
+            std::istringstream fields(line);
+            std::string name;
+            std::size_t size;
+            double nanoseconds;
+            if (line.empty() || line[0] == '#' || !(fields >> name >> size >> nanoseconds)) {
+                continue;
+            }
+            baseline[name + " " + std::to_string(size)] = nanoseconds;
+        }
+        return true;
+    }
+}
+
+int main(int argc, char* argv[]) {
+    std::string saveFile, compareFile;
+    std::vector<std::string> positional;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--save" && i + 1 < argc) {
+            saveFile = argv[++i];
+        } else if (arg == "--compare" && i + 1 < argc) {
+            compareFile = argv[++i];
+        } else {
+            positional.push_back(arg);
+        }
+    }
+    std::size_t maxSize = positional.size() > 0 ? std::strtoull(positional[0].c_str(), nullptr, 10) : 1000000;
+    int rounds = positional.size() > 1 ? std::atoi(positional[1].c_str()) : 5;
+    if (rounds < 1) {
+        rounds = 1;
+    }
+
+    std::map<std::string, double> baseline;
+    bool comparing = !compareFile.empty() && readBaseline(compareFile, baseline);
+    if (!compareFile.empty() && !comparing) {
+        std::cout << "No baseline in " << compareFile << "; save one with --save" << std::endl;
+    }
+
+    // The model classes report on std::cout; results go to the original buffer
+    NullBuffer discard;
+    std::streambuf* original = std::cout.rdbuf(&discard);
+    std::ostream out(original);
+
+    std::vector<Result> results;
+    std::size_t regressions = 0;
+    char line[256];
+    for (std::size_t size = 10; size <= maxSize; size *= 10) {
+        std::size_t first = results.size();
+        benchSchedule(size, rounds, results);
+        benchTickets(size, rounds, results);
+        benchReservations(size, rounds, results);
+        benchLoading(size, rounds, results);
+
+        for (std::size_t i = first; i < results.size(); ++i) {
+            const Result& result = results[i];
+            std::snprintf(line, sizeof(line), "%-40s %8zu %14.1f ns/op  +/-%5.1f%%", result.name.c_str(),
+                          result.size, result.nanoseconds, result.spread * 100.0);
+            out << line;
+            auto previous = baseline.find(key(result));
+            if (comparing && previous != baseline.end() && previous->second > 0.0) {
+                double change = result.nanoseconds / previous->second - 1.0;
+                std::snprintf(line, sizeof(line), "  %+6.1f%% vs baseline", change * 100.0);
+                out << line;
+                if (change > REGRESSION) {
+                    out << "  REGRESSION";
+                    ++regressions;
+                }
+            }
+            out << std::endl;
+        }
+    }
+    std::cout.rdbuf(original);
+
+    if (!saveFile.empty()) {
+        std::ofstream file(saveFile);
+        if (!file.is_open()) {
+            std::cout << "Unable to open file: " << saveFile << std::endl;
+            return 1;
+        }
+        file << "# name size ns_per_op" << std::endl;
+        for (const Result& result : results) {
+            file << result.name << ' ' << result.size << ' ' << result.nanoseconds << std::endl;
+        }
+        std::cout << "Baseline saved to " << saveFile << std::endl;
+    }
+
+    if (!comparing) {
+        return 0;
+    }
+    bool ok = regressions == 0;
+    std::cout << (ok ? "PASS: no case is more than 25% slower than the baseline"
+                     : "FAIL: " + std::to_string(regressions) + " cases regressed against the baseline") << std::endl;
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,147 @@
+// Counts heap allocations while a large snapshot is loaded, to confirm that
+// reservations, events and tickets come from pooled chunks rather than one
+// allocation each.
+//
+// Builds users with a reservation each and events with tickets, saves a
+// snapshot, then loads it with Snapshot::loadMapped while counting every call
+// to the global operator new. Per type it reports the objects created and the
+// chunk allocations that held them; each chunk must hold at least 16 objects.
+// Reservations are built straight into ReservationStore slots, so exactly one
+// is created per saved reservation.
+//
+// Usage: ./pool_bench [users] [events] [ticketsPerEvent] [snapshotFile]
+
+#include <iostream>
+#include <streambuf>
+#include <vector>
+#include <memory>
+#include <string>
+#include <chrono>
+#include <atomic>
+#include <new>
+#include <cstdio>
+#include <cstdlib>
+#include "User.h"
+#include "Resident.h"
+#include "Event.h"
+#include "Ticket.h"
+#include "Reservation.h"
+#include "Facility.h"
+#include "FacilityManager.h"
+#include "Snapshot.h"
+#include "ObjectPool.h"
+#include "BenchSupport.h"
+
+namespace {
+    std::atomic<std::size_t> heapAllocations(0);
+}
+
+void* operator new(std::size_t size) {
+    heapAllocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* memory = std::malloc(size > 0 ? size : 1)) {
+        return memory;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* memory) noexcept {
+    std::free(memory);
+}
+
+void operator delete(void* memory, std::size_t) noexcept {
+    std::free(memory);
+}
+
+AllocationCounts since(const AllocationCounts& now, const AllocationCounts& before) {
+    return AllocationCounts{ now.created - before.created, now.destroyed - before.destroyed, now.chunks - before.chunks };
+}
+
+bool report(const char* type, const AllocationCounts& counts) {
+    bool pooled = counts.chunks * 16 <= counts.created;
+    std::cout << type << counts.created << " created, " << counts.chunks << " chunk allocations";
+    if (counts.chunks > 0) {
+        std::cout << " (" << static_cast<double>(counts.created) / counts.chunks << " per chunk)" << std::endl;
+    } else {
+        std::cout << " (slots reused from the build phase)" << std::endl;
+    }
+    return pooled;
+}
+
+int main(int argc, char* argv[]) {
+    int userCount = argc > 1 ? std::atoi(argv[1]) : 50000;
+    int eventCount = argc > 2 ? std::atoi(argv[2]) : 20000;
+    int ticketsPerEvent = argc > 3 ? std::atoi(argv[3]) : 25;
+    std::string snapshotFile = argc > 4 ? argv[4] : "pool_bench.snap";
+    if (userCount < 1) {
+        userCount = 1;
+    }
+
+    NullBuffer discard;
+    std::streambuf* original = std::cout.rdbuf(&discard);
+
+    typedef std::chrono::system_clock Clock;
+    const Clock::time_point base = Clock::from_time_t(1704103200); // 2024-01-01 10:00 UTC
+    {
+        std::vector<std::unique_ptr<User>> users;
+        std::vector<std::unique_ptr<Event>> events;
+        Facility facility;
+        FacilityManager manager(facility);
+        for (int i = 0; i < userCount; ++i) {
+            users.push_back(std::unique_ptr<User>(new Resident("user" + std::to_string(i), "pw")));
+            users.back()->addToBudget(1000000.0);
+            Clock::time_point start = base + std::chrono::hours(24 * i);
+            users.back()->makeReservation(std::unique_ptr<Reservation>(new Reservation(
+                users.back().get(), start, start + std::chrono::hours(2), LayoutStyle::Meeting, true)));
+        }
+        for (int e = 0; e < eventCount; ++e) {
+            std::unique_ptr<Event> event(new Event("event" + std::to_string(e), "Synthetic event",
+                                                   users[e % userCount].get(), 1.0, ticketsPerEvent,
+                                                   true, true, true));
+            for (int t = 0; t < ticketsPerEvent; ++t) {
+                User* buyer = users[(static_cast<long long>(e) * 7919 + t) % userCount].get();
+                if (Ticket* ticket = event->purchaseTicket(buyer)) {
+                    buyer->attachTicket(ticket);
+                }
+            }
+            events.push_back(std::move(event));
+        }
+        Snapshot::save(snapshotFile, users, events, facility, manager);
+    }
+
+    AllocationCounts reservationsBefore = PoolStats<Reservation>::counts();
+    AllocationCounts eventsBefore = Event::allocationCounts();
+    AllocationCounts ticketsBefore = PoolStats<Ticket>::counts();
+    std::size_t heapBefore = heapAllocations.load();
+
+    std::vector<std::unique_ptr<User>> users;
+    std::vector<std::unique_ptr<Event>> events;
+    Facility facility;
+    FacilityManager manager(facility);
+    auto begin = std::chrono::steady_clock::now();
+    bool loaded = Snapshot::loadMapped(snapshotFile, users, events, facility, manager);
+    double elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count();
+
+    std::size_t heapUsed = heapAllocations.load() - heapBefore;
+    AllocationCounts reservations = since(PoolStats<Reservation>::counts(), reservationsBefore);
+    AllocationCounts eventCounts = since(Event::allocationCounts(), eventsBefore);
+    AllocationCounts tickets = since(PoolStats<Ticket>::counts(), ticketsBefore);
+
+    std::cout.rdbuf(original);
+
+    std::size_t objects = reservations.created + eventCounts.created + tickets.created;
+    std::cout << "Loaded " << users.size() << " users, " << events.size() << " events in " << elapsed << " ms" << std::endl;
+    bool pooled = report("Reservations: ", reservations);
+    pooled = report("Events:       ", eventCounts) && pooled;
+    pooled = report("Tickets:      ", tickets) && pooled;
+    std::cout << "All heap allocations during load: " << heapUsed << " for " << objects
+              << " pooled objects (strings, vectors and users included)" << std::endl;
+
+    bool ok = loaded && pooled && reservations.created == static_cast<std::size_t>(userCount) &&
+              eventCounts.created == static_cast<std::size_t>(eventCount) &&
+              tickets.created == static_cast<std::size_t>(eventCount) * ticketsPerEvent;
+    std::cout << (ok ? "PASS: reservations, events and tickets are pool-allocated"
+                     : "FAIL: objects are still allocated one by one") << std::endl;
+
+    std::remove(snapshotFile.c_str());
+    return ok ? 0 : 1;
+}
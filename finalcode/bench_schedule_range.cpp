@@ -0,0 +1,106 @@
+// Compares listing one week of the facility schedule by sorting the whole
+// history, as displaySchedule used to, with the ordered range view.
+//
+// Fills the schedule with one-hour bookings for many days, then for random
+// weeks collects the reservations overlapping that week with:
+//   - sort:  copy every scheduled reservation, sort by start, keep the week
+//   - view:  Facility::reservationsBetween over the same week
+// Both must yield the same reservations in the same order. Also times one
+// paginated display of a week against the full display.
+//
+// Usage: ./schedule_range_bench [days] [bookingsPerDay] [queries]
+
+#include <iostream>
+#include <streambuf>
+#include <vector>
+#include <memory>
+#include <chrono>
+#include <random>
+#include <algorithm>
+#include <cstdlib>
+#include "Resident.h"
+#include "Reservation.h"
+#include "Facility.h"
+#include "BenchSupport.h"
+
+int main(int argc, char* argv[]) {
+    int dayCount = argc > 1 ? std::atoi(argv[1]) : 3650;
+    int bookingsPerDay = argc > 2 ? std::atoi(argv[2]) : 8;
+    int queryCount = argc > 3 ? std::atoi(argv[3]) : 200;
+    if (dayCount < 8) {
+        dayCount = 8;
+    }
+    bookingsPerDay = std::max(1, std::min(bookingsPerDay, 15)); // Opening hours are 8:00 - 23:00 UTC
+
+    typedef std::chrono::system_clock Clock;
+    const Clock::time_point base = Clock::from_time_t(1704067200); // 2024-01-01 00:00 UTC
+    std::mt19937 random(42);
+
+    NullBuffer discard;
+    std::streambuf* original = std::cout.rdbuf(&discard);
+
+    // Booked in shuffled order so the schedule's own order is not start order
+    std::vector<int> slots;
+    for (int day = 0; day < dayCount; ++day) {
+        for (int hour = 0; hour < bookingsPerDay; ++hour) {
+            slots.push_back(day * 24 + 8 + hour);
+        }
+    }
+    std::shuffle(slots.begin(), slots.end(), random);
+
+    Resident owner("range_owner", "pw");
+    Facility facility;
+    for (int slot : slots) {
+        Clock::time_point start = base + std::chrono::hours(slot);
+        facility.addReservation(std::unique_ptr<Reservation>(new Reservation(
+            &owner, start, start + std::chrono::hours(1), LayoutStyle::Meeting, true)));
+    }
+
+    std::vector<Clock::time_point> weeks;
+    std::uniform_int_distribution<int> pickDay(0, dayCount - 7);
+    for (int i = 0; i < queryCount; ++i) {
+        weeks.push_back(base + std::chrono::hours(24 * pickDay(random)));
+    }
+
+    std::vector<std::vector<RecordId>> sorted(weeks.size()), viewed(weeks.size());
+    double sortTime = timeIt([&]() {
+        for (size_t q = 0; q < weeks.size(); ++q) {
+            Clock::time_point end = weeks[q] + std::chrono::hours(24 * 7);
+            std::vector<Reservation*> all;
+            for (Reservation* reservation : facility.getReservations()) {
+                all.push_back(reservation);
+            }
+            std::sort(all.begin(), all.end(),
+                [](const Reservation* a, const Reservation* b) { return a->getStartTime() < b->getStartTime(); });
+            for (const Reservation* reservation : all) {
+                if (reservation->overlaps(weeks[q], end)) {
+                    sorted[q].push_back(reservation->getId());
+                }
+            }
+        }
+    });
+
+    double viewTime = timeIt([&]() {
+        for (size_t q = 0; q < weeks.size(); ++q) {
+            for (const Reservation* reservation : facility.reservationsBetween(weeks[q], weeks[q] + std::chrono::hours(24 * 7))) {
+                viewed[q].push_back(reservation->getId());
+            }
+        }
+    });
+
+    double fullDisplayTime = timeIt([&]() { facility.displaySchedule(); });
+    double pageTime = timeIt([&]() { facility.displaySchedule(weeks[0], weeks[0] + std::chrono::hours(24 * 7), 0, 20); });
+
+    std::cout.rdbuf(original);
+
+    bool matches = sorted == viewed && !viewed.empty() &&
+                   viewed[0].size() == static_cast<size_t>(7 * bookingsPerDay);
+    std::cout << "Scheduled: " << facility.getReservations().size() << " reservations, queries: " << queryCount << " weeks" << std::endl;
+    std::cout << "Sort whole schedule: " << sortTime * 1000 / queryCount << " us/week" << std::endl;
+    std::cout << "Range view:          " << viewTime * 1000 / queryCount << " us/week ("
+              << sortTime / viewTime << "x faster)" << std::endl;
+    std::cout << "Display: full schedule " << fullDisplayTime << " ms, one page of a week " << pageTime << " ms" << std::endl;
+    std::cout << (matches ? "PASS: range view lists the same reservations in the same order"
+                          : "FAIL: range view disagrees with the sorted schedule") << std::endl;
+    return matches ? 0 : 1;
+}
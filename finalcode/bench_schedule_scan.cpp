@@ -0,0 +1,120 @@
+// Compares conflict checks over a vector of unique_ptr<Reservation> with the
+// columnar overlap kernel.
+//
+// Books one-hour slots on every other hour, allocated in shuffled order, then
+// checks random one-hour windows (half of them taken) with:
+//   - pointer scan:  Reservation::overlaps over vector<unique_ptr<Reservation>>
+//   - kernel:        ScheduleColumns::firstOverlap over the same bookings as
+//                    start/end arrays, at each SIMD level the CPU supports
+//   - columns:       ScheduleColumns::overlaps, which narrows to the rows near
+//                    the window before running the kernel
+// Every method must give the same answer for every window.
+//
+// Usage: ./schedule_scan_bench [bookings] [queries]
+
+#include <iostream>
+#include <vector>
+#include <memory>
+#include <string>
+#include <chrono>
+#include <random>
+#include <algorithm>
+#include <cstdlib>
+#include <cstdint>
+#include "Resident.h"
+#include "Reservation.h"
+#include "ScheduleColumns.h"
+#include "CpuFeatures.h"
+#include "BenchSupport.h"
+
+int main(int argc, char* argv[]) {
+    int bookingCount = argc > 1 ? std::atoi(argv[1]) : 4096;
+    int queryCount = argc > 2 ? std::atoi(argv[2]) : 20000;
+    if (bookingCount < 1) {
+        bookingCount = 1;
+    }
+
+    typedef std::chrono::system_clock Clock;
+    const Clock::time_point base = Clock::from_time_t(1704067200); // 2024-01-01
+    std::mt19937 random(42);
+
+    Resident owner("bench_owner", "pw");
+    std::vector<int> slots(bookingCount);
+    for (int i = 0; i < bookingCount; ++i) {
+        slots[i] = 2 * i;
+    }
+    std::shuffle(slots.begin(), slots.end(), random);
+
+    std::vector<std::unique_ptr<Reservation>> reservations;
+    std::vector<std::int64_t> starts, ends;
+    ScheduleColumns columns;
+    for (int slot : slots) {
+        Clock::time_point start = base + std::chrono::hours(slot);
+        reservations.push_back(std::unique_ptr<Reservation>(new Reservation(
+            &owner, start, start + std::chrono::hours(1), LayoutStyle::Meeting, true, slot + 1, true, 0.0)));
+        starts.push_back(ScheduleColumns::ticks(start));
+        ends.push_back(ScheduleColumns::ticks(start + std::chrono::hours(1)));
+        columns.insert(*reservations.back());
+    }
+
+    std::vector<Clock::time_point> queries;
+    std::uniform_int_distribution<int> pick(0, 2 * bookingCount - 1);
+    for (int i = 0; i < queryCount; ++i) {
+        queries.push_back(base + std::chrono::hours(pick(random)));
+    }
+
+    std::vector<char> expected(queries.size());
+    double pointerTime = timeIt([&]() {
+        for (size_t q = 0; q < queries.size(); ++q) {
+            Clock::time_point end = queries[q] + std::chrono::hours(1);
+            bool hit = false;
+            for (const auto& reservation : reservations) {
+                if (reservation->overlaps(queries[q], end)) {
+                    hit = true;
+                    break;
+                }
+            }
+            expected[q] = hit;
+        }
+    });
+
+    bool matches = true;
+    std::cout << "Bookings: " << bookingCount << ", queries: " << queryCount
+              << ", CPU level: " << simdLevelName(detectSimdLevel()) << std::endl;
+    std::cout << "Pointer scan:     " << pointerTime * 1e6 / queryCount << " ns/query" << std::endl;
+
+    const SimdLevel levels[] = { SimdLevel::Scalar, SimdLevel::SSE42, SimdLevel::AVX2 };
+    for (SimdLevel level : levels) {
+        if (level > detectSimdLevel()) {
+            std::cout << "Kernel, " << simdLevelName(level) << ": not supported by this CPU" << std::endl;
+            continue;
+        }
+        std::vector<char> found(queries.size());
+        double kernelTime = timeIt([&]() {
+            for (size_t q = 0; q < queries.size(); ++q) {
+                std::int64_t start = ScheduleColumns::ticks(queries[q]);
+                std::int64_t end = ScheduleColumns::ticks(queries[q] + std::chrono::hours(1));
+                found[q] = ScheduleColumns::firstOverlap(starts.data(), ends.data(), starts.size(), start, end, level)
+                           != starts.size();
+            }
+        });
+        matches = matches && found == expected;
+        std::cout << "Kernel, " << simdLevelName(level) << ":" << std::string(10 - std::string(simdLevelName(level)).size(), ' ')
+                  << kernelTime * 1e6 / queryCount << " ns/query (" << pointerTime / kernelTime << "x faster)" << std::endl;
+    }
+
+    std::vector<char> found(queries.size());
+    double columnsTime = timeIt([&]() {
+        for (size_t q = 0; q < queries.size(); ++q) {
+            found[q] = columns.overlaps(ScheduleColumns::ticks(queries[q]),
+                                        ScheduleColumns::ticks(queries[q] + std::chrono::hours(1)));
+        }
+    });
+    matches = matches && found == expected;
+    std::cout << "Columns, windowed: " << columnsTime * 1e6 / queryCount << " ns/query ("
+              << pointerTime / columnsTime << "x faster)" << std::endl;
+
+    std::cout << (matches ? "PASS: every method finds the same conflicts"
+                          : "FAIL: overlap kernel disagrees with the pointer scan") << std::endl;
+    return matches ? 0 : 1;
+}
@@ -0,0 +1,185 @@
+// Checks the facility's slot bitmaps against the reservations themselves and
+// times "is 6-9 pm free on any weekday next month in any room?".
+//
+//   - exactness: one facility with bookings on and off the 15-minute grid;
+//                isAvailable must match a scan with Reservation::overlaps for
+//                random windows, before and after some bookings are removed
+//   - question:  a pool of rooms booked through most evenings of a month
+//                (each room leaves an evening free with freePercent chance),
+//                asked once by calling Reservation::overlaps for every
+//                weekday, room and booking until a free room turns up, and
+//                once with FacilityPool::daysWithFreeRoom, which classifies
+//                all the days of a room from its bitmaps
+//
+// Usage: ./slot_calendar_bench [rooms] [freePercent] [repeats]
+
+#include <iostream>
+#include <vector>
+#include <memory>
+#include <string>
+#include <chrono>
+#include <random>
+#include <cstdlib>
+#include <cstdint>
+#include "Resident.h"
+#include "Reservation.h"
+#include "Facility.h"
+#include "FacilityPool.h"
+#include "SlotCalendar.h"
+#include "BenchSupport.h"
+
+typedef std::chrono::system_clock Clock;
+
+bool openFor(const Facility& facility, const Clock::time_point& start, const Clock::time_point& end) {
+    auto startHour = std::chrono::duration_cast<std::chrono::hours>(start.time_since_epoch()).count() % 24;
+    auto endHour = std::chrono::duration_cast<std::chrono::hours>(end.time_since_epoch()).count() % 24;
+    return startHour >= facility.getOpeningHour() && endHour <= facility.getClosingHour() && startHour < endHour;
+}
+
+bool scanFree(const Facility& facility, const Clock::time_point& start, const Clock::time_point& end) {
+    if (!openFor(facility, start, end)) {
+        return false;
+    }
+    for (const Reservation* reservation : facility.getReservations()) {
+        if (reservation->overlaps(start, end)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Windows of 15 minutes to 4 hours within one day, half of them on the grid
+bool checkExactness(User* owner, std::mt19937& random) {
+    const Clock::time_point base = Clock::from_time_t(1704067200); // 2024-01-01 00:00 UTC
+    Facility facility;
+    std::uniform_int_distribution<int> pickDay(0, 59), pickMinute(8 * 60, 21 * 60), pickLength(15, 180);
+    for (int i = 0; i < 1500; ++i) {
+        int minute = pickMinute(random);
+        if (i % 2 == 0) {
+            minute -= minute % 15;
+        }
+        Clock::time_point start = base + std::chrono::hours(24 * pickDay(random)) + std::chrono::minutes(minute);
+        facility.addReservation(std::unique_ptr<Reservation>(new Reservation(
+            owner, start, start + std::chrono::minutes(pickLength(random)), LayoutStyle::Meeting, true)));
+    }
+
+    bool exact = true;
+    for (int pass = 0; pass < 2; ++pass) {
+        std::uniform_int_distribution<int> pickQueryMinute(6 * 60, 23 * 60), pickQueryLength(15, 240);
+        for (int q = 0; q < 20000; ++q) {
+            int minute = pickQueryMinute(random);
+            if (q % 2 == 0) {
+                minute -= minute % 15;
+            }
+            Clock::time_point start = base + std::chrono::hours(24 * pickDay(random)) + std::chrono::minutes(minute);
+            Clock::time_point end = start + std::chrono::minutes(q % 2 == 0 ? pickQueryLength(random) / 15 * 15 : pickQueryLength(random));
+            exact = exact && facility.isAvailable(start, end) == scanFree(facility, start, end);
+        }
+
+        // Every third booking goes, which clears and rebuilds the days it was on
+        std::vector<RecordId> ids;
+        for (const Reservation* reservation : facility.getReservations()) {
+            ids.push_back(reservation->getId());
+        }
+        for (size_t i = 0; i < ids.size(); i += 3) {
+            facility.removeReservation(ids[i]);
+        }
+    }
+    return exact;
+}
+
+int main(int argc, char* argv[]) {
+    int roomCount = argc > 1 ? std::atoi(argv[1]) : 200;
+    int freePercent = argc > 2 ? std::atoi(argv[2]) : 1;
+    int repeats = argc > 3 ? std::atoi(argv[3]) : 50;
+    if (roomCount < 1) {
+        roomCount = 1;
+    }
+    if (repeats < 1) {
+        repeats = 1;
+    }
+
+    std::mt19937 random(42);
+    Resident owner("calendar_owner", "pw");
+    bool exact = checkExactness(&owner, random);
+
+    // Rooms booked hour by hour from 5 to 10 pm through February 2024
+    const Clock::time_point month = Clock::from_time_t(1706745600); // 2024-02-01 00:00 UTC
+    const int dayCount = 29;
+    FacilityPool pool(1);
+    std::uniform_int_distribution<int> percent(0, 99);
+    int bookings = 0;
+    for (int r = 0; r < roomCount; ++r) {
+        std::size_t room = pool.addRoom("Room " + std::to_string(r), 8, 23, 40);
+        for (int day = 0; day < dayCount; ++day) {
+            if (percent(random) < freePercent) {
+                continue;
+            }
+            for (int hour = 17; hour < 22; ++hour) {
+                Clock::time_point start = month + std::chrono::hours(24 * day + hour);
+                bookings += pool.room(room).addReservation(std::unique_ptr<Reservation>(new Reservation(
+                    &owner, start, start + std::chrono::hours(1), LayoutStyle::Meeting, true))) ? 1 : 0;
+            }
+        }
+    }
+
+    std::int64_t firstDay = SlotCalendar::dayOf(month.time_since_epoch().count());
+    auto isWeekday = [firstDay](int day) {
+        int weekday = static_cast<int>((firstDay + day + 4) % 7); // 1970-01-01 was a Thursday; 0 is Sunday
+        return weekday >= 1 && weekday <= 5;
+    };
+
+    std::vector<char> scanned(dayCount, 0), bitmapped(dayCount, 0);
+    long long overlapCalls = 0;
+    double scanTime = timeIt([&]() {
+        for (int repeat = 0; repeat < repeats; ++repeat) {
+            for (int day = 0; day < dayCount; ++day) {
+                if (!isWeekday(day)) {
+                    continue;
+                }
+                Clock::time_point start = month + std::chrono::hours(24 * day + 18);
+                Clock::time_point end = start + std::chrono::hours(3);
+                bool anyRoom = false;
+                for (std::size_t room = 0; room < pool.size() && !anyRoom; ++room) {
+                    bool free = true;
+                    for (const Reservation* reservation : pool.room(room).getReservations()) {
+                        ++overlapCalls;
+                        if (reservation->overlaps(start, end)) {
+                            free = false;
+                            break;
+                        }
+                    }
+                    anyRoom = free;
+                }
+                scanned[day] = anyRoom;
+            }
+        }
+    });
+
+    double bitmapTime = timeIt([&]() {
+        for (int repeat = 0; repeat < repeats; ++repeat) {
+            std::vector<std::uint64_t> days = pool.daysWithFreeRoom(month, dayCount, 18 * 60, 21 * 60);
+            for (int day = 0; day < dayCount; ++day) {
+                bitmapped[day] = isWeekday(day) && ((days[day / 64] >> (day % 64)) & 1) != 0;
+            }
+        }
+    });
+
+    int freeDays = 0;
+    for (int day = 0; day < dayCount; ++day) {
+        freeDays += bitmapped[day];
+    }
+    bool matches = scanned == bitmapped;
+
+    std::cout << "Exactness: isAvailable " << (exact ? "matches" : "DIFFERS FROM") << " a reservation scan on and off the grid" << std::endl;
+    std::cout << "Rooms: " << roomCount << ", bookings: " << bookings << ", weekdays with a free 6-9 pm room: "
+              << freeDays << " (CPU level " << simdLevelName(detectSimdLevel()) << ")" << std::endl;
+    std::cout << "Reservation scan: " << scanTime * 1000 / repeats << " us/question, "
+              << overlapCalls / repeats << " overlaps calls" << std::endl;
+    std::cout << "Slot bitmaps:     " << bitmapTime * 1000 / repeats << " us/question ("
+              << scanTime / bitmapTime << "x faster)" << std::endl;
+    bool ok = exact && matches;
+    std::cout << (ok ? "PASS: bitmaps agree with the reservations"
+                     : "FAIL: bitmap availability disagrees with the reservations") << std::endl;
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,193 @@
+// Compares the per-object text files against the single-file binary snapshot.
+//
+// Builds a synthetic dataset, then times:
+//   - text save:   saveToFile on every user, event, the facility and the manager
+//   - text load:   Event::loadFromFile / User::loadFromFile / FacilityManager::loadFromFile
+//   - binary save: Snapshot::save
+//   - binary load: Snapshot::load
+//
+// Usage: ./snapshot_bench [users] [events] [ticketsPerEvent] [dataDir]
+
+#include <iostream>
+#include <streambuf>
+#include <vector>
+#include <memory>
+#include <string>
+#include <chrono>
+#include <cstdlib>
+#include <cstdint>
+#include <fstream>
+#include <iterator>
+#include <sys/stat.h>
+#include "User.h"
+#include "Resident.h"
+#include "NonResident.h"
+#include "Organization.h"
+#include "Event.h"
+#include "Ticket.h"
+#include "Reservation.h"
+#include "UserDirectory.h"
+#include "Facility.h"
+#include "FacilityManager.h"
+#include "Snapshot.h"
+#include "BenchSupport.h"
+
+int main(int argc, char* argv[]) {
+    int userCount = argc > 1 ? std::atoi(argv[1]) : 2000;
+    int eventCount = argc > 2 ? std::atoi(argv[2]) : 50;
+    int ticketsPerEvent = argc > 3 ? std::atoi(argv[3]) : 100;
+    std::string dataDir = argc > 4 ? argv[4] : "snapshot_bench_data";
+    mkdir(dataDir.c_str(), 0755);
+
+    NullBuffer discard;
+    std::streambuf* original = std::cout.rdbuf(&discard);
+
+    // Dataset: users with a couple of reservations each, events with tickets
+    std::vector<std::unique_ptr<User>> users;
+    std::vector<std::unique_ptr<Event>> events;
+    Facility facility;
+    FacilityManager manager(facility);
+    auto base = std::chrono::system_clock::time_point(std::chrono::hours(24 * 20000));
+
+    for (int i = 0; i < userCount; ++i) {
+        std::string name = "user" + std::to_string(i);
+        std::unique_ptr<User> user;
+        if (i % 3 == 0) {
+            user.reset(new Resident(name, "pw"));
+        } else if (i % 3 == 1) {
+            user.reset(new NonResident(name, "pw"));
+        } else {
+            user.reset(new Organization(name, "pw"));
+        }
+        user->addToBudget(1000000.0);
+        for (int r = 0; r < 2; ++r) {
+            auto start = base + std::chrono::hours(24 * (i * 2 + r) + 10);
+            user->makeReservation(std::unique_ptr<Reservation>(
+                new Reservation(user.get(), start, start + std::chrono::hours(2), LayoutStyle::Meeting, true)));
+            facility.addReservation(std::unique_ptr<Reservation>(
+                new Reservation(user.get(), start, start + std::chrono::hours(2), LayoutStyle::Meeting, true)));
+        }
+        users.push_back(std::move(user));
+    }
+    for (int e = 0; e < eventCount; ++e) {
+        std::unique_ptr<Event> event(new Event("event" + std::to_string(e), "Synthetic event", users[e % userCount].get(),
+                                               5.0, ticketsPerEvent, true, true, true));
+        for (int t = 0; t < ticketsPerEvent; ++t) {
+            User* buyer = users[(e * 31 + t) % userCount].get();
+            Ticket* ticket = event->purchaseTicket(buyer);
+            if (ticket) {
+                buyer->purchaseTicket(ticket);
+            }
+        }
+        events.push_back(std::move(event));
+    }
+    for (int p = 0; p < userCount / 10; ++p) {
+        auto start = base + std::chrono::hours(24 * (userCount * 2 + p) + 10);
+        manager.addPendingReservation(std::unique_ptr<Reservation>(
+            new Reservation(users[p].get(), start, start + std::chrono::hours(3), LayoutStyle::Lecture, false)));
+    }
+    // The facility can also hold a booking nobody owns, as Facility::loadFromFile leaves them
+    const RecordId ownerlessId = 999999999;
+    auto ownerlessStart = base + std::chrono::hours(24 * (userCount * 3) + 10);
+    facility.addReservation(std::unique_ptr<Reservation>(new Reservation(
+        nullptr, ownerlessStart, ownerlessStart + std::chrono::hours(2), LayoutStyle::Dance, true, ownerlessId, true, 0.0)));
+
+    double textSave = timeIt([&]() {
+        for (const auto& user : users) {
+            user->saveToFile(dataDir + "/user_" + user->getUsername());
+        }
+        for (const auto& event : events) {
+            event->saveToFile(dataDir + "/event_" + event->getName());
+        }
+        facility.saveToFile(dataDir + "/facility");
+        manager.saveToFile(dataDir + "/manager");
+    });
+
+    // Reloading the facility text file is skipped: Facility::loadFromFile cannot
+    // resolve reservation owners, so it only works on an empty schedule.
+    std::vector<std::unique_ptr<Event>> textEvents;
+    std::vector<std::unique_ptr<User>> textUsers;
+    Facility textFacility;
+    FacilityManager textManager(textFacility);
+    double textLoad = timeIt([&]() {
+        for (const auto& user : users) {
+            std::unique_ptr<User> copy;
+            if (user->getType() == UserType::Resident) {
+                copy.reset(new Resident(user->getUsername(), "pw"));
+            } else if (user->getType() == UserType::NonResident) {
+                copy.reset(new NonResident(user->getUsername(), "pw"));
+            } else {
+                copy.reset(new Organization(user->getUsername(), "pw"));
+            }
+            textUsers.push_back(std::move(copy));
+        }
+        UserDirectory textDirectory(textUsers);
+        for (const auto& event : events) {
+            auto loaded = Event::loadFromFile(dataDir + "/event_" + event->getName(), textDirectory);
+            if (loaded) {
+                textEvents.push_back(std::move(loaded));
+            }
+        }
+        for (const auto& user : textUsers) {
+            user->loadFromFile(dataDir + "/user_" + user->getUsername(), textEvents);
+        }
+        textManager.loadFromFile(dataDir + "/manager", textDirectory);
+    });
+
+    std::string snapshotFile = dataDir + "/system.snap";
+    double binarySave = timeIt([&]() {
+        Snapshot::save(snapshotFile, users, events, facility, manager);
+    });
+
+    std::vector<std::unique_ptr<User>> loadedUsers;
+    std::vector<std::unique_ptr<Event>> loadedEvents;
+    Facility loadedFacility;
+    FacilityManager loadedManager(loadedFacility);
+    bool loaded = false;
+    double binaryLoad = timeIt([&]() {
+        loaded = Snapshot::load(snapshotFile, loadedUsers, loadedEvents, loadedFacility, loadedManager);
+    });
+
+    // A snapshot cut short mid-body, under a footer that matches the cut, must
+    // fail to load without leaving anything half-loaded behind
+    std::string brokenFile = dataDir + "/broken.snap";
+    {
+        std::ifstream in(snapshotFile, std::ios::binary);
+        std::string bytes((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+        bytes.resize((bytes.size() - sizeof(std::uint64_t)) * 3 / 5);
+        std::uint64_t footer = Snapshot::checksum(bytes.data(), bytes.size());
+        bytes.append(reinterpret_cast<const char*>(&footer), sizeof(footer));
+        std::ofstream(brokenFile, std::ios::binary).write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+    }
+    std::vector<std::unique_ptr<User>> brokenUsers;
+    std::vector<std::unique_ptr<Event>> brokenEvents;
+    Facility brokenFacility;
+    FacilityManager brokenManager(brokenFacility);
+    bool untouched = !Snapshot::load(brokenFile, brokenUsers, brokenEvents, brokenFacility, brokenManager) &&
+                     brokenUsers.empty() && brokenEvents.empty() && brokenFacility.getReservations().size() == 0;
+
+    std::cout.rdbuf(original);
+
+    bool consistent = loaded &&
+                      loadedUsers.size() == users.size() &&
+                      loadedEvents.size() == events.size() &&
+                      loadedFacility.getReservations().size() == facility.getReservations().size() &&
+                      loadedFacility.getReservations().get(ownerlessId) != nullptr &&
+                      loadedFacility.getReservations().get(ownerlessId)->getUser() == nullptr &&
+                      untouched;
+
+    std::cout << "Dataset: " << userCount << " users, " << eventCount << " events, "
+              << ticketsPerEvent << " tickets/event, " << facility.getReservations().size()
+              << " scheduled reservations" << std::endl;
+    std::cout << "Text save:   " << textSave << " ms" << std::endl;
+    std::cout << "Binary save: " << binarySave << " ms (" << textSave / binarySave << "x faster)" << std::endl;
+    std::cout << "Text load:   " << textLoad << " ms" << std::endl;
+    std::cout << "Binary load: " << binaryLoad << " ms (" << textLoad / binaryLoad << "x faster)" << std::endl;
+    std::cout << (consistent ? "PASS: snapshot round-trip matches" : "FAIL: snapshot round-trip mismatch") << std::endl;
+
+    std::string cleanup = "rm -rf '" + dataDir + "'";
+    if (std::system(cleanup.c_str()) != 0) {
+        std::cerr << "Could not remove " << dataDir << std::endl;
+    }
+    return consistent ? 0 : 1;
+}
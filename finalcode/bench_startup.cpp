@@ -0,0 +1,114 @@
+// Startup benchmark: how long does it take to bring a large snapshot back into
+// memory? Generates a dataset (one million tickets by default), saves it once,
+// then times Snapshot::load (buffered read) against Snapshot::loadMapped (mmap).
+//
+// Usage: ./startup_bench [users] [events] [ticketsPerEvent] [snapshotFile]
+
+#include <iostream>
+#include <streambuf>
+#include <vector>
+#include <memory>
+#include <string>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include "User.h"
+#include "Resident.h"
+#include "NonResident.h"
+#include "Event.h"
+#include "Ticket.h"
+#include "Reservation.h"
+#include "Facility.h"
+#include "FacilityManager.h"
+#include "Snapshot.h"
+#include "BenchSupport.h"
+
+struct LoadResult {
+    double milliseconds;
+    bool ok;
+    std::size_t tickets;
+};
+
+template<typename Loader>
+LoadResult timeLoad(Loader loader) {
+    std::vector<std::unique_ptr<User>> users;
+    std::vector<std::unique_ptr<Event>> events;
+    Facility facility;
+    FacilityManager manager(facility);
+
+    auto begin = std::chrono::steady_clock::now();
+    bool ok = loader(users, events, facility, manager);
+    double elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count();
+
+    std::size_t tickets = 0;
+    for (const auto& event : events) {
+        tickets += event->getTickets().size();
+    }
+    LoadResult result = { elapsed, ok, tickets };
+    return result;
+}
+
+int main(int argc, char* argv[]) {
+    int userCount = argc > 1 ? std::atoi(argv[1]) : 100000;
+    int eventCount = argc > 2 ? std::atoi(argv[2]) : 100;
+    int ticketsPerEvent = argc > 3 ? std::atoi(argv[3]) : 10000;
+    std::string snapshotFile = argc > 4 ? argv[4] : "startup_bench.snap";
+
+    NullBuffer discard;
+    std::streambuf* original = std::cout.rdbuf(&discard);
+
+    {
+        std::vector<std::unique_ptr<User>> users;
+        std::vector<std::unique_ptr<Event>> events;
+        Facility facility;
+        FacilityManager manager(facility);
+        users.reserve(userCount);
+        for (int i = 0; i < userCount; ++i) {
+            std::string name = "user" + std::to_string(i);
+            User* user = (i % 2 == 0) ? static_cast<User*>(new Resident(name, "pw")) : new NonResident(name, "pw");
+            user->addToBudget(1000000.0);
+            users.push_back(std::unique_ptr<User>(user));
+        }
+        for (int e = 0; e < eventCount; ++e) {
+            std::unique_ptr<Event> event(new Event("event" + std::to_string(e), "Synthetic event",
+                                                   users[e % userCount].get(), 1.0, ticketsPerEvent,
+                                                   true, true, true));
+            for (int t = 0; t < ticketsPerEvent; ++t) {
+                User* buyer = users[(static_cast<long long>(e) * 7919 + t) % userCount].get();
+                Ticket* ticket = event->purchaseTicket(buyer);
+                if (ticket) {
+                    buyer->attachTicket(ticket);
+                }
+            }
+            events.push_back(std::move(event));
+        }
+        Snapshot::save(snapshotFile, users, events, facility, manager);
+    }
+
+    LoadResult buffered = timeLoad([&](std::vector<std::unique_ptr<User>>& users,
+                                       std::vector<std::unique_ptr<Event>>& events,
+                                       Facility& facility, FacilityManager& manager) {
+        return Snapshot::load(snapshotFile, users, events, facility, manager);
+    });
+    LoadResult mapped = timeLoad([&](std::vector<std::unique_ptr<User>>& users,
+                                     std::vector<std::unique_ptr<Event>>& events,
+                                     Facility& facility, FacilityManager& manager) {
+        return Snapshot::loadMapped(snapshotFile, users, events, facility, manager);
+    });
+
+    std::cout.rdbuf(original);
+
+    long long expectedTickets = static_cast<long long>(eventCount) * ticketsPerEvent;
+    bool consistent = buffered.ok && mapped.ok &&
+                      static_cast<long long>(mapped.tickets) == expectedTickets &&
+                      buffered.tickets == mapped.tickets;
+
+    std::cout << "Dataset: " << userCount << " users, " << eventCount << " events, "
+              << expectedTickets << " tickets" << std::endl;
+    std::cout << "Buffered load: " << buffered.milliseconds << " ms" << std::endl;
+    std::cout << "Mapped load:   " << mapped.milliseconds << " ms" << std::endl;
+    std::cout << (consistent ? "PASS: all tickets restored" : "FAIL: restored ticket count mismatch") << std::endl;
+
+    std::remove(snapshotFile.c_str());
+    return consistent ? 0 : 1;
+}
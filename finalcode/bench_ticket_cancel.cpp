@@ -0,0 +1,106 @@
+// Compares cancelling tickets by searching a vector with the indexed
+// TicketTable.
+//
+// Sells one ticket per user for a single large event, then removes every
+// ticket in shuffled order with:
+//   - vector:  std::find by pointer and vector::erase, as Event used to
+//   - table:   TicketTable::remove by ticket id over the same tickets
+//   - event:   Event::cancelTicket, including the refund and seat release
+// Before cancelling, every ticket must be found again by its id and by its
+// buyer, and afterwards the event must be empty with every buyer refunded.
+//
+// Usage: ./ticket_cancel_bench [tickets]
+
+#include <iostream>
+#include <streambuf>
+#include <vector>
+#include <memory>
+#include <string>
+#include <chrono>
+#include <random>
+#include <algorithm>
+#include <cstdlib>
+#include "Resident.h"
+#include "Event.h"
+#include "Ticket.h"
+#include "TicketTable.h"
+#include "BenchSupport.h"
+
+int main(int argc, char* argv[]) {
+    int ticketCount = argc > 1 ? std::atoi(argv[1]) : 50000;
+    if (ticketCount < 1) {
+        ticketCount = 1;
+    }
+    const double price = 10.0;
+
+    NullBuffer discard;
+    std::streambuf* original = std::cout.rdbuf(&discard);
+
+    std::vector<std::unique_ptr<User>> users;
+    std::vector<double> budgets;
+    Resident organizer("bench_organizer", "pw");
+    Event event("Bench Gala", "Synthetic event", &organizer, price, ticketCount, true, true, true);
+    for (int i = 0; i < ticketCount; ++i) {
+        users.push_back(std::unique_ptr<User>(new Resident("buyer" + std::to_string(i), "pw")));
+        users.back()->addToBudget(price);
+        budgets.push_back(users.back()->getBudget());
+        if (Ticket* ticket = event.purchaseTicket(users.back().get())) {
+            users.back()->attachTicket(ticket);
+        }
+    }
+
+    std::vector<Ticket*> sold = event.getTickets();
+    std::vector<Ticket*> order = sold;
+    std::shuffle(order.begin(), order.end(), std::mt19937(42));
+
+    bool found = sold.size() == static_cast<size_t>(ticketCount);
+    for (Ticket* ticket : sold) {
+        found = found && event.findTicketById(ticket->getId()) == ticket &&
+                event.findTicket(ticket->getUser()) == ticket;
+    }
+
+    std::vector<Ticket*> vector = sold;
+    double vectorTime = timeIt([&]() {
+        for (Ticket* ticket : order) {
+            auto it = std::find(vector.begin(), vector.end(), ticket);
+            if (it != vector.end()) {
+                vector.erase(it);
+            }
+        }
+    });
+
+    TicketTable table;
+    for (Ticket* ticket : sold) {
+        table.add(ticket);
+    }
+    double tableTime = timeIt([&]() {
+        for (Ticket* ticket : order) {
+            table.remove(ticket->getId());
+        }
+    });
+
+    int cancelled = 0;
+    double eventTime = timeIt([&]() {
+        for (Ticket* ticket : order) {
+            cancelled += event.cancelTicket(ticket) ? 1 : 0;
+        }
+    });
+
+    std::cout.rdbuf(original);
+
+    bool refunded = true;
+    for (size_t i = 0; i < users.size(); ++i) {
+        refunded = refunded && users[i]->getBudget() == budgets[i] && users[i]->getTickets().empty();
+    }
+    bool ok = found && vector.empty() && table.empty() && cancelled == ticketCount &&
+              event.getTickets().empty() && event.getCurrentCapacity() == 0 && refunded;
+
+    std::cout << "Tickets: " << ticketCount << std::endl;
+    std::cout << "Vector find + erase: " << vectorTime << " ms" << std::endl;
+    std::cout << "TicketTable remove:  " << tableTime << " ms (" << vectorTime / tableTime << "x faster)" << std::endl;
+    std::cout << "Event::cancelTicket: " << eventTime << " ms, " << eventTime * 1e6 / ticketCount
+              << " ns per cancellation with refund" << std::endl;
+    std::cout << (ok ? "PASS: every ticket found by id and buyer, cancelled and refunded"
+                     : "FAIL: ticket table lost or misplaced a ticket") << std::endl;
+    return ok ? 0 : 1;
+}
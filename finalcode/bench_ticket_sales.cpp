@@ -0,0 +1,162 @@
+// Stress benchmark for concurrent ticket sales.
+//
+// Many threads hammer a single Event at once. Every buyer gets one purchase
+// attempt per round; a share of them cannot afford the ticket so the
+// give-back path is exercised as well. At the end the number of tickets sold
+// must equal the event's seat count and never exceed maxCapacity, and when
+// more buyers can pay than there are seats the event must sell out. By
+// default the event has seats for half the attempts, so it sells out at any
+// thread count.
+//
+// A second round sells another event while a separate thread cancels it
+// three times mid-sale. Sales in flight during a cancel must keep their
+// seats, so afterwards the seat count must still equal the tickets held.
+//
+// Usage: ./ticket_sales_bench [threads] [maxCapacity] [buyersPerThread]
+
+#include <iostream>
+#include <streambuf>
+#include <vector>
+#include <memory>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include "Event.h"
+#include "Ticket.h"
+#include "Reservation.h"
+#include "Resident.h"
+#include "NonResident.h"
+#include "BenchSupport.h"
+
+int main(int argc, char* argv[]) {
+    unsigned hardwareThreads = std::thread::hardware_concurrency();
+    int threadCount = argc > 1 ? std::atoi(argv[1]) : static_cast<int>(hardwareThreads > 0 ? hardwareThreads : 8);
+    int buyersPerThread = argc > 3 ? std::atoi(argv[3]) : 20000;
+    int maxCapacity = argc > 2 ? std::atoi(argv[2])
+                               : static_cast<int>(static_cast<long long>(threadCount) * buyersPerThread / 2);
+
+    // Purchase paths report to std::cout; keep the benchmark output readable
+    NullBuffer discard;
+    std::streambuf* original = std::cout.rdbuf(&discard);
+
+    Resident organizer("organizer", "secret");
+    Event event("StressEvent", "Concurrent sales stress test", &organizer,
+                10.0, maxCapacity, true, true, true);
+
+    std::vector<std::vector<std::unique_ptr<User>>> buyers(threadCount);
+    long long payingBuyers = 0;
+    for (int t = 0; t < threadCount; ++t) {
+        for (int i = 0; i < buyersPerThread; ++i) {
+            std::string name = "buyer" + std::to_string(t) + "_" + std::to_string(i);
+            std::unique_ptr<User> user(new NonResident(name, "pw"));
+            if (i % 5 == 0) {
+                user->deductFromBudget(user->getBudget()); // Cannot pay; seat must be given back
+            } else {
+                ++payingBuyers;
+            }
+            buyers[t].push_back(std::move(user));
+        }
+    }
+
+    std::atomic<int> sold(0);
+    std::atomic<int> rejected(0);
+    std::atomic<bool> start(false);
+    std::vector<std::thread> workers;
+
+    for (int t = 0; t < threadCount; ++t) {
+        workers.push_back(std::thread([&, t]() {
+            while (!start.load()) {
+                std::this_thread::yield();
+            }
+            for (auto& user : buyers[t]) {
+                if (event.purchaseTicket(user.get())) {
+                    sold.fetch_add(1);
+                } else {
+                    rejected.fetch_add(1);
+                }
+            }
+        }));
+    }
+
+    auto begin = std::chrono::steady_clock::now();
+    start.store(true);
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+
+    std::cout.rdbuf(original);
+
+    long long attempts = static_cast<long long>(threadCount) * buyersPerThread;
+    int recorded = static_cast<int>(event.getTickets().size());
+    bool consistent = sold.load() <= maxCapacity &&
+                      recorded == sold.load() &&
+                      event.getCurrentCapacity() == sold.load();
+    // Seats given back by buyers who could not pay must be sold to the next ones
+    bool soldOut = payingBuyers < maxCapacity || sold.load() == maxCapacity;
+
+    // Cancel a second event while the same buyers are still purchasing from it
+    std::cout.rdbuf(&discard);
+    Event cancelled("CancelledEvent", "Cancelled during sales", &organizer,
+                    10.0, maxCapacity, true, true, true);
+    std::atomic<long long> attempted(0);
+    std::atomic<int> cancels(0);
+    start.store(false);
+    workers.clear();
+    for (int t = 0; t < threadCount; ++t) {
+        workers.push_back(std::thread([&, t]() {
+            while (!start.load()) {
+                std::this_thread::yield();
+            }
+            for (auto& user : buyers[t]) {
+                // Hold back at each quarter until its cancel ran, even on one core;
+                // buyers on other threads are still mid-purchase when it does
+                while (cancels.load() < 3 && attempted.load() >= attempts * (cancels.load() + 1) / 4) {
+                    std::this_thread::yield();
+                }
+                cancelled.purchaseTicket(user.get());
+                attempted.fetch_add(1);
+            }
+        }));
+    }
+    workers.push_back(std::thread([&]() {
+        for (int quarter = 1; quarter <= 3; ++quarter) {
+            while (attempted.load() < attempts * quarter / 4) {
+                std::this_thread::yield();
+            }
+            cancelled.cancelEvent();
+            cancels.fetch_add(1);
+        }
+    }));
+    start.store(true);
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    std::cout.rdbuf(original);
+
+    int held = static_cast<int>(cancelled.getTickets().size());
+    bool cancelConsistent = cancelled.getCurrentCapacity() == held && held <= maxCapacity;
+    bool ok = consistent && soldOut && cancelConsistent;
+
+    std::cout << "Threads: " << threadCount << std::endl;
+    std::cout << "Max capacity: " << maxCapacity << std::endl;
+    std::cout << "Purchase attempts: " << attempts << " (" << payingBuyers << " able to pay)" << std::endl;
+    std::cout << "Tickets sold: " << sold.load() << std::endl;
+    std::cout << "Rejected: " << rejected.load() << std::endl;
+    std::cout << "Seats recorded by event: " << event.getCurrentCapacity() << std::endl;
+    std::cout << "Elapsed: " << elapsed << " s (" << static_cast<long long>(attempts / elapsed) << " attempts/s)" << std::endl;
+    std::cout << "Cancelled mid-sale: " << held << " tickets held, "
+              << cancelled.getCurrentCapacity() << " seats recorded" << std::endl;
+    if (!consistent) {
+        std::cout << "FAIL: sold count inconsistent with capacity" << std::endl;
+    } else if (!soldOut) {
+        std::cout << "FAIL: seats left unsold while buyers could pay" << std::endl;
+    } else if (!cancelConsistent) {
+        std::cout << "FAIL: cancelling mid-sale left seats out of step with tickets" << std::endl;
+    } else {
+        std::cout << "PASS: no oversell" << (payingBuyers >= maxCapacity ? ", sold out" : "") << std::endl;
+    }
+
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,142 @@
+// Compares ways of totalling the hours a user booked since a cutoff, the
+// figure behind the weekly reservation limits.
+//
+// Books a few months of one- to four-hour reservations, some starting off the
+// quarter hour, then asks for the hours booked since a cutoff that walks
+// forward a few hours at a time, with:
+//   - linear scan:   every reservation, start >= cutoff, as the limit checks
+//                    used to do it
+//   - UsageTracker:  per-day totals plus the bookings of the cutoff's own day
+// Both must agree at every cutoff, including cutoffs landing exactly on a
+// booking's start, one tick after it, on midnight, after removals, and when
+// the cutoff moves backwards.
+//
+// Usage: ./usage_bench [bookings] [queries]
+
+#include <iostream>
+#include <vector>
+#include <chrono>
+#include <random>
+#include <cmath>
+#include <cstdlib>
+#include "UsageTracker.h"
+#include "BenchSupport.h"
+
+typedef std::chrono::system_clock Clock;
+
+struct Booking {
+    Clock::time_point start;
+    Clock::time_point end;
+};
+
+// What the limit checks did before UsageTracker
+double scanHours(const std::vector<Booking>& bookings, Clock::time_point cutoff) {
+    std::chrono::duration<double, std::ratio<3600>> total(0);
+    for (const Booking& booking : bookings) {
+        if (booking.start >= cutoff) {
+            total += std::chrono::duration_cast<std::chrono::duration<double, std::ratio<3600>>>(
+                booking.end - booking.start);
+        }
+    }
+    return total.count();
+}
+
+bool same(double a, double b) {
+    return std::fabs(a - b) < 1e-6;
+}
+
+int main(int argc, char* argv[]) {
+    int bookingCount = argc > 1 ? std::atoi(argv[1]) : 5000;
+    int queryCount = argc > 2 ? std::atoi(argv[2]) : 2000;
+    if (bookingCount < 1) {
+        bookingCount = 1;
+    }
+
+    const Clock::time_point base = Clock::from_time_t(1704067200); // 2024-01-01
+    std::mt19937 random(42);
+    std::uniform_int_distribution<int> minute(0, 90 * 24 * 60 - 1);
+    std::uniform_int_distribution<int> hours(1, 4);
+    std::uniform_int_distribution<int> seconds(0, 59);
+
+    std::vector<Booking> bookings;
+    UsageTracker tracker;
+    for (int i = 0; i < bookingCount; ++i) {
+        Clock::time_point start = base + std::chrono::minutes(minute(random));
+        if (i % 4 == 0) {
+            start += std::chrono::seconds(seconds(random));
+        }
+        Booking booking = { start, start + std::chrono::hours(hours(random)) };
+        bookings.push_back(booking);
+        tracker.add(booking.start, booking.end);
+    }
+
+    // Cutoffs walk forward like "a week before now" does
+    std::vector<Clock::time_point> cutoffs;
+    std::uniform_int_distribution<int> step(1, 6 * 60);
+    Clock::time_point cutoff = base;
+    for (int i = 0; i < queryCount; ++i) {
+        cutoff += std::chrono::minutes(step(random)) + std::chrono::seconds(seconds(random));
+        cutoffs.push_back(cutoff);
+    }
+
+    std::vector<double> expected(cutoffs.size());
+    double scanTime = timeIt([&]() {
+        for (std::size_t q = 0; q < cutoffs.size(); ++q) {
+            expected[q] = scanHours(bookings, cutoffs[q]);
+        }
+    });
+
+    std::vector<double> tracked(cutoffs.size());
+    double trackerTime = timeIt([&]() {
+        for (std::size_t q = 0; q < cutoffs.size(); ++q) {
+            tracked[q] = tracker.hoursSince(cutoffs[q]);
+        }
+    });
+
+    bool ok = true;
+    for (std::size_t q = 0; q < cutoffs.size(); ++q) {
+        ok = ok && same(expected[q], tracked[q]);
+    }
+
+    // Boundaries: on a booking's start it counts, one tick later it does not;
+    // midnight of its day; and the cutoff stepping back again
+    std::uniform_int_distribution<std::size_t> pick(0, bookings.size() - 1);
+    for (int i = 0; i < 200 && ok; ++i) {
+        const Booking& booking = bookings[pick(random)];
+        Clock::time_point midnight = Clock::time_point(
+            booking.start.time_since_epoch() / std::chrono::hours(24) * std::chrono::hours(24));
+        Clock::time_point probes[] = { booking.start, booking.start + Clock::duration(1),
+                                       booking.start - Clock::duration(1), midnight,
+                                       midnight + std::chrono::hours(24) - Clock::duration(1) };
+        for (Clock::time_point probe : probes) {
+            ok = ok && same(scanHours(bookings, probe), tracker.hoursSince(probe));
+        }
+    }
+
+    // Removing half the bookings keeps the two in step
+    for (std::size_t i = 0; i < bookings.size() / 2; ++i) {
+        std::size_t victim = pick(random) % bookings.size();
+        tracker.remove(bookings[victim].start, bookings[victim].end);
+        bookings[victim] = bookings.back();
+        bookings.pop_back();
+    }
+    for (std::size_t q = 0; q < cutoffs.size() && ok; q += 7) {
+        ok = same(scanHours(bookings, cutoffs[q]), tracker.hoursSince(cutoffs[q]));
+    }
+    for (const Booking& booking : bookings) {
+        if (!ok) {
+            break;
+        }
+        ok = same(scanHours(bookings, booking.start), tracker.hoursSince(booking.start)) &&
+             same(scanHours(bookings, booking.start + Clock::duration(1)),
+                  tracker.hoursSince(booking.start + Clock::duration(1)));
+    }
+
+    std::cout << "Bookings: " << bookingCount << ", queries: " << queryCount << std::endl;
+    std::cout << "Linear scan:   " << scanTime * 1000 / queryCount << " us/query" << std::endl;
+    std::cout << "UsageTracker:  " << trackerTime * 1000 / queryCount << " us/query ("
+              << scanTime / trackerTime << "x faster)" << std::endl;
+    std::cout << (ok ? "PASS: tracker matches the linear scan at every cutoff"
+                     : "FAIL: tracker disagrees with the linear scan") << std::endl;
+    return ok ? 0 : 1;
+}
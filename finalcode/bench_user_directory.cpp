@@ -0,0 +1,194 @@
+// Compares resolving usernames by scanning the user list with the UserDirectory.
+//
+// Writes one event file in the Event::saveToFile format whose tickets and
+// waitlist name users spread across a large user list, then times:
+//   - scan load:      the event file read the way Event::loadFromFile used to,
+//                     with a linear search of the users per name
+//   - directory load: Event::loadFromFile through a UserDirectory (built inside
+//                     the timing)
+//   - logins:         finding every 100th user by name, scanned and indexed
+// Both loads must give the same ticket holders in the same order.
+//
+// Usage: ./user_directory_bench [users] [attendees] [waitlist] [dataDir]
+
+#include <iostream>
+#include <fstream>
+#include <streambuf>
+#include <vector>
+#include <memory>
+#include <string>
+#include <chrono>
+#include <algorithm>
+#include <cstdlib>
+#include <sys/stat.h>
+#include "User.h"
+#include "Resident.h"
+#include "NonResident.h"
+#include "Organization.h"
+#include "Event.h"
+#include "Ticket.h"
+#include "Reservation.h"
+#include "UserDirectory.h"
+#include "BenchSupport.h"
+
+User* scanFor(const std::vector<std::unique_ptr<User>>& users, const std::string& username) {
+    auto it = std::find_if(users.begin(), users.end(),
+        [&username](const std::unique_ptr<User>& u) { return u->getUsername() == username; });
+    return it != users.end() ? it->get() : nullptr;
+}
+
+// Event::loadFromFile as it was before the directory; the waitlist is returned
+// separately since only the event itself may fill its line
+std::unique_ptr<Event> scanLoadEvent(const std::string& filename, const std::vector<std::unique_ptr<User>>& users,
+                                     std::vector<User*>& waitlist) {
+    std::ifstream file(filename);
+    std::string name, description, organizerUsername;
+    double ticketPrice;
+    int maxCapacity, currentCapacity;
+    bool isPublic, allowsResidents, allowsNonResidents;
+    long long startTimeCount, endTimeCount;
+    std::getline(file, name);
+    std::getline(file, description);
+    std::getline(file, organizerUsername);
+    file >> ticketPrice >> maxCapacity >> currentCapacity >> isPublic >> allowsResidents >> allowsNonResidents;
+    file >> startTimeCount >> endTimeCount;
+
+    User* organizer = scanFor(users, organizerUsername);
+    if (organizer == nullptr) {
+        return nullptr;
+    }
+    auto startTime = std::chrono::system_clock::time_point(std::chrono::system_clock::duration(startTimeCount));
+    auto endTime = std::chrono::system_clock::time_point(std::chrono::system_clock::duration(endTimeCount));
+    std::unique_ptr<Event> event(new Event(name, description, organizer, ticketPrice, maxCapacity,
+                                           isPublic, allowsResidents, allowsNonResidents, startTime, endTime));
+
+    int ticketCount;
+    file >> ticketCount;
+    for (int i = 0; i < ticketCount; ++i) {
+        std::string username;
+        file >> username;
+        if (User* user = scanFor(users, username)) {
+            event->restoreTicket(user, ticketPrice);
+        }
+    }
+    int waitlistSize;
+    file >> waitlistSize;
+    for (int i = 0; i < waitlistSize; ++i) {
+        std::string username;
+        file >> username;
+        if (User* user = scanFor(users, username)) {
+            waitlist.push_back(user);
+        }
+    }
+    return event;
+}
+
+bool sameHolders(const Event& a, const Event& b) {
+    const std::vector<Ticket*>& left = a.getTickets();
+    const std::vector<Ticket*>& right = b.getTickets();
+    if (left.size() != right.size()) {
+        return false;
+    }
+    for (size_t i = 0; i < left.size(); ++i) {
+        if (left[i]->getUser() != right[i]->getUser()) {
+            return false;
+        }
+    }
+    return true;
+}
+
+int main(int argc, char* argv[]) {
+    int userCount = argc > 1 ? std::atoi(argv[1]) : 100000;
+    int attendeeCount = argc > 2 ? std::atoi(argv[2]) : 4000;
+    int waitlistCount = argc > 3 ? std::atoi(argv[3]) : 1000;
+    std::string dataDir = argc > 4 ? argv[4] : "user_directory_bench_data";
+    mkdir(dataDir.c_str(), 0755);
+    if (userCount < 1) {
+        userCount = 1;
+    }
+
+    std::vector<std::unique_ptr<User>> users;
+    for (int i = 0; i < userCount; ++i) {
+        std::string username = "user" + std::to_string(i);
+        if (i % 3 == 0) {
+            users.push_back(std::unique_ptr<User>(new Resident(username, "pw")));
+        } else if (i % 3 == 1) {
+            users.push_back(std::unique_ptr<User>(new NonResident(username, "pw")));
+        } else {
+            users.push_back(std::unique_ptr<User>(new Organization(username, "pw")));
+        }
+    }
+
+    // Names are drawn from the whole list, with a few that match nobody
+    std::string eventFile = dataDir + "/event_gala";
+    {
+        std::ofstream file(eventFile);
+        file << "gala\nSynthetic gala\nuser" << userCount - 1 << "\n";
+        file << "25\n" << attendeeCount << "\n" << attendeeCount << "\n1\n1\n1\n0\n3600000000000\n";
+        file << attendeeCount << "\n";
+        for (int i = 0; i < attendeeCount; ++i) {
+            if (i % 997 == 500) {
+                file << "ghost" << i << "\n";
+            } else {
+                file << "user" << (static_cast<long long>(i) * 7919) % userCount << "\n";
+            }
+        }
+        file << waitlistCount << "\n";
+        for (int i = 0; i < waitlistCount; ++i) {
+            file << "user" << (static_cast<long long>(i) * 104729 + 13) % userCount << "\n";
+        }
+    }
+
+    NullBuffer discard;
+    std::streambuf* original = std::cout.rdbuf(&discard);
+
+    std::unique_ptr<Event> scanned;
+    std::vector<User*> scannedWaitlist;
+    double scanLoad = timeIt([&]() { scanned = scanLoadEvent(eventFile, users, scannedWaitlist); });
+
+    std::unique_ptr<Event> indexed;
+    double directoryLoad = timeIt([&]() {
+        UserDirectory directory(users);
+        indexed = Event::loadFromFile(eventFile, directory);
+    });
+
+    // Login looks up one name per attempt
+    std::vector<std::string> names;
+    for (int i = 0; i < userCount; i += 100) {
+        names.push_back("user" + std::to_string(i));
+    }
+    size_t scanFound = 0;
+    double scanLogins = timeIt([&]() {
+        for (const std::string& name : names) {
+            scanFound += scanFor(users, name) != nullptr;
+        }
+    });
+    UserDirectory directory;
+    double buildTime = timeIt([&]() { directory = UserDirectory(users); });
+    size_t indexFound = 0;
+    double indexLogins = timeIt([&]() {
+        for (const std::string& name : names) {
+            indexFound += directory.find(name) != nullptr;
+        }
+    });
+
+    std::cout.rdbuf(original);
+
+    bool matches = scanned && indexed && sameHolders(*scanned, *indexed) &&
+                   scanFound == names.size() && indexFound == names.size() && directory.size() == users.size();
+
+    std::cout << "Users: " << userCount << ", attendees: " << attendeeCount << ", waitlisted: " << waitlistCount << std::endl;
+    std::cout << "Event load, linear scan: " << scanLoad << " ms" << std::endl;
+    std::cout << "Event load, directory:   " << directoryLoad << " ms (" << scanLoad / directoryLoad << "x faster)" << std::endl;
+    std::cout << "Directory build:         " << buildTime << " ms" << std::endl;
+    std::cout << names.size() << " logins, linear scan: " << scanLogins << " ms, directory: " << indexLogins
+              << " ms (" << scanLogins / indexLogins << "x faster)" << std::endl;
+    std::cout << (matches ? "PASS: both loads resolve the same users"
+                          : "FAIL: directory lookups disagree with the scan") << std::endl;
+
+    std::string cleanup = "rm -rf '" + dataDir + "'";
+    if (std::system(cleanup.c_str()) != 0) {
+        std::cerr << "Could not remove " << dataDir << std::endl;
+    }
+    return matches ? 0 : 1;
+}
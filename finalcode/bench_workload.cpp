@@ -0,0 +1,337 @@
+// End-to-end throughput of the booking and ticketing paths under a synthetic,
+// skewed workload.
+//
+// Creates residents, non-residents and organizations plus one city user, and
+// events organized by the organizations. Then replays a random mix of
+// operations through the real User, Event, Facility and FacilityManager code:
+//   - purchase_ticket     a random user buys a ticket; event popularity
+//                         follows a Zipf curve, so the top events sell out and
+//                         build waitlists
+//   - cancel_ticket       a random held ticket is cancelled and refunded
+//   - reserve             a user requests and pays for 1-3 hours; most
+//                         requests fall on the 5-9 pm peak
+//   - approve             the manager approves a random pending request
+//   - cancel_reservation  a user cancels an approved booking and the facility
+//                         frees the slot
+//   - check_availability  a peak-skewed window is checked against the schedule
+// Every operation is timed on its own. The report gives per-type counts,
+// successes, throughput and p50/p99 latency. It is printed and written as
+// tab-separated lines to the results file, so runs can be compared.
+//
+// Usage: ./workload_bench [operations] [users] [events] [resultsFile] [seed]
+
+#include <iostream>
+#include <fstream>
+#include <streambuf>
+#include <vector>
+#include <memory>
+#include <string>
+#include <chrono>
+#include <random>
+#include <algorithm>
+#include <cmath>
+#include <ctime>
+#include <cstdio>
+#include <cstdlib>
+#include <cstdint>
+#include "User.h"
+#include "Resident.h"
+#include "NonResident.h"
+#include "Organization.h"
+#include "CityUser.h"
+#include "Event.h"
+#include "Ticket.h"
+#include "Reservation.h"
+#include "Facility.h"
+#include "FacilityManager.h"
+#include "BenchSupport.h"
+
+typedef std::chrono::system_clock Clock;
+
+enum Operation {
+    PURCHASE_TICKET,
+    CANCEL_TICKET,
+    RESERVE,
+    APPROVE,
+    CANCEL_RESERVATION,
+    CHECK_AVAILABILITY,
+    OPERATION_COUNT
+};
+
+const char* const operationNames[OPERATION_COUNT] = {
+    "purchase_ticket", "cancel_ticket", "reserve", "approve", "cancel_reservation", "check_availability"
+};
+
+// Share of the operation stream, in percent
+const int operationMix[OPERATION_COUNT] = { 40, 8, 20, 15, 2, 15 };
+
+struct Latencies {
+    std::vector<double> nanoseconds;
+    std::size_t succeeded = 0;
+
+    double percentile(double fraction) const {
+        if (nanoseconds.empty()) {
+            return 0.0;
+        }
+        std::size_t rank = static_cast<std::size_t>(std::ceil(fraction * nanoseconds.size()));
+        return nanoseconds[rank > 0 ? rank - 1 : 0];
+    }
+    double total() const {
+        double sum = 0.0;
+        for (double value : nanoseconds) {
+            sum += value;
+        }
+        return sum;
+    }
+};
+
+// Draws 0..n-1 with probability proportional to 1 / (rank + 1)^exponent
+class ZipfPicker {
+private:
+    std::vector<double> cumulative;
+
+public:
+    ZipfPicker(std::size_t n, double exponent) : cumulative(n) {
+        double sum = 0.0;
+        for (std::size_t i = 0; i < n; ++i) {
+            sum += 1.0 / std::pow(static_cast<double>(i + 1), exponent);
+            cumulative[i] = sum;
+        }
+    }
+
+    template<typename Random>
+    std::size_t operator()(Random& random) const {
+        std::uniform_real_distribution<double> pick(0.0, cumulative.back());
+        std::size_t index = std::lower_bound(cumulative.begin(), cumulative.end(), pick(random)) - cumulative.begin();
+        return std::min(index, cumulative.size() - 1);
+    }
+};
+
+// A booking window in the next 60 days, weighted towards the evening peak
+template<typename Random>
+void pickWindow(Random& random, const Clock::time_point& today, Clock::time_point& start, Clock::time_point& end) {
+    // Weight per start hour from 8 am to 10 pm (UTC, as Facility checks hours)
+    static const int hourWeights[] = { 1, 1, 1, 1, 1, 1, 1, 1, 1, 6, 6, 6, 6, 2, 2 };
+    static std::discrete_distribution<int> hour(std::begin(hourWeights), std::end(hourWeights));
+    std::uniform_int_distribution<int> day(1, 60);
+    std::uniform_int_distribution<int> hours(1, 3);
+    start = today + std::chrono::hours(24 * day(random) + 8 + hour(random));
+    end = start + std::chrono::hours(hours(random));
+}
+
+struct HeldTicket {
+    Event* event;
+    Ticket* ticket;
+};
+
+struct Booking {
+    User* user;
+    RecordId id;
+};
+
+// Removes a random element and hands it back
+template<typename T, typename Random>
+T takeRandom(std::vector<T>& items, Random& random) {
+    std::uniform_int_distribution<std::size_t> pick(0, items.size() - 1);
+    std::size_t index = pick(random);
+    T item = items[index];
+    items[index] = items.back();
+    items.pop_back();
+    return item;
+}
+
+int main(int argc, char* argv[]) {
+    long long operationCount = argc > 1 ? std::atoll(argv[1]) : 200000;
+    int userCount = argc > 2 ? std::atoi(argv[2]) : 10000;
+    int eventCount = argc > 3 ? std::atoi(argv[3]) : 500;
+    std::string resultsFile = argc > 4 ? argv[4] : "workload_results.txt";
+    unsigned seed = argc > 5 ? static_cast<unsigned>(std::atoi(argv[5])) : 42;
+    if (userCount < 10) {
+        userCount = 10;
+    }
+    if (eventCount < 1) {
+        eventCount = 1;
+    }
+
+    std::mt19937_64 random(seed);
+    NullBuffer discard;
+    std::streambuf* original = std::cout.rdbuf(&discard);
+
+    // Midnight UTC today; bookings start from tomorrow
+    const Clock::time_point now = Clock::now();
+    const Clock::time_point today = Clock::time_point(
+        std::chrono::duration_cast<Clock::duration>(std::chrono::hours(
+            std::chrono::duration_cast<std::chrono::hours>(now.time_since_epoch()).count() / 24 * 24)));
+
+    std::vector<std::unique_ptr<User>> users;
+    std::vector<User*> organizations;
+    users.push_back(std::unique_ptr<User>(new CityUser("city", "pw")));
+    for (int i = 1; i < userCount; ++i) {
+        std::string name = "user" + std::to_string(i);
+        int kind = i % 100;
+        if (kind < 60) {
+            users.push_back(std::unique_ptr<User>(new Resident(name, "pw")));
+        } else if (kind < 85) {
+            users.push_back(std::unique_ptr<User>(new NonResident(name, "pw")));
+        } else {
+            users.push_back(std::unique_ptr<User>(new Organization(name, "pw")));
+            organizations.push_back(users.back().get());
+        }
+        users.back()->addToBudget(1e9);
+    }
+
+    std::vector<std::unique_ptr<Event>> events;
+    std::uniform_int_distribution<int> capacity(20, 1000);
+    std::uniform_int_distribution<int> price(5, 50);
+    for (int e = 0; e < eventCount; ++e) {
+        User* organizer = organizations[e % organizations.size()];
+        Clock::time_point start = today + std::chrono::hours(24 * (1 + e % 60) + 18);
+        events.push_back(std::unique_ptr<Event>(new Event("event" + std::to_string(e), "Synthetic event", organizer,
+                                                          price(random), capacity(random), true, true, e % 10 != 0,
+                                                          start, start + std::chrono::hours(3))));
+    }
+
+    Facility facility;
+    FacilityManager manager(facility);
+    ZipfPicker popularEvent(events.size(), 1.0);
+    std::uniform_int_distribution<std::size_t> anyUser(0, users.size() - 1);
+    std::uniform_int_distribution<int> percent(0, 99);
+    std::vector<int> cumulativeMix(OPERATION_COUNT);
+    for (int op = 0, sum = 0; op < OPERATION_COUNT; ++op) {
+        sum += operationMix[op];
+        cumulativeMix[op] = sum;
+    }
+
+    std::vector<HeldTicket> heldTickets;
+    std::vector<RecordId> pending;
+    std::vector<Booking> scheduled;
+    std::vector<Latencies> latencies(OPERATION_COUNT);
+    for (Latencies& latency : latencies) {
+        latency.nanoseconds.reserve(static_cast<std::size_t>(operationCount / 4));
+    }
+
+    auto wallBegin = std::chrono::steady_clock::now();
+    for (long long i = 0; i < operationCount; ++i) {
+        int roll = percent(random);
+        int op = 0;
+        while (roll >= cumulativeMix[op]) {
+            ++op;
+        }
+        // Fall back to a purchase when there is nothing to cancel or approve
+        if ((op == CANCEL_TICKET && heldTickets.empty()) || (op == APPROVE && pending.empty()) ||
+            (op == CANCEL_RESERVATION && scheduled.empty())) {
+            op = PURCHASE_TICKET;
+        }
+
+        // Inputs are drawn before the clock starts
+        bool ok = false;
+        std::chrono::steady_clock::time_point begin;
+        switch (op) {
+            case PURCHASE_TICKET: {
+                User* user = users[anyUser(random)].get();
+                Event* event = events[popularEvent(random)].get();
+                begin = std::chrono::steady_clock::now();
+                if (Ticket* ticket = event->purchaseTicket(user)) {
+                    if (user->purchaseTicket(ticket)) {
+                        heldTickets.push_back(HeldTicket{ event, ticket });
+                        ok = true;
+                    } else {
+                        event->cancelTicket(ticket);
+                    }
+                }
+                break;
+            }
+            case CANCEL_TICKET: {
+                HeldTicket held = takeRandom(heldTickets, random);
+                begin = std::chrono::steady_clock::now();
+                ok = held.event->cancelTicket(held.ticket);
+                break;
+            }
+            case RESERVE: {
+                User* user = users[anyUser(random)].get();
+                Clock::time_point start, end;
+                pickWindow(random, today, start, end);
+                LayoutStyle layout = static_cast<LayoutStyle>(percent(random) % 4);
+                begin = std::chrono::steady_clock::now();
+                std::unique_ptr<Reservation> reservation(new Reservation(user, start, end, layout, true));
+                reservation->makePayment(reservation->getTotalCost());
+                RecordId id = reservation->getId();
+                if (user->makeReservation(std::move(reservation))) {
+                    manager.addPendingReservation(user->getReservations().find(id));
+                    pending.push_back(id);
+                    ok = true;
+                }
+                break;
+            }
+            case APPROVE: {
+                RecordId id = takeRandom(pending, random);
+                begin = std::chrono::steady_clock::now();
+                if (manager.approveReservation(id)) {
+                    const Reservation* approved = facility.getReservations().get(id);
+                    scheduled.push_back(Booking{ approved->getUser(), id });
+                    ok = true;
+                }
+                break;
+            }
+            case CANCEL_RESERVATION: {
+                Booking booking = takeRandom(scheduled, random);
+                begin = std::chrono::steady_clock::now();
+                ok = booking.user->cancelReservation(booking.id);
+                facility.removeReservation(booking.id);
+                break;
+            }
+            case CHECK_AVAILABILITY: {
+                Clock::time_point start, end;
+                pickWindow(random, today, start, end);
+                begin = std::chrono::steady_clock::now();
+                ok = facility.isAvailable(start, end);
+                break;
+            }
+        }
+        double elapsed = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - begin).count();
+        latencies[op].nanoseconds.push_back(elapsed);
+        if (ok) {
+            ++latencies[op].succeeded;
+        }
+    }
+    double wallSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - wallBegin).count();
+    std::cout.rdbuf(original);
+
+    char startedAt[32];
+    std::time_t wallClock = Clock::to_time_t(now);
+    std::strftime(startedAt, sizeof(startedAt), "%Y-%m-%dT%H:%M:%SZ", std::gmtime(&wallClock));
+
+    std::string report = "# workload_bench " + std::string(startedAt) + " operations=" + std::to_string(operationCount) +
+                         " users=" + std::to_string(users.size()) + " events=" + std::to_string(events.size()) +
+                         " seed=" + std::to_string(seed) + "\n";
+    report += "operation\tcount\tsucceeded\tops_per_sec\tp50_us\tp99_us\n";
+    char line[256];
+    std::size_t totalSucceeded = 0;
+    for (int op = 0; op < OPERATION_COUNT; ++op) {
+        Latencies& latency = latencies[op];
+        std::sort(latency.nanoseconds.begin(), latency.nanoseconds.end());
+        double busy = latency.total();
+        std::snprintf(line, sizeof(line), "%s\t%zu\t%zu\t%.0f\t%.3f\t%.3f\n", operationNames[op],
+                      latency.nanoseconds.size(), latency.succeeded,
+                      busy > 0.0 ? latency.nanoseconds.size() * 1e9 / busy : 0.0,
+                      latency.percentile(0.50) / 1000.0, latency.percentile(0.99) / 1000.0);
+        report += line;
+        totalSucceeded += latency.succeeded;
+    }
+    std::snprintf(line, sizeof(line), "total\t%lld\t%zu\t%.0f\t-\t-\n", operationCount, totalSucceeded,
+                  wallSeconds > 0.0 ? operationCount / wallSeconds : 0.0);
+    report += line;
+
+    std::cout << report;
+    std::cout << "Scheduled " << facility.getReservations().size() << " bookings, "
+              << heldTickets.size() << " tickets still held" << std::endl;
+
+    std::ofstream results(resultsFile);
+    if (!results.is_open()) {
+        std::cout << "Unable to open file: " << resultsFile << std::endl;
+        return 1;
+    }
+    results << report;
+    std::cout << "Results written to " << resultsFile << std::endl;
+    return 0;
+}
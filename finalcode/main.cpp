@@ -17,6 +17,11 @@
 #include "CityUser.h"
 #include "Organization.h"
 #include "LayoutStyle.h"
+#include "Snapshot.h"
+#include "Journal.h"
+#include "BulkImporter.h"
+#include "UserDirectory.h"
+#include "BatchRunner.h"
 
 // Helper function to create unique_ptr (for C++11 compatibility)
 template<typename T, typename... Args>
@@ -40,7 +45,7 @@ void displayMainMenu() {
     std::cout << "Enter your choice: ";
 }
 
-User* loginUser(const std::vector<std::unique_ptr<User>>& users) {
+User* loginUser(const UserDirectory& users) {
     std::cout << "\nLogin" << std::endl;
     std::string username, password;
     std::cout << "Enter username: ";
@@ -48,16 +53,25 @@ User* loginUser(const std::vector<std::unique_ptr<User>>& users) {
     std::cout << "Enter password: ";
     std::cin >> password;
 
-    for (const auto& user : users) {
-        if (user->login(username, password)) {
-            std::cout << "Login successful. Welcome, " << username << "!" << std::endl;
-            return user.get();
-        }
+    User* user = users.find(username);
+    if (user != nullptr && user->login(username, password)) {
+        std::cout << "Login successful. Welcome, " << username << "!" << std::endl;
+        return user;
     }
     std::cout << "Invalid username or password. Please try again." << std::endl;
     return nullptr;
 }
 
+// Reads a reservation ID typed as "RES0042" or just "42". Ids start at 1, so
+// input that does not parse comes back as 0 and matches nothing.
+RecordId readReservationId() {
+    std::string input;
+    std::cin >> input;
+    RecordId id = 0;
+    parseRecordId(input, "RES", id);
+    return id;
+}
+
 void displayFacilityManagementMenu(FacilityManager& manager) {
     while (true) {
         std::cout << "\nFacility Management Menu" << std::endl;
@@ -76,9 +90,8 @@ void displayFacilityManagementMenu(FacilityManager& manager) {
                 manager.displayPendingReservations();
                 break;
             case 2: {
-                std::string reservationId;
                 std::cout << "Enter the ID of the reservation to approve: ";
-                std::cin >> reservationId;
+                RecordId reservationId = readReservationId();
                 if (manager.approveReservation(reservationId)) {
                     std::cout << "Reservation approved successfully." << std::endl;
                 } else {
@@ -87,9 +100,8 @@ void displayFacilityManagementMenu(FacilityManager& manager) {
                 break;
             }
             case 3: {
-                std::string reservationId;
                 std::cout << "Enter the ID of the reservation to reject: ";
-                std::cin >> reservationId;
+                RecordId reservationId = readReservationId();
                 if (manager.rejectReservation(reservationId)) {
                     std::cout << "Reservation rejected successfully." << std::endl;
                 } else {
@@ -115,123 +127,80 @@ std::chrono::system_clock::time_point stringToTimePoint(const std::string& timeS
     return std::chrono::system_clock::from_time_t(std::mktime(&tm));
 }
 
-void loadUsersFromFile(std::vector<std::unique_ptr<User>>& users, const std::string& filename) {
-    std::ifstream file(filename);
-    if (!file.is_open()) {
-        std::cerr << "Failed to open file: " << filename << std::endl;
-        return;
-    }
-
-    std::string line;
-    while (std::getline(file, line)) {
-        std::istringstream iss(line);
-        std::string username, password, type;
-        double budget;
-        
-        if (!(iss >> username >> password >> type >> budget)) {
-            std::cerr << "Error reading user data from file" << std::endl;
-            continue;
+Event* findEventByName(const std::vector<std::unique_ptr<Event>>& events, const std::string& name) {
+    SymbolId nameId = SymbolTable::shared().find(name);
+    for (const auto& event : events) {
+        if (event->getNameId() == nameId) {
+            return event.get();
         }
-
-        std::unique_ptr<User> user;
-        if (type == "0") {
-            user = std::unique_ptr<User>(new Resident(username, password));
-        } else if (type == "1") {
-            user = std::unique_ptr<User>(new NonResident(username, password));
-        } else if (type == "2") {
-            user = std::unique_ptr<User>(new CityUser(username, password));
-        } else if (type == "3") {
-            user = std::unique_ptr<User>(new Organization(username, password));
-        } else {
-            std::cerr << "Unknown user type: " << type << std::endl;
-            continue;
-        }
-
-        user->addToBudget(budget);
-        users.push_back(std::move(user));
     }
-
-    file.close();
+    return nullptr;
 }
 
-void loadEventsFromFile(std::vector<std::unique_ptr<Event>>& events, const std::vector<std::unique_ptr<User>>& users, const std::string& filename) {
-    std::ifstream file(filename);
-    if (!file.is_open()) {
-        std::cerr << "Failed to open file: " << filename << std::endl;
-        return;
-    }
-
-    std::string line;
-    while (std::getline(file, line)) {
-        std::istringstream iss(line);
-        std::string name, description, organizerUsername;
-        double ticketPrice;
-        int maxCapacity;
-        bool isPublic, allowsResidents, allowsNonResidents;
-
-        // Read the event name
-        std::getline(iss, name, ' ');
-        
-        // Read the description (enclosed in quotes)
-        std::getline(iss, description, '"');  // Skip leading quote
-        std::getline(iss, description, '"');  // Read the actual description
-
-        // Read the rest of the values
-        iss >> organizerUsername >> ticketPrice >> maxCapacity >> isPublic >> allowsResidents >> allowsNonResidents;
-
-        if (iss.fail()) {
-            std::cerr << "Error reading event data from file" << std::endl;
-            continue;
-        }
-
-        // Find the organizer in the list of users
-        User* organizer = nullptr;
-        for (const auto& user : users) {
-            if (user->getUsername() == organizerUsername) {
-                organizer = user.get();
-                break;
-            }
-        }
-
-        if (!organizer) {
-            std::cerr << "Organizer not found: " << organizerUsername << std::endl;
-            continue;
-        }
-
-        // Assuming default or placeholder values for startTime and endTime since they are not provided in the events.txt
-        auto startTime = stringToTimePoint("2023-01-01T00:00:00Z");
-        auto endTime = stringToTimePoint("2023-01-01T01:00:00Z");
-
-        // Create and add the event to the list
-        events.push_back(make_unique<Event>(name, description, organizer, ticketPrice, maxCapacity, 
-                                                isPublic, allowsResidents, allowsNonResidents, 
-                                                startTime, endTime));
+int main(int argc, char* argv[]) {
+    // --batch [script] runs commands from the script, or stdin, instead of the menu
+    const bool batch = argc > 1 && std::string(argv[1]) == "--batch";
+    if (batch) {
+        std::ios::sync_with_stdio(false);
+        std::cout.setstate(std::ios::badbit); // Only command results are printed
     }
 
-    file.close();
-}
-       
-
-int main() {
     Facility facility;
     FacilityManager manager(facility);
     std::vector<std::unique_ptr<User>> users;
     std::vector<std::unique_ptr<Event>> events;
 
-    // Load users and events from files
-    loadUsersFromFile(users, "users.txt");
-    loadEventsFromFile(events, users, "events.txt");
+    // Start from the binary snapshot when one exists, otherwise from the text files
+    const std::string snapshotFile = "system.snap";
+    std::uint64_t loadedSnapshot = 0; // Checksum of the snapshot the state came from, if any
+    if (!std::ifstream(snapshotFile).good() ||
+        !Snapshot::loadMapped(snapshotFile, users, events, facility, manager, &loadedSnapshot)) {
+        BulkImporter importer;
+        importer.loadUsers("users.txt", users);
+        importer.loadEvents("events.txt", events, users);
+    }
+
+    // Every change since the snapshot is in the journal; replay it before taking input
+    const std::uint64_t journalCompactBytes = 4 * 1024 * 1024;
+    Journal journal("system.journal", snapshotFile);
+    journal.recover(users, events, facility, manager, loadedSnapshot);
+    Journal::setActive(&journal);
+
+    // No users are created after startup, so the index is built once
+    UserDirectory directory(users);
+
+    if (batch) {
+        std::cout.clear();
+        BatchRunner runner(users, events, facility, manager, directory, &journal);
+        if (argc > 2) {
+            std::ifstream script(argv[2]);
+            if (!script.is_open()) {
+                std::cout << "Unable to open file: " << argv[2] << std::endl;
+                return 1;
+            }
+            runner.run(script, std::cout);
+        } else {
+            runner.run(std::cin, std::cout);
+        }
+        journal.compactIfNeeded(journalCompactBytes, users, events, facility, manager);
+        return 0;
+    }
 
     User* currentUser = nullptr;
 
     while (true) {
+        // Each command is a commit point; once the journal grows large it is
+        // folded into a fresh snapshot
+        journal.sync();
+        journal.compactIfNeeded(journalCompactBytes, users, events, facility, manager);
+
         displayMainMenu();
         int choice;
         std::cin >> choice;
 
         switch (choice) {
             case 1: {
-                currentUser = loginUser(users);
+                currentUser = loginUser(directory);
                 break;
             }
             case 2: {
@@ -250,6 +219,27 @@ int main() {
                     int layoutStyleInt;
                     bool isPublic;
 
+                    std::cout << "Show the next free times? (1: Yes, 0: No): ";
+                    bool showFreeTimes;
+                    std::cin >> showFreeTimes;
+                    if (showFreeTimes) {
+                        double hours;
+                        std::cout << "Duration in hours: ";
+                        std::cin >> hours;
+                        auto duration = std::chrono::duration_cast<std::chrono::system_clock::duration>(
+                            std::chrono::duration<double, std::ratio<3600>>(hours));
+                        auto windows = facility.findFreeSlots(std::chrono::system_clock::now(), duration, 5);
+                        if (windows.empty()) {
+                            std::cout << "No free times found for that duration." << std::endl;
+                        }
+                        for (const auto& window : windows) {
+                            auto startTime = std::chrono::system_clock::to_time_t(window.start);
+                            auto endTime = std::chrono::system_clock::to_time_t(window.end);
+                            std::cout << "  " << std::put_time(std::localtime(&startTime), "%Y-%m-%d %H:%M") << " - "
+                                      << std::put_time(std::localtime(&endTime), "%Y-%m-%d %H:%M") << std::endl;
+                        }
+                    }
+
                     std::cout << "Start time (YYYY-MM-DD HH:MM): ";
                     std::cin.ignore();
                     std::getline(std::cin, startTimeStr);
@@ -285,10 +275,13 @@ int main() {
                         }
                     }
 
+                    // The user and the manager share the one reservation
+                    RecordId requestId = reservation->getId();
                     if (currentUser->makeReservation(std::move(reservation))) {
-                        manager.addPendingReservation(std::move(reservation));
+                        ReservationHandle request = currentUser->getReservations().find(requestId);
+                        manager.addPendingReservation(request);
                         std::cout << "Reservation request submitted. ";
-                        if (reservation->getIsPaid()) {
+                        if (ReservationStore::shared().get(request)->getIsPaid()) {
                             std::cout << "Waiting for approval." << std::endl;
                         } else {
                             std::cout << "Please note that the reservation will not be approved until payment is made." << std::endl;
@@ -304,9 +297,8 @@ int main() {
             case 4: {
                 if (currentUser != nullptr) {
                     currentUser->viewSchedule();
-                    std::string reservationId;
                     std::cout << "Enter the ID of the reservation to cancel: ";
-                    std::cin >> reservationId;
+                    RecordId reservationId = readReservationId();
 
                     if (currentUser->cancelReservation(reservationId)) {
                         std::cout << "Reservation canceled successfully." << std::endl;
@@ -336,13 +328,13 @@ int main() {
 
                     if (eventIndex >= 0 && eventIndex < events.size()) {
                         Event* selectedEvent = events[eventIndex].get();
-                        auto ticket = selectedEvent->purchaseTicket(currentUser);
+                        Ticket* ticket = selectedEvent->purchaseTicket(currentUser);
                         if (ticket) {
-                            if (currentUser->purchaseTicket(std::move(ticket))) {
+                            if (currentUser->purchaseTicket(ticket)) {
                                 std::cout << "Ticket purchased successfully." << std::endl;
                             } else {
-                                std::cout << "Failed to purchase ticket. Insufficient funds." << std::endl;
-                                selectedEvent->cancelTicket(ticket.get());
+                                std::cout << "Failed to purchase ticket." << std::endl;
+                                selectedEvent->cancelTicket(ticket); // Refunds and frees the seat
                             }
                         } else {
                             std::cout << "Failed to purchase ticket. Event might be full." << std::endl;
@@ -391,12 +383,19 @@ int main() {
                     std::cout << "End time (YYYY-MM-DD HH:MM): ";
                     std::getline(std::cin, endTimeStr);
 
+                    // The journal and the snapshot find events by name
+                    if (findEventByName(events, name) != nullptr) {
+                        std::cout << "An event named '" << name << "' already exists." << std::endl;
+                        break;
+                    }
+
                     auto startTime = stringToTimePoint(startTimeStr);
                     auto endTime = stringToTimePoint(endTimeStr);
 
                     events.push_back(make_unique<Event>(name, description, currentUser, ticketPrice, maxCapacity, 
                                                         isPublic, allowsResidents, allowsNonResidents, 
                                                         startTime, endTime));
+                    journal.eventCreated(*events.back());
                     std::cout << "Event created successfully." << std::endl;
                 } else {
                     std::cout << "Please login first." << std::endl;
@@ -414,16 +413,12 @@ int main() {
             case 8: {
                 if (currentUser != nullptr) {
                     currentUser->viewSchedule();
-                    std::string reservationId;
                     std::cout << "Enter the ID of the reservation to pay for: ";
-                    std::cin >> reservationId;
+                    RecordId reservationId = readReservationId();
 
-                    Reservation* reservationToPay = nullptr;
-                    for (const auto& res : currentUser->getReservations()) {
-                        if (res->getId() == reservationId && !res->getIsPaid()) {
-                            reservationToPay = res.get();
-                            break;
-                        }
+                    Reservation* reservationToPay = currentUser->getReservations().get(reservationId);
+                    if (reservationToPay != nullptr && reservationToPay->getIsPaid()) {
+                        reservationToPay = nullptr;
                     }
 
                     if (reservationToPay) {